@@ -211,6 +211,11 @@ def addNoISAOptions(parser, configure_xiangshan=False):
     parser.add_argument("--arch-db-file",
                         action="store",
                         help="Where to save database")
+    parser.add_argument("--arch-db-backend",
+                        choices=["sqlite", "columnar"],
+                        default="sqlite",
+                        help="Store trace tables in sqlite or in "
+                        "per-column files next to --arch-db-file")
     parser.add_argument("--arch-db-fromstart",
                         default=True,
                         help="start arch database from "
@@ -219,6 +224,15 @@ def addNoISAOptions(parser, configure_xiangshan=False):
                         default=False,
                         help="enable rolling perfcnt "
                         "(note that rolling is dependent on archdb)")
+    parser.add_argument("--rolling-stats", type=str, default="",
+                        help="Comma separated stats sampled by rolling, "
+                        "e.g. system.cpu.committedInsts,"
+                        "system.cpu.numCycles")
+    parser.add_argument("--rolling-base", type=str,
+                        default="system.cpu.committedInsts",
+                        help="Stat whose growth triggers a rolling sample")
+    parser.add_argument("--rolling-interval", type=int, default=1000,
+                        help="Growth of --rolling-base between samples")
 
     parser.add_argument("--memchecker", action="store_true")
 
@@ -331,6 +345,15 @@ def addCommonOptions(parser, configure_xiangshan=False):
         default=20*10**6,
         help="Warmup period in total instructions, reset stats without switch")
 
+    parser.add_argument("--functional-warmup-insts", action="store", type=int,
+        default=0,
+        help="Run this many instructions on an atomic CPU before the "
+        "detailed one takes over, to warm up caches and the decoupled branch "
+        "predictor at functional speed. Counted before "
+        "--warmup-insts-no-switch and --maxinsts")
+    parser.add_argument("--functional-warmup-prefetch", action="store_true",
+        help="Also train the cache prefetchers during the functional warmup")
+
     parser.add_argument(
         "--stats-root", action="append", default=[],
         help="If given, dump only stats of objects under the given SimObject. "
@@ -640,6 +663,29 @@ def addXiangshanFSOptions(parser):
     parser.add_argument("--raw-cpt", action= "store_true",
                         help = "The checkpoint file is not gz but binary")
 
+    parser.add_argument("--gcpt-restore-threads", action="store", type=int,
+                        default=0,
+                        help="Threads decompressing a gz/zstd checkpoint, "
+                        "0 to use all host threads")
+    parser.add_argument("--gcpt-cache-dir", action="store", type=str,
+                        default=None,
+                        help="Cache decompressed gz/zstd checkpoints in this "
+                        "directory and map them in later runs")
+
+    parser.add_argument("--batch-list", action="store", type=str,
+                        default=None,
+                        help="Workload list in the format of parallel_sim.sh. "
+                        "Build the system once and fork a worker per "
+                        "checkpoint, --generic-rv-cpt only sets the system up")
+    parser.add_argument("--batch-cpt-dir", action="store", type=str,
+                        default=None,
+                        help="Directory searched for the checkpoints of "
+                        "--batch-list")
+    parser.add_argument("--batch-jobs", action="store", type=int,
+                        default=0,
+                        help="Max concurrent batch workers, 0 for the "
+                        "number of host threads")
+
     parser.add_argument("--mmc-img", action="store", type=str,
                         default=None, help="The path of mmc img")
     parser.add_argument("--mmc-cptbin", action="store",
@@ -655,3 +701,18 @@ def addXiangshanFSOptions(parser):
                         default=None,
                         help="The shared lib file used to do difftest")
 
+    parser.add_argument("--difftest-incremental",
+                        action="store_true",
+                        help="Only compare registers and CSRs dirtied since "
+                        "the last difftest step, with periodic full sweeps")
+
+    parser.add_argument("--difftest-async",
+                        action="store_true",
+                        help="Step and compare the difftest ref on a helper "
+                        "thread, only PC and scalar results are compared")
+
+    parser.add_argument("--difftest-async-scalar-only",
+                        action="store_true",
+                        help="Run --difftest-async although it skips the "
+                        "CSR, vector and hypervisor checks")
+
@@ -37,7 +37,11 @@
 # (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 # OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
+import atexit
+import fnmatch
+import os
 import sys
+import traceback
 from os import getcwd
 from os.path import join as joinpath
 
@@ -771,7 +775,8 @@ def run(options, root, testsys, cpu_class):
     if exit_event.getCode() != 0:
         print("Simulated exit code not 0! Exit code is", exit_event.getCode())
 
-def run_vanilla(options, root, testsys, cpu_class):
+def instantiate_vanilla(options, root, testsys, cpu_class):
+    """Instantiate the system for run_vanilla, return the max tick."""
     # Setup global stat filtering.
     stat_root_simobjs = []
     for stat_root_str in options.stats_root:
@@ -819,6 +824,9 @@ def run_vanilla(options, root, testsys, cpu_class):
         if options.warmup_insts_no_switch != None:
             testsys.cpu[i].warmupInstCount = options.warmup_insts_no_switch
 
+    if options.functional_warmup_insts:
+        setup_functional_warmup(options, testsys)
+
     checkpoint_dir = None
     root.apply_config(options.param)
     m5.instantiate(checkpoint_dir)
@@ -841,16 +849,212 @@ def run_vanilla(options, root, testsys, cpu_class):
     if explicit_maxticks > 1:
         warn("Specified multiple of --abs-max-tick, --rel-max-tick, --maxtime."\
              " Using least")
-    maxtick = min([maxtick_from_abs, maxtick_from_rel, maxtick_from_maxtime])
+    return min([maxtick_from_abs, maxtick_from_rel, maxtick_from_maxtime])
 
-    print("**** REAL SIMULATION ****")
+def setup_functional_warmup(options, testsys):
+    """Add the atomic CPUs of --functional-warmup-insts to testsys.
 
-    # If checkpoints are being taken, then the checkpoint instruction
-    # will occur in the benchmark code it self.
-    exit_event = benchCheckpoints(testsys, options, maxtick, cptdir=None)
+    They share the ISA, decoder, MMU and branch predictor of the test CPUs,
+    so that the TLBs and predictor they train are the ones the test CPUs go
+    on with.
+    """
+    if getattr(options, 'ruby', False):
+        fatal("--functional-warmup-insts needs the classic memory system")
+
+    np = options.num_cpus
+    warmup_cpus = [AtomicSimpleCPU(switched_out=True, cpu_id=(i))
+                   for i in range(np)]
+    for i in range(np):
+        cpu = testsys.cpu[i]
+        warmup_cpus[i].system = testsys
+        warmup_cpus[i].workload = cpu.workload
+        warmup_cpus[i].clk_domain = cpu.clk_domain
+        warmup_cpus[i].progress_interval = cpu.progress_interval
+        warmup_cpus[i].isa = cpu.isa
+        warmup_cpus[i].decoder = cpu.decoder
+        warmup_cpus[i].branchPred = cpu.branchPred
+        warmup_cpus[i].mmu = cpu.mmu
+        warmup_cpus[i].flush_tlbs_on_switch_out = False
+        warmup_cpus[i].max_insts_any_thread = options.functional_warmup_insts
+        warmup_cpus[i].createThreads()
+    testsys.warmup_cpus = warmup_cpus
+
+    if options.functional_warmup_prefetch:
+        for obj in testsys.descendants():
+            if isinstance(obj, BaseCache):
+                obj.prefetch_train_atomic = True
+
+def functional_warmup(options, testsys):
+    """Run the functional warmup, return the exit event if the workload
+    ends during it, else None."""
+    np = options.num_cpus
+    m5.switchCpus(testsys, [(testsys.cpu[i], testsys.warmup_cpus[i])
+                            for i in range(np)])
+
+    print("**** FUNCTIONAL WARMUP: %d instructions ****" %
+          options.functional_warmup_insts)
+    exit_event = m5.simulate()
+    if exit_event.getCause() != "a thread reached the max instruction count":
+        return exit_event
+
+    m5.switchCpus(testsys, [(testsys.warmup_cpus[i], testsys.cpu[i])
+                            for i in range(np)])
+    return None
+
+def run_vanilla(options, root, testsys, cpu_class):
+    maxtick = instantiate_vanilla(options, root, testsys, cpu_class)
+
+    exit_event = None
+    if options.functional_warmup_insts:
+        exit_event = functional_warmup(options, testsys)
+
+    if exit_event is None:
+        print("**** REAL SIMULATION ****")
+
+        # If checkpoints are being taken, then the checkpoint instruction
+        # will occur in the benchmark code it self.
+        exit_event = benchCheckpoints(testsys, options, maxtick,
+                                      cptdir=None)
 
     print('Exiting @ tick %i because %s' %
           (m5.curTick(), exit_event.getCause()))
 
     if exit_event.getCode() != 0:
         print("Simulated exit code not 0! Exit code is", exit_event.getCode())
+
+def batch_checkpoints(options):
+    """Read the workload list of --batch-list.
+
+    Lines look like those of util/xs_scripts/parallel_sim.sh: a name and a
+    checkpoint path, then fields that are ignored here. The path is either
+    a gz/zstd file or a pattern matched against the files under
+    --batch-cpt-dir, like parallel_sim.sh does.
+    """
+    cpt_files = []
+    if options.batch_cpt_dir:
+        for dirpath, _, files in os.walk(options.batch_cpt_dir,
+                                         followlinks=True):
+            cpt_files.extend(joinpath(dirpath, f) for f in files
+                             if f.endswith(('.gz', '.zstd', '.zst')))
+        cpt_files.sort()
+
+    entries = []
+    with open(options.batch_list) as f:
+        for line in f:
+            fields = line.split()
+            if len(fields) < 2 or fields[0].startswith('#'):
+                continue
+            name, path = fields[:2]
+            if not os.path.isfile(path):
+                matches = fnmatch.filter(cpt_files, '*%s*' % path)
+                if not matches:
+                    fatal("No checkpoint of %s matches %s" % (name, path))
+                path = matches[0]
+            entries.append((name, os.path.abspath(path)))
+    return entries
+
+def _touch(path):
+    open(path, 'w').close()
+
+def _run_batch_worker(options, testsys, maxtick, cpt, outdir):
+    """Body of a forked batch worker, never returns."""
+    try:
+        log = os.open(joinpath(outdir, 'log.txt'),
+                      os.O_WRONLY | os.O_CREAT | os.O_TRUNC, 0o644)
+        os.dup2(log, sys.stdout.fileno())
+        os.dup2(log, sys.stderr.fileno())
+        os.close(log)
+        for marker in ('abort', 'completed'):
+            if os.path.exists(joinpath(outdir, marker)):
+                os.remove(joinpath(outdir, marker))
+        _touch(joinpath(outdir, 'running'))
+
+        # The arch db and the traces next to it are opened lazily, so each
+        # worker writes its own into its output directory
+        if options.enable_arch_db:
+            testsys.arch_db.getCCObject().redirect_output(outdir)
+
+        print("Restoring", cpt)
+        testsys.getCCObject().restoreGcpt(cpt)
+
+        # Exit handlers run last registered first, the ones dumping stats
+        # are registered by the first simulate, so this one runs after them
+        def finish():
+            os.remove(joinpath(outdir, 'running'))
+            _touch(joinpath(outdir, 'completed'))
+        atexit.register(finish)
+
+        exit_event = None
+        if options.functional_warmup_insts:
+            exit_event = functional_warmup(options, testsys)
+        if exit_event is None:
+            print("**** REAL SIMULATION ****")
+            exit_event = benchCheckpoints(testsys, options, maxtick,
+                                          cptdir=None)
+        print('Exiting @ tick %i because %s' %
+              (m5.curTick(), exit_event.getCause()))
+        if exit_event.getCode() != 0:
+            print("Simulated exit code not 0! Exit code is",
+                  exit_event.getCode())
+    except BaseException:
+        traceback.print_exc()
+        sys.stdout.flush()
+        sys.stderr.flush()
+        _touch(joinpath(outdir, 'abort'))
+        os._exit(1)
+    sys.exit(0)
+
+def run_batch(options, root, testsys, cpu_class):
+    """Simulate every checkpoint of --batch-list with one built system.
+
+    The system is built and instantiated once, with its gcpt restore
+    deferred. Then a worker is forked per checkpoint, at most
+    --batch-jobs at a time. Each worker only restores its checkpoint and
+    simulates, writing stats, log.txt, the arch db and its traces and the
+    completed/abort markers of parallel_sim.sh into <outdir>/<name>.
+
+    Helper threads (async difftest, arch db writer) start with their first
+    use, so only in the workers. Objects that started one before the fork
+    refuse to be forked.
+    """
+    entries = batch_checkpoints(options)
+    testsys.defer_gcpt_restore = True
+    # Forked workers must not share sockets
+    m5.disableAllListeners()
+    maxtick = instantiate_vanilla(options, root, testsys, cpu_class)
+
+    jobs = options.batch_jobs or os.cpu_count()
+    print("**** BATCH: %d checkpoints, %d jobs ****" % (len(entries), jobs))
+    sys.stdout.flush()
+    sys.stderr.flush()
+
+    running = {}
+    failed = []
+    def reap():
+        pid, status = os.wait()
+        name = running.pop(pid)
+        if os.WIFEXITED(status) and os.WEXITSTATUS(status) == 0:
+            print("Finished", name)
+        else:
+            print("Failed", name)
+            failed.append(name)
+
+    for name, cpt in entries:
+        outdir = joinpath(m5.options.outdir, name)
+        if os.path.exists(joinpath(outdir, 'completed')):
+            print("Already completed; skip", name)
+            continue
+        while len(running) >= jobs:
+            reap()
+        sys.stdout.flush()
+        sys.stderr.flush()
+        pid = m5.fork(outdir.replace('%', '%%'), drain_first=False)
+        if pid == 0:
+            _run_batch_worker(options, testsys, maxtick, cpt, outdir)
+        running[pid] = name
+    while running:
+        reap()
+
+    if failed:
+        fatal("%d of %d checkpoints failed: %s" %
+              (len(failed), len(entries), ' '.join(failed)))
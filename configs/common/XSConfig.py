@@ -93,6 +93,9 @@ def config_xiangshan_inputs(args: argparse.Namespace, sys):
         assert(buildEnv['TARGET_ISA'] == "riscv")
         sys.restore_from_gcpt = True
         sys.gcpt_file = args.generic_rv_cpt
+        sys.gcpt_restore_threads = args.gcpt_restore_threads
+        if args.gcpt_cache_dir:
+            sys.gcpt_cache_dir = args.gcpt_cache_dir
 
         sys.workload.bootloader = ''
         sys.workload.xiangshan_cpt = True
@@ -123,8 +126,13 @@ def config_difftest(cpu_list, args, sys):
                 cpu.enable_mem_dedup = True
                 cpu.enable_difftest = True
                 cpu.difftest_ref_so = args.difftest_ref_so
+                cpu.difftest_incremental = args.difftest_incremental
         else:
             # sys.enable_mem_dedup = True
             # cpu_list[0].enable_mem_dedup = True
             cpu_list[0].enable_difftest = True
             cpu_list[0].difftest_ref_so = args.difftest_ref_so
+            cpu_list[0].difftest_incremental = args.difftest_incremental
+            cpu_list[0].difftest_async = args.difftest_async
+            cpu_list[0].difftest_async_scalar_only = \
+                args.difftest_async_scalar_only
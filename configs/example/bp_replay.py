@@ -0,0 +1,96 @@
+# Replay a committed control flow trace through one or more
+# DecoupledBPUWithFTB configurations without a CPU.
+#
+# Record the trace once with the cfiTrace parameter of the predictor, e.g.
+#   xiangshan.py ... -P 'system.cpu[0].branchPred.cfiTrace="cfi.gz"'
+# then evaluate any number of predictor variants in one process:
+#   bp_replay.py m5out/cfi.gz \
+#       --config '' \
+#       --config 'tage.numPredictors=8' \
+#       --config 'enableLoopPredictor=True,ftb.numEntries=4096'
+#
+# Each --config is a comma separated list of parameter assignments relative
+# to the predictor. Every configuration gets its own event queue, so they
+# run on separate host threads, and its statistics land under replay (one
+# configuration) or replayN in stats.txt.
+#
+# With --save-warm-state the trained predictor is saved at the end of the
+# replay. Replaying the trace of the instructions leading up to a checkpoint
+# gives a warm predictor for that checkpoint, for runs restoring it with
+#   -P 'system.cpu[0].branchPred.warmStateIn="m5out/bpstate.gz"'
+# The predictor configuration has to be the same in both runs.
+
+import argparse
+
+import m5
+from m5.objects import *
+
+parser = argparse.ArgumentParser(
+    formatter_class=argparse.ArgumentDefaultsHelpFormatter)
+
+parser.add_argument("trace", help="Control flow trace (cfiTrace)")
+parser.add_argument("--config", action="append", default=[],
+                    metavar="PARAM=VALUE[,PARAM=VALUE...]",
+                    help="Predictor configuration, repeat for several")
+parser.add_argument("--max-insts", type=int, default=0,
+                    help="Replay at most this many instructions, 0 for all")
+parser.add_argument("--clock", default="3GHz")
+parser.add_argument("--fetch-width", type=int, default=16)
+parser.add_argument("--commit-width", type=int, default=8)
+parser.add_argument("--window-size", type=int, default=320,
+                    help="Instructions in flight, i.e. ROB entries")
+parser.add_argument("--decode-redirect-latency", type=int, default=5)
+parser.add_argument("--execute-redirect-latency", type=int, default=14)
+parser.add_argument("--commit-latency", type=int, default=20)
+parser.add_argument("--save-warm-state", metavar="FILE",
+                    help="Save the trained predictor to FILE in the outdir, "
+                    "FILE.N for the N-th configuration if there are several")
+parser.add_argument("--serial", action="store_true",
+                    help="Run every configuration on the main thread")
+
+args = parser.parse_args()
+
+def apply_config(bpu, config):
+    for assignment in filter(None, config.split(",")):
+        path, value = assignment.split("=", 1)
+        *parents, name = path.strip().split(".")
+        obj = bpu
+        for parent in parents:
+            obj = getattr(obj, parent)
+        setattr(obj, name, value.strip())
+
+root = Root(full_system=False)
+root.voltage_domain = VoltageDomain()
+
+replays = []
+for i, config in enumerate(args.config or [""]):
+    replay = BPReplay(
+        trace=args.trace,
+        maxInsts=args.max_insts,
+        fetchWidth=args.fetch_width,
+        commitWidth=args.commit_width,
+        windowSize=args.window_size,
+        decodeRedirectLatency=args.decode_redirect_latency,
+        executeRedirectLatency=args.execute_redirect_latency,
+        commitLatency=args.commit_latency)
+    replay.clk_domain = SrcClockDomain(clock=args.clock,
+                                       voltage_domain=root.voltage_domain)
+    replay.bpu = DecoupledBPUWithFTB()
+    apply_config(replay.bpu, config)
+    if args.save_warm_state:
+        replay.bpu.warmStateOut = args.save_warm_state if len(args.config) < 2 \
+            else "%s.%d" % (args.save_warm_state, i)
+    if not args.serial:
+        replay.eventq_index = i
+    replays.append(replay)
+root.replay = replays
+
+if not args.serial and len(replays) > 1:
+    # replays never talk to each other, sync rarely
+    root.sim_quantum = int(1e9)
+
+m5.instantiate()
+
+exit_event = m5.simulate()
+
+print('Exiting @ tick', m5.curTick(), 'because', exit_event.getCause())
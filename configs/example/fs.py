@@ -157,7 +157,12 @@ def build_test_system(np):
     if args.enable_arch_db:
         test_sys.arch_db = ArchDBer(arch_db_file=args.arch_db_file)
         test_sys.arch_db.dump_from_start = args.arch_db_fromstart
+        test_sys.arch_db.backend = args.arch_db_backend
         test_sys.arch_db.enable_rolling = args.enable_rolling
+        if args.rolling_stats:
+            test_sys.arch_db.rolling_stats = args.rolling_stats.split(',')
+            test_sys.arch_db.rolling_base = args.rolling_base
+            test_sys.arch_db.rolling_interval = args.rolling_interval
         test_sys.arch_db.dump_l1_pf_trace = False
         test_sys.arch_db.dump_mem_trace = False
         test_sys.arch_db.dump_l1_evict_trace = False
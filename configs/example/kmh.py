@@ -66,4 +66,7 @@ if __name__ == '__m5_main__':
 
     root = Root(full_system=True, system=test_sys)
 
-    Simulation.run_vanilla(args, root, test_sys, FutureClass)
\ No newline at end of file
+    if args.batch_list:
+        Simulation.run_batch(args, root, test_sys, FutureClass)
+    else:
+        Simulation.run_vanilla(args, root, test_sys, FutureClass)
\ No newline at end of file
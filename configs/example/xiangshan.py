@@ -23,7 +23,6 @@ from common import XSConfig
 from common.Caches import *
 from common import Options
 from common.FUScheduler import *
-from m5.objects import PerfRecord
 
 
 class XiangshanCore(RiscvO3CPU):
@@ -219,17 +218,14 @@ def build_test_system(np, args):
 
     # config arch db
     if args.enable_arch_db:
-        perfCCT_cmd = "CREATE TABLE LifeTimeCommitTrace(ID INTEGER PRIMARY KEY AUTOINCREMENT,"
-        perfCCT_cmd += PerfRecord.vals[0] + " INT NOT NULL"
-        for i in range(1, len(PerfRecord.vals)):
-            name = PerfRecord.vals[i]
-            type_str = "INT" if name.lower().startswith(('at', 'pc')) else "CHAR(20)"
-            perfCCT_cmd += "," + name + " " + type_str + " NOT NULL"
-        perfCCT_cmd += ");"
-
         test_sys.arch_db = ArchDBer(arch_db_file=args.arch_db_file)
         test_sys.arch_db.dump_from_start = args.arch_db_fromstart
+        test_sys.arch_db.backend = args.arch_db_backend
         test_sys.arch_db.enable_rolling = args.enable_rolling
+        if args.rolling_stats:
+            test_sys.arch_db.rolling_stats = args.rolling_stats.split(',')
+            test_sys.arch_db.rolling_base = args.rolling_base
+            test_sys.arch_db.rolling_interval = args.rolling_interval
         test_sys.arch_db.dump_l1_pf_trace = False
         test_sys.arch_db.dump_mem_trace = False
         test_sys.arch_db.dump_l1_evict_trace = False
@@ -300,8 +296,6 @@ def build_test_system(np, args):
             "Conf INT NOT NULL," \
             "Miss BOOL NOT NULL," \
             "SITE TEXT);"
-            ,# perfCounter CommitTrace
-            perfCCT_cmd
         ]
 
     # config debug trace
@@ -418,4 +412,7 @@ if __name__ == '__m5_main__':
 
     root = Root(full_system=True, system=test_sys)
 
-    Simulation.run_vanilla(args, root, test_sys, FutureClass)
+    if args.batch_list:
+        Simulation.run_batch(args, root, test_sys, FutureClass)
+    else:
+        Simulation.run_vanilla(args, root, test_sys, FutureClass)
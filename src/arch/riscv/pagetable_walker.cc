@@ -175,11 +175,12 @@ Walker::doL2TLBHitSchedule(const RequestPtr &req, ThreadContext *tc, BaseMMU::Tr
 
 Fault
 Walker::startFunctional(ThreadContext * _tc, Addr &addr, unsigned &logBytes,
-              BaseMMU::Mode _mode)
+              BaseMMU::Mode _mode, bool fill_tlb)
 {
     funcState.initState(_tc, nullptr, _mode);
     return funcState.startFunctional(addr, logBytes, openNextLine,
-                                     autoOpenNextLine, false, false);
+                                     autoOpenNextLine, false, false,
+                                     fill_tlb);
 }
 
 bool
@@ -532,11 +533,13 @@ Fault
 Walker::WalkerState::startFunctional(Addr &addr, unsigned &logBytes,
                                      bool open_nextline, bool auto_open_nextline,
                                      bool from_forward_pre_req,
-                                     bool from_back_pre_req)
+                                     bool from_back_pre_req,
+                                     bool fill_tlb)
 {
     Fault fault = NoFault;
     assert(!started);
     started = true;
+    fillTlb = fill_tlb;
     setupWalk(0, addr, 2, false, open_nextline, auto_open_nextline, from_forward_pre_req,
               from_back_pre_req);
 
@@ -1300,7 +1303,7 @@ Walker::WalkerState::stepWalk(PacketPtr &write)
         }
 
         if (doTLBInsert) {
-            if (!functional) {
+            if (!functional || fillTlb) {
                 if (((!entry.fromForwardPreReq) && (!entry.fromBackPreReq)) || (preHitInPtw)) {
                     walker->tlb->insert(entry.vaddr, entry, false, direct);
                 }
@@ -153,6 +153,8 @@ namespace RiscvISA
             PrivilegeMode pmode;
             HGATP hgatp;
             bool functional;
+            /** Insert the translation into the TLBs on a functional walk */
+            bool fillTlb;
             bool timing;
             bool retrying;
             bool started;
@@ -193,7 +195,7 @@ namespace RiscvISA
                         const RequestPtr &_req, bool _isFunctional = false) :
                 walker(_walker), mainReq(_req), state(Ready),
                 nextState(Ready), level(0), twoStageLevel(2),inflight(0),
-                functional(_isFunctional), timing(false),
+                functional(_isFunctional), fillTlb(false), timing(false),
                 retrying(false), started(false), squashed(false), nextline(false),
                 nextlineRead(0), nextlineLevel(0), nextlineVaddr(0),
                 nextlineLevelMask(0), nextlineShift(0), tlbVaddr(0), tlbppn(0),
@@ -221,7 +223,8 @@ namespace RiscvISA
             Fault startFunctional(Addr &addr, unsigned &logBytes,
                                   bool open_nextline, bool auto_openNextline,
                                   bool from_forward_pre_req,
-                                  bool from_back_pre_req);
+                                  bool from_back_pre_req,
+                                  bool fill_tlb = false);
             bool recvPacket(PacketPtr pkt);
             unsigned numInflight() const;
             bool isRetrying();
@@ -306,8 +309,13 @@ namespace RiscvISA
 
         // Fault perm_check ();
 
+        /**
+         * Walk without timing. With fill_tlb the TLBs are filled as by a
+         * timing walk, which atomic CPUs use to warm them.
+         */
         Fault startFunctional(ThreadContext * _tc, Addr &addr,
-                unsigned &logBytes, BaseMMU::Mode mode);
+                unsigned &logBytes, BaseMMU::Mode mode,
+                bool fill_tlb = false);
         Port &getPort(const std::string &if_name,
                       PortID idx=InvalidPortID) override;
       protected:
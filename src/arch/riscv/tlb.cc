@@ -2014,7 +2014,14 @@ TLB::translate(const RequestPtr &req, ThreadContext *tc,
                         warn("notice sv48,the vaddr %lx may valid sv48\n", req->getVaddr());
                 }
                 controlNum++;
-                fault = doTranslate(req, tc, translation, mode, delayed);
+                if (translation) {
+                    fault = doTranslate(req, tc, translation, mode, delayed);
+                } else {
+                    // The L2TLB and the walker only work in timing mode,
+                    // atomic CPUs (e.g. for functional warmup) walk the
+                    // page table functionally
+                    fault = translateAtomicWarm(req, tc, mode);
+                }
             }
         }
 
@@ -2135,6 +2142,28 @@ TLB::translateFunctional(const RequestPtr &req, ThreadContext *tc,
     return NoFault;
 }
 
+Fault
+TLB::translateAtomicWarm(const RequestPtr &req, ThreadContext *tc,
+                         BaseMMU::Mode mode)
+{
+    SATP satp = tc->readMiscReg(MISCREG_SATP);
+    if (lookup(req->getVaddr(), satp.asid, mode, false, true, direct)) {
+        // Hits only update the replacement state
+        return translateFunctional(req, tc, mode);
+    }
+
+    Addr paddr = req->getVaddr();
+    unsigned log_bytes;
+    Fault fault = walker->startFunctional(tc, paddr, log_bytes, mode, true);
+    if (fault != NoFault) {
+        return fault;
+    }
+    paddr |= req->getVaddr() & mask(log_bytes);
+    DPRINTF(TLB, "Translated (atomic) %#x -> %#x.\n", req->getVaddr(), paddr);
+    req->setPaddr(paddr);
+    return NoFault;
+}
+
 Fault
 TLB::finalizePhysical(const RequestPtr &req,
                       ThreadContext *tc, BaseMMU::Mode mode) const
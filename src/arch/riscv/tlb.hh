@@ -236,6 +236,12 @@ class TLB : public BaseTLB
                          BaseMMU::Mode mode) override;
     Fault translateFunctional(const RequestPtr &req, ThreadContext *tc,
                               BaseMMU::Mode mode) override;
+    /**
+     * Translate for an atomic CPU, looking the TLB up and filling it on a
+     * miss as a walk would, so that a CPU taking over finds it warm.
+     */
+    Fault translateAtomicWarm(const RequestPtr &req, ThreadContext *tc,
+                              BaseMMU::Mode mode);
     Fault finalizePhysical(const RequestPtr &req, ThreadContext *tc,
                            BaseMMU::Mode mode) const override;
     TlbEntry *lookup(Addr vpn, uint16_t asid, BaseMMU::Mode mode, bool hidden, bool sign_used, uint8_t translateMode);
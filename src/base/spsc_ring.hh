@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2024 Institute of Computing Technology, Chinese Academy of Sciences
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_SPSC_RING_HH__
+#define __BASE_SPSC_RING_HH__
+
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace gem5
+{
+
+/**
+ * Bounded lock-free single-producer/single-consumer ring.
+ *
+ * Exactly one thread may call the producer side (tryPush) and
+ * exactly one other thread may call the consumer side (tryPop/popBatch).
+ * The capacity is rounded up to a power of two so that indexing is a mask.
+ * Head and tail live on separate cache lines, each next to the cached copy
+ * of the other index its owner keeps, so that the producer and the consumer
+ * do not false-share.
+ */
+template <typename T>
+class SPSCRing
+{
+  private:
+    static constexpr size_t CacheLine = 64;
+
+    std::vector<T> slots;
+    const size_t mask;
+
+    /** Next slot to be read, written by the consumer only. */
+    alignas(CacheLine) std::atomic<size_t> head{0};
+    /** Consumer-side cache of tail, on the consumer's line. */
+    size_t cachedTail{0};
+
+    /** Next slot to be written, written by the producer only. */
+    alignas(CacheLine) std::atomic<size_t> tail{0};
+    /** Producer-side cache of head, avoids reading the consumer's line. */
+    size_t cachedHead{0};
+
+    static size_t
+    roundUp(size_t n)
+    {
+        size_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+  public:
+    explicit SPSCRing(size_t capacity)
+        : slots(roundUp(capacity ? capacity : 1)),
+          mask(slots.size() - 1)
+    {}
+
+    size_t capacity() const { return slots.size(); }
+
+    /** Approximate occupancy, exact when called from either endpoint. */
+    size_t
+    size() const
+    {
+        return tail.load(std::memory_order_acquire) -
+               head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+
+    /** Producer: append one element, return false if the ring is full. */
+    bool
+    tryPush(const T &val)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == slots.size())
+                return false;
+        }
+        slots[t & mask] = val;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Producer: move one element in, val is untouched if the ring is full. */
+    bool
+    tryPush(T &&val)
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == slots.size()) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == slots.size())
+                return false;
+        }
+        slots[t & mask] = std::move(val);
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /** Consumer: remove the oldest element into val. */
+    bool
+    tryPop(T &val)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail)
+                return false;
+        }
+        val = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Consumer: remove up to max_num elements into out and return how many
+     * were taken. The head index is published once for the whole batch.
+     */
+    size_t
+    popBatch(T *out, size_t max_num)
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (cachedTail - h < max_num)
+            cachedTail = tail.load(std::memory_order_acquire);
+        size_t n = cachedTail - h;
+        if (n > max_num)
+            n = max_num;
+        for (size_t i = 0; i < n; i++)
+            out[i] = std::move(slots[(h + i) & mask]);
+        if (n)
+            head.store(h + n, std::memory_order_release);
+        return n;
+    }
+};
+
+} // namespace gem5
+
+#endif // __BASE_SPSC_RING_HH__
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2024 Institute of Computing Technology, Chinese Academy of Sciences
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "base/spsc_ring.hh"
+
+using namespace gem5;
+
+/** The capacity is rounded up to the next power of two */
+TEST(SPSCRingTest, Capacity)
+{
+    SPSCRing<uint32_t> ring(5);
+    ASSERT_EQ(ring.capacity(), 8);
+    ASSERT_TRUE(ring.empty());
+}
+
+/** Pushing beyond the capacity fails and keeps the queued elements */
+TEST(SPSCRingTest, Full)
+{
+    SPSCRing<uint32_t> ring(4);
+    for (uint32_t i = 0; i < 4; i++)
+        ASSERT_TRUE(ring.tryPush(i));
+    ASSERT_FALSE(ring.tryPush(4));
+    ASSERT_EQ(ring.size(), 4);
+
+    uint32_t val;
+    ASSERT_TRUE(ring.tryPop(val));
+    ASSERT_EQ(val, 0);
+    ASSERT_TRUE(ring.tryPush(4));
+}
+
+/** Batched pops preserve FIFO order across the wrap-around point */
+TEST(SPSCRingTest, PopBatchWraps)
+{
+    SPSCRing<uint32_t> ring(4);
+    uint32_t out[4];
+    for (uint32_t i = 0; i < 3; i++)
+        ring.tryPush(i);
+    ASSERT_EQ(ring.popBatch(out, 2), 2);
+    for (uint32_t i = 3; i < 6; i++)
+        ASSERT_TRUE(ring.tryPush(i));
+    ASSERT_EQ(ring.popBatch(out, 4), 4);
+    for (uint32_t i = 0; i < 4; i++)
+        ASSERT_EQ(out[i], i + 2);
+    ASSERT_EQ(ring.popBatch(out, 4), 0);
+}
+
+/** A producer and a consumer thread see every element exactly once */
+TEST(SPSCRingTest, TwoThreads)
+{
+    const uint64_t total = 100000;
+    SPSCRing<uint64_t> ring(64);
+    uint64_t sum = 0;
+    uint64_t expected = 0;
+
+    std::thread consumer([&] () {
+        uint64_t buf[16];
+        uint64_t got = 0;
+        while (got < total) {
+            size_t n = ring.popBatch(buf, 16);
+            for (size_t i = 0; i < n; i++) {
+                ASSERT_EQ(buf[i], expected);
+                expected++;
+                sum += buf[i];
+            }
+            got += n;
+            if (!n)
+                std::this_thread::yield();
+        }
+    });
+
+    for (uint64_t i = 0; i < total; i++) {
+        while (!ring.tryPush(i))
+            std::this_thread::yield();
+    }
+    consumer.join();
+
+    ASSERT_EQ(sum, total * (total - 1) / 2);
+    ASSERT_TRUE(ring.empty());
+}
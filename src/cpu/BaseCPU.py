@@ -137,6 +137,9 @@ class BaseCPU(ClockedObject):
     switched_out = Param.Bool(False,
         "Leave the CPU switched out after startup (used when switching " \
         "between CPU models)")
+    flush_tlbs_on_switch_out = Param.Bool(True,
+        "Flush the TLBs when switched out, off when the MMU is shared with "
+        "the CPU taking over")
 
     tracer = Param.InstTracer(default_tracer, "Instruction tracer")
 
@@ -162,6 +165,16 @@ class BaseCPU(ClockedObject):
     enable_riscv_h = Param.Bool(True, "Enable riscv vector extension")
     enable_difftest_inst_trace = Param.Bool(True, "Enable difftest inst trace")
     enable_mem_dedup = Param.Bool(False, "Enable memory deduplication for difftest and golden memory")
+    difftest_incremental = Param.Bool(False,
+        "Only compare registers and CSR groups dirtied since the last difftest step")
+    difftest_full_sweep_interval = Param.Unsigned(10000,
+        "Difftest steps between full-state comparisons in incremental mode")
+    difftest_async = Param.Bool(False, "Step and compare the difftest ref on a helper thread")
+    difftest_async_scalar_only = Param.Bool(False,
+        "Accept that async difftest skips the CSR, vector and hypervisor checks")
+    difftest_async_queue_size = Param.Unsigned(65536, "Commit records buffered for the async difftest checker")
+    difftest_async_batch = Param.Unsigned(256, "Commit records the async difftest checker drains at once")
+    difftest_async_history = Param.Unsigned(32, "Checked commit records kept for async difftest reports")
 
     def createInterruptController(self):
         self.interrupts = [
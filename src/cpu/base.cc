@@ -141,6 +141,7 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
       _taskId(context_switch_task_id::Unknown),
       _pid(invldPid),
       _switchedOut(p.switched_out),
+      flushTLBsOnSwitchOut(p.flush_tlbs_on_switch_out),
       _cacheLineSize(p.system->cacheLineSize()),
       interrupts(p.interrupts),
       numThreads(p.numThreads),
@@ -164,6 +165,8 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
       enableRVV(p.enable_riscv_vector),
       enableRVHDIFF(p.enable_riscv_h),
       enabledifftesInstTrace(p.enable_difftest_inst_trace),
+      incrementalDiff(p.difftest_incremental),
+      diffSweepInterval(p.difftest_full_sweep_interval),
       noHypeMode(false),
       enableMemDedup(p.enable_mem_dedup)
 {
@@ -236,6 +239,34 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
                                params().nemuSDCptBin.c_str());
         }
         diffAllStates->diff.will_handle_intr = false;
+
+        if (params().difftest_async) {
+            if (system->multiCore()) {
+                fatal("Async difftest relies on single-core ref stepping, "
+                      "golden memory checks need the simulation thread\n");
+            }
+            fatal_if(!params().difftest_async_scalar_only,
+                     "Async difftest only compares PC and scalar results, "
+                     "it skips the CSR%s%s checks. Set "
+                     "difftest_async_scalar_only "
+                     "(--difftest-async-scalar-only) to run it anyway\n",
+                     enableRVV ? ", vector" : "",
+                     enableRVHDIFF ? ", hypervisor" : "");
+            diffAllStates->async = std::make_shared<AsyncDifftest>(
+                params().cpu_id, diffAllStates->proxy, &diffAllStates->diff,
+                &diffAllStates->referenceRegFile,
+                params().difftest_async_queue_size,
+                params().difftest_async_batch,
+                params().difftest_async_history);
+            warn("Difftest runs asynchronously on a helper thread, "
+                 "only PC and scalar results are compared\n");
+            // Catch divergences still sitting in the ring at exit
+            auto async = diffAllStates->async;
+            registerExitCallback([async]() {
+                async->sync();
+                async->stop();
+            });
+        }
     } else {
         warn("Difftest is disabled\n");
         diffAllStates->hasCommit = true;
@@ -623,7 +654,9 @@ BaseCPU::switchOut()
 
     // Flush all TLBs in the CPU to avoid having stale translations if
     // it gets switched in later.
-    flushTLBs();
+    if (flushTLBsOnSwitchOut) {
+        flushTLBs();
+    }
 
     // Go to the power gating state
     powerState->set(enums::PwrState::OFF);
@@ -666,7 +699,10 @@ BaseCPU::takeOverFrom(BaseCPU *oldCPU)
             ThreadContext::compare(oldTC, newTC);
         */
 
-        newTC->getMMUPtr()->takeOverFrom(oldTC->getMMUPtr());
+        // A shared MMU (functional warmup) keeps its TLBs and ports
+        if (newTC->getMMUPtr() != oldTC->getMMUPtr()) {
+            newTC->getMMUPtr()->takeOverFrom(oldTC->getMMUPtr());
+        }
 
         // Checker whether or not we have to transfer CheckerCPU
         // objects over in the switch
@@ -952,13 +988,19 @@ BaseCPU::diffWithNEMU(ThreadID tid, InstSeqNum seq)
     DPRINTF(Diff, "MachInst: %#lx\n", machInst);
 
 
+    // In incremental mode only registers and CSRs that the committed
+    // instructions may have touched are compared, with a full sweep every
+    // diffSweepInterval steps
+    const bool full_check = !incrementalDiff || diffStepsSinceSweep >= diffSweepInterval;
+    const uint8_t csr_dirty = full_check ? DiffCsrAll : diffCsrDirty;
+
     if (enableRVV) {
-        if (diffInfo.inst->isVector()) {
+        uint64_t* nemu_val = (uint64_t*)&(diffAllStates->referenceRegFile.vr[0]);
+        uint64_t* gem5_val = (uint64_t*)&(diffAllStates->gem5RegFile.vr[0]);
+        bool maybe_error = false;
+        int error_idx = 0;
+        if (!incrementalDiff && diffInfo.inst->isVector()) {
             readGem5Regs();
-            uint64_t* nemu_val = (uint64_t*)&(diffAllStates->referenceRegFile.vr[0]);
-            uint64_t* gem5_val = (uint64_t*)&(diffAllStates->gem5RegFile.vr[0]);
-            bool maybe_error = false;
-            int error_idx = 0;
             for (int i=0; i < RiscvISA::NumVecElemPerVecReg * 32; i++) {
                 if (nemu_val[i] != gem5_val[i]) {
                     // diff_at = ValueDiff;
@@ -967,29 +1009,46 @@ BaseCPU::diffWithNEMU(ThreadID tid, InstSeqNum seq)
                     break;
                 }
             }
-
-            if (maybe_error) {
-                std::string gem5_val_, nemu_val_;
-                for (int j=RiscvISA::NumVecElemPerVecReg-1; j>=0; j--) {
-                    gem5_val_ += csprintf("%016lx", gem5_val[j + error_idx]);
-                    if (j != 0) {
-                        gem5_val_+="_";
-                    }
+        } else if (incrementalDiff && (full_check || diffVecDirty)) {
+            uint32_t to_check = full_check ? ~0u : diffVecDirty;
+            for (int r = 0; r < 32 && !maybe_error; r++) {
+                if (!(to_check & (1u << r))) {
+                    continue;
                 }
-                for (int j=RiscvISA::NumVecElemPerVecReg-1; j>=0; j--) {
-                    nemu_val_ += csprintf("%016lx", nemu_val[j + error_idx]);
-                    if (j != 0) {
-                        nemu_val_ += "_";
+                readGem5VecReg(r);
+                int base = r * RiscvISA::NumVecElemPerVecReg;
+                for (int j = 0; j < RiscvISA::NumVecElemPerVecReg; j++) {
+                    if (nemu_val[base + j] != gem5_val[base + j]) {
+                        maybe_error = true;
+                        error_idx = base;
+                        break;
                     }
                 }
-                warn("Inst [sn:%lli] pc: %#lx, msg: %s\n", seq, diffInfo.pc->instAddr(),
-                        diffInfo.lastCommittedMsg.back().c_str());
-                warn("May be diff at v%d\n Ref  value: %s\n GEM5 value: %s\n",
-                    (error_idx>>1), nemu_val_, gem5_val_);
-                diff_at = ValueDiff;
             }
         }
+        if (maybe_error) {
+            std::string gem5_val_, nemu_val_;
+            for (int j=RiscvISA::NumVecElemPerVecReg-1; j>=0; j--) {
+                gem5_val_ += csprintf("%016lx", gem5_val[j + error_idx]);
+                if (j != 0) {
+                    gem5_val_+="_";
+                }
+            }
+            for (int j=RiscvISA::NumVecElemPerVecReg-1; j>=0; j--) {
+                nemu_val_ += csprintf("%016lx", nemu_val[j + error_idx]);
+                if (j != 0) {
+                    nemu_val_ += "_";
+                }
+            }
+            warn("Inst [sn:%lli] pc: %#lx, msg: %s\n", seq, diffInfo.pc->instAddr(),
+                    diffInfo.lastCommittedMsg.back().c_str());
+            warn("May be diff at v%d\n Ref  value: %s\n GEM5 value: %s\n",
+                error_idx / RiscvISA::NumVecElemPerVecReg, nemu_val_, gem5_val_);
+            diff_at = ValueDiff;
+        }
+    }
 
+    if (enableRVV && (csr_dirty & DiffCsrVec)) {
         // vtype
         uint64_t gem5_val = readMiscReg(RiscvISA::MiscRegIndex::MISCREG_VTYPE, tid);
         diffAllStates->gem5RegFile.vtype = gem5_val;
@@ -1040,7 +1099,7 @@ BaseCPU::diffWithNEMU(ThreadID tid, InstSeqNum seq)
     }
 
     // always check some CSR regs
-    {
+    if (csr_dirty & DiffCsrMachine) {
         // mstatus
         auto gem5_val = readMiscRegNoEffect(
             RiscvISA::MiscRegIndex::MISCREG_STATUS, tid);
@@ -1167,7 +1226,7 @@ BaseCPU::diffWithNEMU(ThreadID tid, InstSeqNum seq)
         }
     }
 
-    if (enableRVHDIFF){
+    if (enableRVHDIFF && (csr_dirty & DiffCsrHyper)) {
         //h difftest
         //mtval2
         auto gem5_val = readMiscReg(RiscvISA::MiscRegIndex::MISCREG_MTVAL2, tid);
@@ -1423,6 +1482,84 @@ BaseCPU::clearDiffMismatch(ThreadID tid, InstSeqNum seq) {
 }
 
 
+void
+BaseCPU::markDiffDirty()
+{
+    const auto &inst = diffInfo.inst;
+    // CSR instructions, xret, fences on translation state and the like
+    if (inst->isNonSpeculative() || inst->isSerializeAfter() || inst->isSerializeBefore()) {
+        diffCsrDirty |= DiffCsrAll;
+    }
+    if (inst->isVector()) {
+        diffCsrDirty |= DiffCsrMachine | DiffCsrVec;
+    }
+    // Any FP operand, e.g. feq or fcvt.w.d writing an integer register,
+    // may set fflags and mstatus.FS
+    if (inst->isFloating()) {
+        diffCsrDirty |= DiffCsrMachine;
+    }
+    for (int i = 0; i < inst->numDestRegs(); i++) {
+        const auto &dest = inst->destRegIdx(i);
+        if (dest.isFloatReg()) {
+            diffCsrDirty |= DiffCsrMachine;
+        } else if (dest.isVecReg()) {
+            diffVecDirty |= 1u << dest.index();
+            diffCsrDirty |= DiffCsrMachine;
+        }
+    }
+}
+
+void
+BaseCPU::clearDiffDirty(bool swept)
+{
+    diffVecDirty = 0;
+    diffCsrDirty = 0;
+    if (swept) {
+        diffStepsSinceSweep = 0;
+    } else {
+        diffStepsSinceSweep++;
+    }
+}
+
+void
+BaseCPU::pushAsyncDiffRecord(InstSeqNum seq)
+{
+    const auto &inst = diffInfo.inst;
+    DiffCommitRecord rec;
+    rec.seq = seq;
+    rec.tick = curTick();
+    rec.pc = diffInfo.pc->instAddr();
+    rec.npc = diffInfo.pc->as<RiscvISA::PCState>().npc();
+    rec.instr = dynamic_cast<RiscvISA::RiscvStaticInst &>(*inst).machInst;
+    rec.flags = 0;
+    if (diffInfo.curInstStrictOrdered)
+        rec.flags |= DiffCommitRecord::MMIO;
+    if (inst->isStoreConditional())
+        rec.flags |= DiffCommitRecord::SC;
+    if (inst->isAtomic())
+        rec.flags |= DiffCommitRecord::Atomic;
+    else if (inst->isLoad())
+        rec.flags |= DiffCommitRecord::Load;
+    else if (inst->isStore())
+        rec.flags |= DiffCommitRecord::Store;
+
+    rec.numDest = 0;
+    for (int i = 0; i < inst->numDestRegs() && rec.numDest < DiffCommitRecord::MaxDest; i++) {
+        const auto &dest = inst->destRegIdx(i);
+        if ((dest.isFloatReg() || dest.isIntReg()) && !dest.isZeroReg()) {
+            rec.wdst[rec.numDest] = dest.index() + dest.isFloatReg() * 32;
+            rec.wdata[rec.numDest] = diffInfo.scalarResults[i];
+            rec.numDest++;
+        }
+    }
+    rec.paddr = inst->isMemRef() ? diffInfo.physEffAddr : 0;
+    rec.size = inst->isMemRef() ? diffInfo.effSize : 0;
+    rec.lrscValid = diffAllStates->diff.sync.lrscValid;
+    rec.lrscAddr = diffAllStates->diff.sync.lrscAddr;
+
+    diffAllStates->async->push(rec);
+}
+
 void
 BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
 {
@@ -1444,6 +1581,7 @@ BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
     if (fence_should_diff || amo_should_diff || is_sc || other_should_diff || lr_should_diff) {
         should_diff = true;
         if (!diffAllStates->hasCommit && diffInfo.pc->instAddr() == 0x80000000u) {
+            syncAsyncDiff();
             diffAllStates->hasCommit = true;
             readGem5Regs();
             diffAllStates->gem5RegFile.pc = diffInfo.pc->instAddr();
@@ -1451,7 +1589,8 @@ BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
                 auto start = pmemStart + pmemSize * diffAllStates->diff.cpu_id;
                 warn("Start memcpy to NEMU from %#lx, size=%lu \n", (uint64_t)start, pmemSize);
                 diffAllStates->proxy->memcpy(0x80000000u, start, pmemSize, DUT_TO_REF);
-            } else if (enableMemDedup) {
+            } else if (enableMemDedup ||
+                       (system->multiCore() && diffAllStates->proxy->ref_get_backed_memory)) {
                 warn("Let ref share a COW mirror of root memory\n");
                 assert(diffAllStates->proxy->ref_get_backed_memory);
                 diffAllStates->proxy->ref_get_backed_memory(system->createCopyOnWriteBranch(), pmemSize);
@@ -1464,7 +1603,16 @@ BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
         }
     }
 
-    if (enableDifftest && should_diff) {
+    if (incrementalDiff && enableDifftest) {
+        // Microops of one macro-op are compared at the last one, so dirty
+        // state accumulates over every committed instruction
+        markDiffDirty();
+    }
+
+    if (enableDifftest && should_diff && diffAllStates->async) {
+        pushAsyncDiffRecord(seq);
+    } else if (enableDifftest && should_diff) {
+        const bool swept = diffStepsSinceSweep >= diffSweepInterval;
         auto [diff_at, npc_match] = diffWithNEMU(tid, seq);
         if (diff_at != NoneDiff) {
             if (npc_match && diff_at == PCDiff) {
@@ -1490,6 +1638,9 @@ BaseCPU::difftestStep(ThreadID tid, InstSeqNum seq)
         } else {
             clearDiffMismatch(tid, seq);
         }
+        if (incrementalDiff) {
+            clearDiffDirty(swept);
+        }
     }
     committedInstNum++;
     if (dumpCommitFlag && committedInstNum >= dumpStartNum) {
@@ -1611,9 +1762,21 @@ BaseCPU::displayGem5Regs()
 
 }
 
+void
+BaseCPU::notifyFork()
+{
+    // Threads do not survive fork(), the checker would never drain
+    fatal_if(diffAllStates && diffAllStates->async &&
+             diffAllStates->async->running(),
+             "%s: can't fork after the async difftest checker started\n",
+             name());
+}
+
 void
 BaseCPU::difftestRaiseIntr(uint64_t no)
 {
+    syncAsyncDiff();
+    diffCsrDirty |= DiffCsrAll;
     diffAllStates->diff.will_handle_intr = true;
     diffAllStates->proxy->raise_intr(no);
 }
@@ -1628,6 +1791,7 @@ BaseCPU::clearGuideExecInfo()
 void
 BaseCPU::enableDiffPrint()
 {
+    syncAsyncDiff();
     diffAllStates->diff.dynamic_config.debug_difftest = true;
     diffAllStates->proxy->update_config(&diffAllStates->diff.dynamic_config);
 }
@@ -1642,6 +1806,8 @@ void
 BaseCPU::setExceptionGuideExecInfo(uint64_t exception_num, uint64_t mtval, uint64_t stval, bool force_set_jump_target,
                                    uint64_t jump_target, ThreadID tid)
 {
+    syncAsyncDiff();
+    diffCsrDirty |= DiffCsrAll;
     auto &gd = diffAllStates->diff.guide;
     gd.force_raise_exception = true;
     gd.exception_num = exception_num;
@@ -56,6 +56,7 @@
 #include "arch/generic/interrupts.hh"
 #include "base/statistics.hh"
 #include "cpu/difftest.hh"
+#include "cpu/difftest_async.hh"
 #include "debug/Mwait.hh"
 #include "mem/htm.hh"
 #include "mem/port_proxy.hh"
@@ -129,6 +130,9 @@ struct DiffAllStates
     DiffState diff;
     RefProxy *proxy;
 
+    /** Helper-thread checker, only set when difftest_async is enabled. */
+    std::shared_ptr<AsyncDifftest> async;
+
     bool hasCommit{false};
 };
 
@@ -176,6 +180,9 @@ class BaseCPU : public ClockedObject
     /** Is the CPU switched out or active? */
     bool _switchedOut;
 
+    /** Flush the TLBs on switch out, unless the MMU is shared */
+    const bool flushTLBsOnSwitchOut;
+
     /** Cache the cache line size that we get from the system */
     const unsigned int _cacheLineSize;
 
@@ -439,6 +446,8 @@ class BaseCPU : public ClockedObject
      */
     void unserialize(CheckpointIn &cp) override;
 
+    void notifyFork() override;
+
     /**
      * Serialize a single thread.
      *
@@ -690,6 +699,28 @@ class BaseCPU : public ClockedObject
     bool enableRVV{false};
     bool enableRVHDIFF{false};
     bool enabledifftesInstTrace{false};
+
+    /** Only compare registers and CSR groups dirtied since the last step */
+    const bool incrementalDiff{false};
+    /** Steps between full-state comparisons in incremental mode */
+    const uint64_t diffSweepInterval{0};
+    uint64_t diffStepsSinceSweep{0};
+    /** Vector registers written since the last compare, one bit per vreg */
+    uint32_t diffVecDirty{0};
+    /** CSR groups that may have changed since the last compare */
+    uint8_t diffCsrDirty{0};
+
+    enum DiffCsrGroup : uint8_t
+    {
+        DiffCsrMachine = 1 << 0,
+        DiffCsrHyper = 1 << 1,
+        DiffCsrVec = 1 << 2,
+        DiffCsrAll = DiffCsrMachine | DiffCsrHyper | DiffCsrVec,
+    };
+
+    void markDiffDirty();
+    void clearDiffDirty(bool swept);
+
     std::shared_ptr<DiffAllStates> diffAllStates{};
 
     enum  diffRegConfig
@@ -703,6 +734,9 @@ class BaseCPU : public ClockedObject
         panic("difftest:readGem5Regs() is not implemented\n");
     }
 
+    /** Refresh one vector register of gem5RegFile */
+    virtual void readGem5VecReg(int idx) { readGem5Regs(); }
+
     void csrDiffMessage(uint64_t gem5_val, uint64_t ref_val, int error_num, uint64_t &error_reg, InstSeqNum seq,
                         std::string error_csr_name,int &diff_at);
     std::pair<int, bool> diffWithNEMU(ThreadID tid, InstSeqNum seq);
@@ -721,6 +755,17 @@ class BaseCPU : public ClockedObject
     }
     void clearDiffMismatch(ThreadID tid, InstSeqNum seq);
 
+    /** Hand the current diffInfo to the async checker. */
+    void pushAsyncDiffRecord(InstSeqNum seq);
+
+    /** Wait for the async checker so the ref proxy can be used directly. */
+    void
+    syncAsyncDiff()
+    {
+        if (diffAllStates->async)
+            diffAllStates->async->sync();
+    }
+
 
     // NoHype mode split memory space into distinct regions for different cores
     const bool noHypeMode{false};
@@ -783,6 +828,9 @@ class BaseCPU : public ClockedObject
 
     void difftestRaiseIntr(uint64_t no);
 
+    /** A trap committed, so any CSR may differ at the next compare. */
+    void difftestTrapCommitted() { diffCsrDirty |= DiffCsrAll; }
+
     void setSCSuccess(bool success, paddr_t addr);
 
     void setExceptionGuideExecInfo(uint64_t exception_num, uint64_t mtval, uint64_t stval,
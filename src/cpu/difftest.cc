@@ -75,9 +75,10 @@ NemuProxy::NemuProxy(int coreid, const char *ref_so, bool enable_sdcard_diff, bo
         assert(0);
     }
 
+    // Optional unless dedup is on, multi-core refs share golden memory pages with it
+    this->ref_get_backed_memory =
+        (void (*)(void *backed_mem, size_t n))dlsym(handle, "difftest_get_backed_memory");
     if (enable_mem_dedup) {
-        this->ref_get_backed_memory =
-            (void (*)(void *backed_mem, size_t n))dlsym(handle, "difftest_get_backed_memory");
         assert(this->ref_get_backed_memory);
     }
 
@@ -0,0 +1,225 @@
+/***************************************************************************************
+* Copyright (c) 2020-2024 Institute of Computing Technology, Chinese Academy of Sciences
+* Copyright (c) 2020-2021 Peng Cheng Laboratory
+*
+* DiffTest is licensed under Mulan PSL v2.
+* You can use this software according to the terms and conditions of the Mulan PSL v2.
+* You may obtain a copy of Mulan PSL v2 at:
+*          http://license.coscl.org.cn/MulanPSL2
+*
+* THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+* EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+* MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+*
+* See the Mulan PSL v2 for more details.
+***************************************************************************************/
+
+#include "cpu/difftest_async.hh"
+
+#include <algorithm>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+AsyncDifftest::AsyncDifftest(int cpu_id, RefProxy *proxy, DiffState *diff,
+                             riscv64_CPU_regfile *ref_regs,
+                             unsigned queue_size, unsigned batch_size,
+                             unsigned history_size)
+    : cpuId(cpu_id),
+      proxy(proxy),
+      diff(diff),
+      refRegs(ref_regs),
+      ring(queue_size),
+      batchSize(batch_size ? batch_size : 1),
+      history(history_size ? history_size : 1)
+{
+}
+
+AsyncDifftest::~AsyncDifftest()
+{
+    stop();
+}
+
+void
+AsyncDifftest::stop()
+{
+    stopping.store(true, std::memory_order_release);
+    if (worker.joinable())
+        worker.join();
+}
+
+void
+AsyncDifftest::sync()
+{
+    while (checked.load(std::memory_order_acquire) < pushed) {
+        if (failed.load(std::memory_order_acquire))
+            reportAndPanic();
+        std::this_thread::yield();
+    }
+    if (failed.load(std::memory_order_acquire))
+        reportAndPanic();
+}
+
+void
+AsyncDifftest::run()
+{
+    std::vector<DiffCommitRecord> batch(batchSize);
+    while (true) {
+        size_t n = ring.popBatch(batch.data(), batchSize);
+        if (n == 0) {
+            if (stopping.load(std::memory_order_acquire) && ring.empty())
+                return;
+            std::this_thread::yield();
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            history[historyHead++ % history.size()] = batch[i];
+            if (!check(batch[i])) {
+                failed.store(true, std::memory_order_release);
+                return;
+            }
+        }
+        checked.fetch_add(n, std::memory_order_release);
+    }
+}
+
+bool
+AsyncDifftest::check(const DiffCommitRecord &rec)
+{
+    bool npc_match = false;
+    report.clear();
+    if (stepAndCompare(rec, npc_match))
+        return true;
+
+    if (npc_match) {
+        // NEMU seems to commit the failed mem instruction separately,
+        // let it run one more instruction like the synchronous path does
+        npc_match = false;
+        if (stepAndCompare(rec, npc_match)) {
+            report.clear();
+            return true;
+        }
+    }
+    return false;
+}
+
+bool
+AsyncDifftest::stepAndCompare(const DiffCommitRecord &rec, bool &npc_match)
+{
+    if (rec.flags & DiffCommitRecord::SC) {
+        SyncState sync{rec.lrscValid, rec.lrscAddr};
+        proxy->uarchstatus_cpy(&sync, DIFFTEST_TO_REF);
+    }
+
+    if (diff->will_handle_intr) {
+        proxy->regcpy(refRegs, REF_TO_DIFFTEST);
+        diff->nemu_this_pc = refRegs->pc;
+        diff->will_handle_intr = false;
+    }
+
+    if (rec.flags & DiffCommitRecord::MMIO) {
+        // Skip stepping NEMU, force the DUT results into the reference
+        refRegs->pc = rec.npc;
+        for (unsigned i = 0; i < rec.numDest; i++) {
+            (*refRegs)[rec.wdst[i]] = rec.wdata[i];
+        }
+        proxy->regcpy(refRegs, DUT_TO_REF);
+        diff->nemu_commit_inst_pc = rec.pc;
+        diff->nemu_this_pc = rec.npc;
+        diff->npc = rec.npc;
+        return true;
+    }
+
+    proxy->exec(1);
+    proxy->regcpy(refRegs, REF_TO_DIFFTEST);
+    diff->nemu_commit_inst_pc = diff->nemu_this_pc;
+    diff->nemu_this_pc = refRegs->pc;
+    diff->npc = refRegs->pc;
+
+    if (diff->nemu_commit_inst_pc != rec.pc) {
+        report += csprintf("Diff at PC, NEMU: %#lx, GEM5: %#lx, NEMU npc: %#lx\n",
+                           diff->nemu_commit_inst_pc, rec.pc, diff->npc);
+        npc_match = diff->npc == rec.pc;
+        return false;
+    }
+
+    bool match = true;
+    for (unsigned i = 0; i < rec.numDest; i++) {
+        const unsigned tag = rec.wdst[i];
+        const uint64_t gem5_val = rec.wdata[i];
+        const uint64_t ref_val = (*refRegs)[tag];
+        if (gem5_val == ref_val) {
+            continue;
+        }
+        if (tag >= 32 && (gem5_val ^ ref_val) == ((0xffffffffULL) << 32)) {
+            // Difference might be caused by NaN boxing, ignore it
+            continue;
+        }
+        bool skip_csr = false;
+        for (auto csr_inst : skipCSRs) {
+            if ((rec.instr & 0xfff00073) == csr_inst) {
+                skip_csr = true;
+                break;
+            }
+        }
+        if (skip_csr) {
+            (*refRegs)[tag] = gem5_val;
+            proxy->regcpy(refRegs, DUT_TO_REF);
+            continue;
+        }
+        report += csprintf("Diff at %s Ref value: %#lx, GEM5 value: %#lx\n",
+                           reg_name[tag], ref_val, gem5_val);
+        match = false;
+    }
+    return match;
+}
+
+std::string
+AsyncDifftest::formatRecord(const DiffCommitRecord &rec) const
+{
+    std::string str = csprintf("[sn:%llu] tick %llu pc %#lx inst %#010x",
+                               rec.seq, rec.tick, rec.pc, rec.instr);
+    for (unsigned i = 0; i < rec.numDest; i++) {
+        str += csprintf(" %s=%#lx", reg_name[rec.wdst[i]], rec.wdata[i]);
+    }
+    if (rec.flags & (DiffCommitRecord::Load | DiffCommitRecord::Store |
+                     DiffCommitRecord::Atomic)) {
+        str += csprintf(" %s paddr %#lx size %lu",
+                        rec.flags & DiffCommitRecord::Atomic ? "AMO"
+                        : rec.flags & DiffCommitRecord::Load ? "Load"
+                                                             : "Store",
+                        rec.paddr, rec.size);
+    }
+    if (rec.flags & DiffCommitRecord::MMIO) {
+        str += " mmio";
+    }
+    return str;
+}
+
+void
+AsyncDifftest::reportAndPanic()
+{
+    // The checker thread has returned after setting failed, so both the
+    // report and the proxy are safe to touch from here.
+    if (worker.joinable())
+        worker.join();
+
+    const auto &bad = history[(historyHead - 1) % history.size()];
+    warn("CPU%d async difftest diverged after %lu checked instructions\n",
+         cpuId, checked.load());
+    warn("%s", report);
+    proxy->isa_reg_display();
+
+    uint64_t num = std::min<uint64_t>(historyHead, history.size());
+    warn("start dump last %lu committed records\n", num);
+    for (uint64_t i = historyHead - num; i < historyHead; i++) {
+        warn("V %s\n", formatRecord(history[i % history.size()]));
+    }
+    panic("Difftest failed at [sn:%llu] tick %llu pc %#lx!\n",
+          bad.seq, bad.tick, bad.pc);
+}
+
+} // namespace gem5
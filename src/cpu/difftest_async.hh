@@ -0,0 +1,166 @@
+/***************************************************************************************
+* Copyright (c) 2020-2024 Institute of Computing Technology, Chinese Academy of Sciences
+* Copyright (c) 2020-2021 Peng Cheng Laboratory
+*
+* DiffTest is licensed under Mulan PSL v2.
+* You can use this software according to the terms and conditions of the Mulan PSL v2.
+* You may obtain a copy of Mulan PSL v2 at:
+*          http://license.coscl.org.cn/MulanPSL2
+*
+* THIS SOFTWARE IS PROVIDED ON AN "AS IS" BASIS, WITHOUT WARRANTIES OF ANY KIND,
+* EITHER EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO NON-INFRINGEMENT,
+* MERCHANTABILITY OR FIT FOR A PARTICULAR PURPOSE.
+*
+* See the Mulan PSL v2 for more details.
+***************************************************************************************/
+
+#ifndef __CPU_DIFFTEST_ASYNC_HH__
+#define __CPU_DIFFTEST_ASYNC_HH__
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "base/spsc_ring.hh"
+#include "base/types.hh"
+#include "cpu/difftest.hh"
+#include "cpu/inst_seq.hh"
+
+namespace gem5
+{
+
+/**
+ * Compact per-instruction commit record handed from the simulation thread
+ * to the asynchronous difftest checker. It only carries what the checker
+ * needs to step the reference and compare scalar results, so it can be
+ * copied into the ring without touching any refcounted gem5 object.
+ */
+struct DiffCommitRecord
+{
+    enum Flags : uint8_t
+    {
+        MMIO = 1 << 0,
+        SC = 1 << 1,
+        Store = 1 << 2,
+        Load = 1 << 3,
+        Atomic = 1 << 4,
+    };
+
+    static constexpr unsigned MaxDest = 2;
+
+    InstSeqNum seq;
+    Tick tick;
+    uint64_t pc;
+    uint64_t npc;
+    uint32_t instr;
+    uint8_t flags;
+    uint8_t numDest;
+    /** Difftest register index (0~31 GPR, 32~63 FPR) of each dest. */
+    uint8_t wdst[MaxDest];
+    uint64_t wdata[MaxDest];
+    /** Physical address and size of the memory access, if any. */
+    uint64_t paddr;
+    uint64_t size;
+    /** LR/SC reservation state captured when the SC committed. */
+    uint64_t lrscValid;
+    uint64_t lrscAddr;
+};
+
+/**
+ * Runs the NEMU reference on a helper thread.
+ *
+ * The simulation thread pushes DiffCommitRecords into a lock-free SPSC ring
+ * at commit. The checker thread drains the ring in batches, steps the
+ * reference once per record and compares PC and scalar destination
+ * registers. On the first divergence it stops consuming and keeps a report
+ * holding the failing record and the last few commits, which the simulation
+ * thread picks up on its next push or sync.
+ *
+ * The checker thread starts with the first push, so that a simulator
+ * forked before simulating (batch mode) has it in the child only.
+ *
+ * The reference proxy is not thread-safe: whenever the simulation thread
+ * needs to talk to it directly (interrupts, guided exceptions, config
+ * updates), it must call sync() first so the checker is idle.
+ */
+class AsyncDifftest
+{
+  public:
+    AsyncDifftest(int cpu_id, RefProxy *proxy, DiffState *diff,
+                  riscv64_CPU_regfile *ref_regs, unsigned queue_size,
+                  unsigned batch_size, unsigned history_size);
+    ~AsyncDifftest();
+
+    /** Push one commit record, blocking while the ring is full. */
+    void
+    push(const DiffCommitRecord &rec)
+    {
+        if (failed.load(std::memory_order_acquire))
+            reportAndPanic();
+        if (!worker.joinable()) [[unlikely]]
+            worker = std::thread(&AsyncDifftest::run, this);
+        while (!ring.tryPush(rec)) {
+            if (failed.load(std::memory_order_acquire))
+                reportAndPanic();
+            stallPushes++;
+            std::this_thread::yield();
+        }
+        pushed++;
+    }
+
+    /**
+     * Wait until every pushed record has been checked. Panics with the
+     * divergence report if the checker found a mismatch.
+     */
+    void sync();
+
+    /** Stop the checker thread after draining the ring. */
+    void stop();
+
+    uint64_t numChecked() const { return checked.load(); }
+
+    /** Whether the checker thread has been started. */
+    bool running() const { return worker.joinable(); }
+
+  private:
+    void run();
+
+    /** Compare one record, return false and fill report on mismatch. */
+    bool check(const DiffCommitRecord &rec);
+
+    bool stepAndCompare(const DiffCommitRecord &rec, bool &npc_match);
+
+    std::string formatRecord(const DiffCommitRecord &rec) const;
+
+    [[noreturn]] void reportAndPanic();
+
+    const int cpuId;
+    RefProxy *proxy;
+    DiffState *diff;
+    riscv64_CPU_regfile *refRegs;
+
+    SPSCRing<DiffCommitRecord> ring;
+    const unsigned batchSize;
+
+    /** Circular buffer of recently checked records, owned by the checker. */
+    std::vector<DiffCommitRecord> history;
+    uint64_t historyHead{0};
+
+    std::string report;
+
+    std::atomic<bool> failed{false};
+    std::atomic<bool> stopping{false};
+    std::atomic<uint64_t> checked{0};
+
+    /** Producer-side counters. */
+    uint64_t pushed{0};
+    uint64_t stallPushes{0};
+
+    std::thread worker;
+};
+
+} // namespace gem5
+
+#endif // __CPU_DIFFTEST_ASYNC_HH__
@@ -51,7 +51,7 @@ GoldenGloablMem::guestToHost(uint64_t addr)
 void
 GoldenGloablMem::goldenMemFinish()
 {
-    // do nothing because memory is released in dedupMemManager
+    // do nothing because memory is released in dedupMemManager or physmem
 }
 
 void
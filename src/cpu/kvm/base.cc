@@ -411,6 +411,8 @@ BaseKvmCPU::drainResume()
 void
 BaseKvmCPU::notifyFork()
 {
+    BaseCPU::notifyFork();
+
     // We should have drained prior to forking, which means that the
     // tick event shouldn't be scheduled and the CPU is idle.
     assert(!tickEvent.scheduled());
@@ -167,6 +167,10 @@ class BaseO3CPU(BaseCPU):
             "Time buffer size for backwards communication")
     forwardComSize = Param.Unsigned(10,
             "Time buffer size for forward communication")
+    skipMemStalls = Param.Bool(False,
+            "Stop ticking while the pipeline waits on loads that missed in "
+            "every cache (assumes no cache below the L3), counting the "
+            "skipped cycles in bulk when a response wakes the CPU")
 
     LQEntries = Param.Unsigned(80, "Number of load queue entries")
     SQEntries = Param.Unsigned(64, "Number of store queue entries")
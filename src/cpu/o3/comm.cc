@@ -0,0 +1,21 @@
+#include "cpu/o3/comm.hh"
+
+#include "cpu/o3/dyn_inst.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+// Out of line, as clearing a slot may free the instructions it holds
+
+void FetchStruct::reset() { *this = FetchStruct(); }
+void DecodeStruct::reset() { *this = DecodeStruct(); }
+void RenameStruct::reset() { *this = RenameStruct(); }
+void IEWStruct::reset() { *this = IEWStruct(); }
+void IssueStruct::reset() { *this = IssueStruct(); }
+void TimeStruct::reset() { *this = TimeStruct(); }
+
+} // namespace o3
+} // namespace gem5
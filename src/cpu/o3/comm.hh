@@ -42,9 +42,11 @@
 #ifndef __CPU_O3_COMM_HH__
 #define __CPU_O3_COMM_HH__
 
+#include <array>
 #include <vector>
 
 #include "arch/generic/pcstate.hh"
+#include "base/logging.hh"
 #include "base/types.hh"
 #include "config/the_isa.hh"
 #include "cpu/inst_seq.hh"
@@ -105,6 +107,47 @@ enum StallReason {
     NumStallReasons
 };
 
+/**
+ * The stall reasons of the slots of a stage, at most MaxWidth of them, in
+ * place so that passing them down the pipeline never allocates. Empty until
+ * set for the cycle, as the vectors of the stages are copied in.
+ */
+class StallReasons
+{
+  public:
+    StallReasons &
+    operator=(const std::vector<StallReason> &reasons)
+    {
+        panic_if(reasons.size() > MaxWidth,
+                 "%lu stall reasons for a width of at most %d\n",
+                 reasons.size(), MaxWidth);
+        std::copy(reasons.begin(), reasons.end(), slots.begin());
+        count = reasons.size();
+        return *this;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    void clear() { count = 0; }
+
+    StallReason &operator[](size_t i) { return slots[i]; }
+    const StallReason &operator[](size_t i) const { return slots[i]; }
+
+    const StallReason &
+    at(size_t i) const
+    {
+        panic_if(i >= count, "Stall reason %lu of %lu\n", i, count);
+        return slots[i];
+    }
+
+    const StallReason *begin() const { return slots.data(); }
+    const StallReason *end() const { return slots.data() + count; }
+
+  private:
+    std::array<StallReason, MaxWidth> slots{};
+    size_t count{0};
+};
+
 /** Struct that defines the information passed from fetch to decode. */
 struct FetchStruct
 {
@@ -114,7 +157,10 @@ struct FetchStruct
     Fault fetchFault;
     InstSeqNum fetchFaultSN;
     bool clearFetchFault;
-    std::vector<StallReason> fetchStallReason;
+    StallReasons fetchStallReason;
+
+    /** Clear as a new slot of the time buffer would be */
+    void reset();
 };
 
 /** Struct that defines the information passed from decode to rename. */
@@ -123,8 +169,10 @@ struct DecodeStruct
     int size;
 
     DynInstPtr insts[MaxWidth];
-    std::vector<StallReason> fetchStallReason;
-    std::vector<StallReason> decodeStallReason;
+    StallReasons fetchStallReason;
+    StallReasons decodeStallReason;
+
+    void reset();
 };
 
 /** Struct that defines the information passed from rename to IEW. */
@@ -133,9 +181,11 @@ struct RenameStruct
     int size;
 
     DynInstPtr insts[MaxWidth];
-    std::vector<StallReason> fetchStallReason;
-    std::vector<StallReason> decodeStallReason;
-    std::vector<StallReason> renameStallReason;
+    StallReasons fetchStallReason;
+    StallReasons decodeStallReason;
+    StallReasons renameStallReason;
+
+    void reset();
 };
 
 /** Struct that defines the information passed from IEW to commit. */
@@ -156,6 +206,8 @@ struct IEWStruct
     bool branchMispredict[MaxThreads];
     bool branchTaken[MaxThreads];
     bool includeSquashInst[MaxThreads];
+
+    void reset();
 };
 
 struct IssueStruct
@@ -163,6 +215,8 @@ struct IssueStruct
     int size;
 
     DynInstPtr insts[MaxWidth];
+
+    void reset();
 };
 
 struct SquashVersion
@@ -326,6 +380,8 @@ struct TimeStruct
     bool renameUnblock[MaxThreads];
     bool iewBlock[MaxThreads];
     bool iewUnblock[MaxThreads];
+
+    void reset();
 };
 
 } // namespace o3
@@ -823,6 +823,36 @@ Commit::tick()
     updateStatus();
 }
 
+bool
+Commit::canSkipCycles()
+{
+    const ThreadID tid = 0;
+
+    if (commitStatus[tid] != Running || trapSquash[tid] || tcSquash[tid] ||
+        trapInFlight[tid] || interrupt != NoFault ||
+        (FullSystem && cpu->checkInterrupts(0))) {
+        return false;
+    }
+
+    if (fromIEW->squash[tid] || fromIEW->size || fromRename->size ||
+        changedROBNumEntries[tid]) {
+        return false;
+    }
+
+    return !rob->isEmpty(tid) && !rob->isHeadReady(tid);
+}
+
+void
+Commit::skipCycles(Cycles cycles)
+{
+    stats.numCommittedDist.sample(0, cycles);
+
+    const DynInstPtr &inst = rob->readHeadInst(0);
+    for (uint64_t i = 0; i < cycles; i++) {
+        ppCommitStall->notify(inst);
+    }
+}
+
 void
 Commit::handleInterrupt()
 {
@@ -1184,7 +1214,7 @@ Commit::commitInsts()
 
             if (commit_success) {
                 cpu->perfCCT->updateInstPos(head_inst->seqNum, PerfRecord::AtCommit);
-                cpu->perfCCT->commitMeta(head_inst->seqNum);
+                cpu->perfCCT->commitMeta(head_inst);
                 head_inst->printDisassemblyAndResult(cpu->name());
                 if (ismispred) {
                     ismispred = false;
@@ -1565,6 +1595,10 @@ Commit::commitHead(const DynInstPtr &head_inst, unsigned inst_num)
 
         cpu->mmu->setOldPriv(cpu->getContext(tid));
 
+        if (cpu->difftestEnabled()) {
+            cpu->difftestTrapCommitted();
+        }
+
         // Exit state update mode to avoid accidental updating.
         thread[tid]->noSquashFromTC = false;
 
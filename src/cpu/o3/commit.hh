@@ -226,6 +226,15 @@ class Commit
     /** Ticks the commit stage, which tries to commit instructions. */
     void tick();
 
+    /**
+     * Returns if commit is only waiting on a ROB head that is not ready,
+     * with nothing coming in from the other stages.
+     */
+    bool canSkipCycles();
+
+    /** Counts skipped cycles as ones the head could not commit. */
+    void skipCycles(Cycles cycles);
+
     /** Handles any squashes that are sent from IEW, and adds instructions
      * to the ROB and tries to commit instructions.
      */
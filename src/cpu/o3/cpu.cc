@@ -119,12 +119,15 @@ CPU::CPU(const BaseO3CPUParams &params)
       activityRec(name(), NumStages,
                   params.backComSize + params.forwardComSize,
                   params.activity),
+      skipMemStalls(params.skipMemStalls),
+      stallSkipWindow(params.backComSize + params.forwardComSize),
 
       globalSeqNum(1),
       system(params.system),
       lastRunningCycle(curCycle()),
       archDBer(params.arch_db),
-      perfCCT(new PerfCCT(params.arch_db && params.arch_db->dumpLifetime, params.arch_db)),
+      perfCCT(new PerfCCT(params.arch_db && params.arch_db->dumpLifetime,
+                          params.arch_db, params.cpu_id)),
       ipc_r("ipc", "", 1000, archDBer),
       cpi_r("cpi", "", 1000, archDBer),
       issueWidth(params.decodeWidth),
@@ -133,6 +136,9 @@ CPU::CPU(const BaseO3CPUParams &params)
     fatal_if(FullSystem && params.numThreads > 1,
             "SMT is not supported in O3 in full system mode currently.");
 
+    // The ROB and as much again in the front end, grows if that is not enough
+    instList.reserve(2 * params.numROBEntries);
+
     fatal_if(!FullSystem && params.numThreads < params.workload.size(),
             "More workload items (%d) than threads (%d) on CPU %s.",
             params.workload.size(), params.numThreads, name());
@@ -351,6 +357,9 @@ CPU::CPUStats::CPUStats(CPU *cpu)
       ADD_STAT(quiesceCycles, statistics::units::Cycle::get(),
                "Total number of cycles that CPU has spent quiesced or waiting "
                "for an interrupt"),
+      ADD_STAT(skippedCycles, statistics::units::Cycle::get(),
+               "Total number of cycles that the CPU skipped over memory "
+               "stalls, counted as stalled by each stage"),
       ADD_STAT(committedInsts, statistics::units::Count::get(),
                "Number of Instructions Simulated"),
       ADD_STAT(committedOps, statistics::units::Count::get(),
@@ -449,6 +458,9 @@ CPU::CPUStats::CPUStats(CPU *cpu)
     quiesceCycles
         .prereq(quiesceCycles);
 
+    skippedCycles
+        .prereq(skippedCycles);
+
     // Number of Instructions simulated
     // --------------------------------
     // Should probably be in Base CPU but need templated
@@ -591,6 +603,10 @@ CPU::tick()
             DPRINTF(O3CPU, "Idle!\n");
             lastRunningCycle = curCycle();
             cpuStats.timesIdled++;
+        } else if (canSkipStall()) {
+            DPRINTF(O3CPU, "Stalled on memory, skipping ahead!\n");
+            lastRunningCycle = curCycle();
+            skippingStall = true;
         } else {
             lastRunningCycle = curCycle();
             schedule(tickEvent, clockEdge(Cycles(1)));
@@ -715,6 +731,9 @@ CPU::activateContext(ThreadID tid)
     // If we are time 0 or if the last activation time is in the past,
     // schedule the next tick and wake up the fetch unit
     if (lastActivatedCycle == 0 || lastActivatedCycle < curTick()) {
+        if (skippingStall) {
+            endStallSkip();
+        }
         scheduleTickEvent(Cycles(0));
 
         // Be sure to signal that there's some activity so the CPU doesn't
@@ -1317,9 +1336,7 @@ CPU::squashFromTC(ThreadID tid)
 CPU::ListIt
 CPU::addInst(const DynInstPtr &inst)
 {
-    instList.push_back(inst);
-
-    return --(instList.end());
+    return instList.push_back(inst);
 }
 
 void
@@ -1525,6 +1542,11 @@ CPU::wakeDependents(const DynInstPtr &inst)
 void
 CPU::wakeCPU()
 {
+    if (skippingStall) {
+        endStallSkip();
+        return;
+    }
+
     if (activityRec.active() || tickEvent.scheduled()) {
         DPRINTF(Activity, "CPU already running.\n");
         return;
@@ -1543,11 +1565,62 @@ CPU::wakeCPU()
     schedule(tickEvent, clockEdge());
 }
 
+bool
+CPU::canSkipStall()
+{
+    if (!skipMemStalls || numThreads != 1 || _status != Running ||
+        drainState() != DrainState::Running || removeInstsThisCycle) {
+        return false;
+    }
+
+    // Commit first, a head that is not waiting rules out most cycles
+    if (!commit.canSkipCycles() || !iew.canSkipCycles() ||
+        !rename.canSkipCycles() || !decode.canSkipCycles() ||
+        !fetch.canSkipCycles()) {
+        stalledCycles = 0;
+        return false;
+    }
+
+    return ++stalledCycles > stallSkipWindow;
+}
+
+void
+CPU::endStallSkip()
+{
+    assert(skippingStall);
+    skippingStall = false;
+    stalledCycles = 0;
+
+    // The cycles after the last tick and before this one
+    Cycles cycles(0);
+    if (curCycle() > lastRunningCycle + Cycles(1)) {
+        cycles = curCycle() - lastRunningCycle - Cycles(1);
+    }
+    DPRINTF(Activity, "Waking up CPU after skipping %llu stalled cycles\n",
+            (uint64_t)cycles);
+
+    if (cycles > 0) {
+        baseStats.numCycles += cycles;
+        cpuStats.skippedCycles += cycles;
+        fetch.skipCycles(cycles);
+        decode.skipCycles(cycles);
+        rename.skipCycles(cycles);
+        iew.skipCycles(cycles);
+        commit.skipCycles(cycles);
+    }
+
+    schedule(tickEvent, curCycle() > lastRunningCycle ?
+             clockEdge() : clockEdge(Cycles(1)));
+}
+
 void
 CPU::wakeup(ThreadID tid)
 {
-    if (thread[tid]->status() != gem5::ThreadContext::Suspended)
+    if (thread[tid]->status() != gem5::ThreadContext::Suspended) {
+        // An interrupt to take
+        wakeFromStallSkip();
         return;
+    }
 
     wakeCPU();
 
@@ -1697,6 +1770,12 @@ CPU::readGem5Regs()
     }
 }
 
+void
+CPU::readGem5VecReg(int idx)
+{
+    readArchVecReg(idx, (uint64_t*)&diffAllStates->gem5RegFile.vr[idx], 0);
+}
+
 RegVal
 CPU::readArchIntReg(int reg_idx, ThreadID tid)
 {
@@ -63,6 +63,7 @@
 #include "cpu/o3/fetch.hh"
 #include "cpu/o3/free_list.hh"
 #include "cpu/o3/iew.hh"
+#include "cpu/o3/inst_ring.hh"
 #include "cpu/o3/limits.hh"
 #include "cpu/o3/perfCCT.hh"
 #include "cpu/o3/rename.hh"
@@ -99,7 +100,7 @@ class ThreadContext;
 class CPU : public BaseCPU
 {
   public:
-    typedef std::list<DynInstPtr>::iterator ListIt;
+    typedef InstList::iterator ListIt;
 
     friend class ThreadContext;
 
@@ -408,7 +409,7 @@ class CPU : public BaseCPU
 #endif
 
     /** List of all the instructions in flight. */
-    std::list<DynInstPtr> instList;
+    InstList instList;
 
     /** List of all the instructions that will be removed at the end of this
      *  cycle.
@@ -510,6 +511,31 @@ class CPU : public BaseCPU
      */
     ActivityRecorder activityRec;
 
+    /** Whether to skip the cycles of long memory stalls. */
+    const bool skipMemStalls;
+
+    /** Stalled cycles before the CPU stops ticking, enough for the time
+     * buffers to hold nothing but the stall.
+     */
+    const unsigned stallSkipWindow;
+
+    /** Consecutive cycles at the end of which every stage was stalled. */
+    unsigned stalledCycles = 0;
+
+    /** Whether the CPU stopped ticking over a stall. */
+    bool skippingStall = false;
+
+    /**
+     * Whether no stage can make progress until the memory system or an
+     * event wakes the CPU, and has not for long enough to stop ticking.
+     */
+    bool canSkipStall();
+
+    /** Count the cycles skipped over a stall as the stages would have, and
+     * tick again.
+     */
+    void endStallSkip();
+
   public:
     /** Records that there was time buffer activity this cycle. */
     void activityThisCycle() { activityRec.activity(); }
@@ -531,6 +557,18 @@ class CPU : public BaseCPU
     /** Wakes the CPU, rescheduling the CPU if it's not already active. */
     void wakeCPU();
 
+    /**
+     * Tick again if the CPU stopped over a memory stall, for memory
+     * events that would not wake an idle CPU otherwise.
+     */
+    void
+    wakeFromStallSkip()
+    {
+        if (skippingStall) {
+            endStallSkip();
+        }
+    }
+
     virtual void wakeup(ThreadID tid) override;
 
     /** Gets a free thread id. Use if thread ids change across system. */
@@ -620,6 +658,9 @@ class CPU : public BaseCPU
         /** Stat for total number of cycles the CPU spends descheduled due to a
          * quiesce operation or waiting for an interrupt. */
         statistics::Scalar quiesceCycles;
+        /** Stat for total number of cycles the CPU skipped over memory
+         * stalls. */
+        statistics::Scalar skippedCycles;
         /** Stat for the number of committed instructions per thread. */
         statistics::Vector committedInsts;
         /** Stat for the number of committed ops (including micro ops) per
@@ -694,6 +735,8 @@ class CPU : public BaseCPU
 
     //difftest virtual function
     void readGem5Regs() override;
+
+    void readGem5VecReg(int idx) override;
 };
 
 } // namespace o3
@@ -634,6 +634,21 @@ Decode::tick()
     }
 }
 
+bool
+Decode::canSkipCycles() const
+{
+    const ThreadID tid = 0;
+    return decodeStatus[tid] == Blocked && stalls[tid].rename &&
+        !fromRename->renameUnblock[tid] &&
+        !fromCommit->commitInfo[tid].squash && fromFetch->size == 0;
+}
+
+void
+Decode::skipCycles(Cycles cycles)
+{
+    stats.blockedCycles += cycles;
+}
+
 void
 Decode::decode(bool &status_change, ThreadID tid)
 {
@@ -137,6 +137,14 @@ class Decode
      */
     void tick();
 
+    /** Whether the next ticks would only count a cycle blocked on rename,
+     * with nothing coming from fetch.
+     */
+    bool canSkipCycles() const;
+
+    /** Count cycles skipped while canSkipCycles() held as blocked. */
+    void skipCycles(Cycles cycles);
+
     /** Determines what to do based on decode's current status.
      * @param status_change decode() sets this variable if there was a status
      * change (ie switching from from blocking to unblocking).
@@ -0,0 +1,146 @@
+#ifndef __CPU_O3_DEP_MATRIX_HH__
+#define __CPU_O3_DEP_MATRIX_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "cpu/o3/dyn_inst.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * The source operands of the instructions of an issue queue that wait on a
+ * physical register, as a CAM of operands matched against the register
+ * broadcast on wakeup would hold them.
+ *
+ * Every waiting operand takes an entry, and every register has a bitmap of
+ * the entries waiting on it, so a wakeup walks the bits of one row. An
+ * operand stays in its row through speculative wakeups, so that a cancel
+ * can find it and a later wakeup wake it again, and leaves it when the
+ * register is written back or the instruction squashed.
+ */
+class DepMatrix
+{
+  public:
+    /** Rows for num_regs registers, only while empty */
+    void
+    resize(size_t num_regs)
+    {
+        numRegs = num_regs;
+        rows.assign(numRegs * words, 0);
+    }
+
+    /** Source src_idx of inst waits on reg */
+    void
+    add(RegIndex reg, const DynInstPtr &inst, int src_idx)
+    {
+        if (freeEntries.empty()) {
+            grow();
+        }
+        uint32_t entry = freeEntries.back();
+        freeEntries.pop_back();
+        entries[entry] = Entry{inst, reg, src_idx};
+        rows[reg * words + entry / 64] |= bit(entry);
+    }
+
+    /**
+     * Call f(inst, src_idx) for every operand waiting on reg. f may not add
+     * or remove operands.
+     */
+    template <typename F>
+    void
+    forEachWaiting(RegIndex reg, F f) const
+    {
+        const uint64_t *row = rows.data() + reg * words;
+        for (size_t w = 0; w < words; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                auto &entry = entries[w * 64 + findLsbSet(bits)];
+                f(entry.inst, entry.srcIdx);
+            }
+        }
+    }
+
+    /** reg was written back, no operand waits on it any more */
+    void
+    clear(RegIndex reg)
+    {
+        uint64_t *row = rows.data() + reg * words;
+        for (size_t w = 0; w < words; w++) {
+            for (uint64_t bits = row[w]; bits; bits &= bits - 1) {
+                release(w * 64 + findLsbSet(bits));
+            }
+            row[w] = 0;
+        }
+    }
+
+    /** Drop the operands of the instructions pred is true of */
+    template <typename P>
+    void
+    removeIf(P pred)
+    {
+        for (uint32_t entry = 0; entry < entries.size(); entry++) {
+            auto &e = entries[entry];
+            if (e.inst && pred(e.inst)) {
+                rows[e.reg * words + entry / 64] &= ~bit(entry);
+                release(entry);
+            }
+        }
+    }
+
+  private:
+    struct Entry
+    {
+        DynInstPtr inst;
+        RegIndex reg;
+        int srcIdx;
+    };
+
+    static uint64_t bit(uint32_t entry) { return 1ULL << (entry % 64); }
+
+    void
+    release(uint32_t entry)
+    {
+        entries[entry].inst = nullptr;
+        freeEntries.push_back(entry);
+    }
+
+    /** 64 more entries, a word more per row */
+    void
+    grow()
+    {
+        size_t new_words = words + 1;
+        std::vector<uint64_t> new_rows(numRegs * new_words, 0);
+        for (size_t reg = 0; reg < numRegs; reg++) {
+            for (size_t w = 0; w < words; w++) {
+                new_rows[reg * new_words + w] = rows[reg * words + w];
+            }
+        }
+        rows.swap(new_rows);
+        words = new_words;
+
+        size_t first = entries.size();
+        entries.resize(words * 64);
+        for (size_t entry = entries.size(); entry-- > first;) {
+            freeEntries.push_back(entry);
+        }
+    }
+
+    size_t numRegs{0};
+    /** Words per row */
+    size_t words{0};
+    /** Row by register, the entries waiting on it */
+    std::vector<uint64_t> rows;
+    std::vector<Entry> entries;
+    std::vector<uint32_t> freeEntries;
+};
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_DEP_MATRIX_HH__
@@ -45,6 +45,7 @@
 #include <cstring>
 
 #include "base/intmath.hh"
+#include "cpu/o3/dyn_inst_pool.hh"
 #include "debug/DynInst.hh"
 #include "debug/IQ.hh"
 #include "debug/O3PipeView.hh"
@@ -171,8 +172,9 @@ DynInst::operator new(size_t count, Arrays &arrays)
     // Figure out how much space we need in total.
     size_t total_size = ready_src_idx + ready_src_idx_size;
 
-    // Actually allocate it.
-    uint8_t *buf = (uint8_t *)::operator new(total_size);
+    // Actually allocate it, recycling the storage of a freed instruction of
+    // about the same size.
+    uint8_t *buf = (uint8_t *)dyn_inst_pool::allocate(total_size);
 
     // Fill in "arrays" with pointers to all the arrays.
     arrays.flatDestIdx = (RegId *)(buf + flat_dest_idx);
@@ -191,13 +193,12 @@ DynInst::operator new(size_t count, Arrays &arrays)
     return buf;
 }
 
-// Because of the custom "new" operator that allocates more bytes than the
-// size of the DynInst object, AddressSanitizer throw new-delete-type-mismatch.
-// Adding a custom delete function is enough to shut down this false positive
+// The storage goes back to the pool, which also keeps AddressSanitizer from
+// seeing a new-delete-type-mismatch for the bytes allocated past the DynInst.
 void
 DynInst::operator delete(void *ptr)
 {
-    ::operator delete(ptr);
+    dyn_inst_pool::release(ptr);
 }
 
 DynInst::~DynInst()
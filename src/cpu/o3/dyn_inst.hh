@@ -60,6 +60,7 @@
 #include "cpu/o3/cpu.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
 #include "cpu/o3/dyn_inst_xsmeta.hh"
+#include "cpu/o3/inst_ring.hh"
 #include "cpu/o3/lsq_unit.hh"
 #include "cpu/op_class.hh"
 #include "cpu/reg_class.hh"
@@ -89,7 +90,7 @@ class DynInst : public ExecContext, public RefCounted
 
   public:
     // The list of instructions iterator type.
-    typedef typename std::list<DynInstPtr>::iterator ListIt;
+    typedef InstList::iterator ListIt;
 
     struct Arrays
     {
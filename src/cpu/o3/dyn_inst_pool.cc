@@ -0,0 +1,104 @@
+#include "cpu/o3/dyn_inst_pool.hh"
+
+#include <cstdint>
+#include <cstring>
+#include <new>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+namespace dyn_inst_pool
+{
+
+namespace
+{
+
+/** Ahead of every block, where the free lists link it */
+struct alignas(alignof(std::max_align_t)) Header
+{
+    Header *next;
+    /** 0 for blocks too large to recycle */
+    size_t sizeClass;
+};
+
+constexpr size_t granule = 64;
+constexpr size_t numClasses = 64;
+
+#ifdef DEBUG
+constexpr uint8_t poison = 0xdb;
+#endif
+
+// Trivially destructible, so that blocks freed at exit, after the thread is
+// gone, are never put on a destroyed list. What is on the lists then is left
+// to the OS.
+thread_local Header *freeLists[numClasses];
+
+size_t
+blockSize(size_t size_class)
+{
+    return size_class * granule;
+}
+
+} // anonymous namespace
+
+void *
+allocate(size_t size)
+{
+    size_t size_class = divCeil(sizeof(Header) + size, granule);
+    if (size_class >= numClasses) {
+        auto *header = static_cast<Header *>(
+            ::operator new(sizeof(Header) + size));
+        header->sizeClass = 0;
+        return header + 1;
+    }
+
+    Header *header = freeLists[size_class];
+    if (header) {
+        freeLists[size_class] = header->next;
+#ifdef DEBUG
+        auto *payload = reinterpret_cast<uint8_t *>(header + 1);
+        size_t payload_size = blockSize(size_class) - sizeof(Header);
+        for (size_t i = 0; i < payload_size; i++) {
+            panic_if(payload[i] != poison,
+                     "Freed instruction storage %p written at byte %lu\n",
+                     (void *)payload, i);
+        }
+#endif
+    } else {
+        header = static_cast<Header *>(
+            ::operator new(blockSize(size_class)));
+        header->sizeClass = size_class;
+    }
+    return header + 1;
+}
+
+void
+release(void *ptr)
+{
+    if (!ptr) {
+        return;
+    }
+    Header *header = static_cast<Header *>(ptr) - 1;
+    size_t size_class = header->sizeClass;
+    if (size_class == 0) {
+        ::operator delete(header);
+        return;
+    }
+
+#ifdef DEBUG
+    std::memset(ptr, poison, blockSize(size_class) - sizeof(Header));
+#endif
+    header->next = freeLists[size_class];
+    freeLists[size_class] = header;
+}
+
+} // namespace dyn_inst_pool
+
+} // namespace o3
+} // namespace gem5
@@ -0,0 +1,42 @@
+#ifndef __CPU_O3_DYN_INST_POOL_HH__
+#define __CPU_O3_DYN_INST_POOL_HH__
+
+#include <cstddef>
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * Recycles the storage of dynamic instructions and of their metadata, which
+ * are allocated and freed by the million, wrong path ones included.
+ *
+ * Blocks are rounded up to size classes of a few cache lines, a freed block
+ * goes on the free list of its class and the next allocation of that class
+ * takes it back, so the heap is only used until the pipeline has been as
+ * full as it gets. The lists are per simulation thread: a CPU allocates on
+ * the thread of its event queue without locking, and a block released by
+ * another thread, as a memory request holding metadata may be, just moves
+ * to the lists of that thread.
+ *
+ * Debug builds fill a freed block with a poison pattern, and check that it
+ * is still there when the block is reused, to catch instructions used after
+ * they were squashed and freed.
+ */
+namespace dyn_inst_pool
+{
+
+/** Storage of size bytes, aligned as the heap would */
+void *allocate(size_t size);
+
+/** Give back storage of allocate() */
+void release(void *ptr);
+
+} // namespace dyn_inst_pool
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_DYN_INST_POOL_HH__
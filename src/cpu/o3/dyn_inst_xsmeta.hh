@@ -50,6 +50,7 @@
 
 #include "base/refcnt.hh"
 #include "base/types.hh"
+#include "cpu/o3/dyn_inst_pool.hh"
 
 namespace gem5
 {
@@ -65,6 +66,19 @@ public:
 
 public:
     XsDynInstMeta(): squashed(false),instAddr(0) {}
+
+    /** One per instruction, recycled as instructions are */
+    static void *
+    operator new(size_t size)
+    {
+        return dyn_inst_pool::allocate(size);
+    }
+
+    static void
+    operator delete(void *ptr)
+    {
+        dyn_inst_pool::release(ptr);
+    }
 };
 
 using XsDynInstMetaPtr = RefCountingPtr<XsDynInstMeta>;
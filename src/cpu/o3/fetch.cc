@@ -1367,6 +1367,58 @@ Fetch::tick()
     }
 }
 
+bool
+Fetch::canSkipCycles()
+{
+    if (numThreads != 1 || isStreamPred()) {
+        return false;
+    }
+
+    const ThreadID tid = 0;
+    const auto &commit_info = fromCommit->commitInfo[tid];
+    if (fetchStatus[tid] != Running || !stalls[tid].decode ||
+        stalls[tid].drain || fromDecode->decodeUnblock[tid] ||
+        fromDecode->decodeInfo[tid].squash || commit_info.squash ||
+        commit_info.doneSeqNum || commit_info.interruptPending ||
+        commit_info.clearInterrupt || interruptPending ||
+        issuePipelinedIfetch[tid] ||
+        fetchQueue[tid].size() < fetchQueueSize) {
+        return false;
+    }
+
+    // Otherwise fetch() goes to the I-cache
+    const PCStateBase &this_pc = *pc[tid];
+    Addr fetch_addr = (this_pc.instAddr() + fetchOffset[tid]) &
+        decoder[tid]->pcMask();
+    bool buffered = fetchBufferValid[tid] &&
+        fetchBufferPC[tid] <= fetch_addr &&
+        fetchBufferPC[tid] + fetchBufferSize > fetch_addr;
+    if (!buffered && !isRomMicroPC(this_pc.microPC()) && !macroop[tid] &&
+        !currentFetchTargetInLoop) {
+        return false;
+    }
+
+    return !isFTBPred() || dbpftb->canSkipCycles();
+}
+
+void
+Fetch::skipCycles(Cycles cycles)
+{
+    fetchStats.fetchStatusDist[Running] += cycles;
+    fetchStats.cycles += cycles;
+    fetchStats.nisnDist.sample(0, cycles);
+    fetchStats.decodeStalls += cycles;
+
+    // Leave the random stream where the skipped ticks would have
+    for (uint64_t i = 0; i < cycles; i++) {
+        random_mt.random<uint8_t>(0, activeThreads->size() - 1);
+    }
+
+    if (isFTBPred()) {
+        dbpftb->skipCycles(cycles);
+    }
+}
+
 bool
 Fetch::checkSignalsAndUpdate(ThreadID tid)
 {
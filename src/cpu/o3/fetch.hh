@@ -343,6 +343,15 @@ class Fetch
      */
     void tick();
 
+    /**
+     * Whether the next ticks would only count a cycle stalled on decode,
+     * with a full fetch queue and the next instructions in the fetch buffer.
+     */
+    bool canSkipCycles();
+
+    /** Count cycles skipped while canSkipCycles() held as stalled. */
+    void skipCycles(Cycles cycles);
+
     /** Checks all input signals and updates the status as necessary.
      *  @return: Returns if the status has changed due to input signals.
      */
@@ -1768,6 +1768,116 @@ IEW::tick()
     }
 }
 
+namespace
+{
+
+/**
+ * A load the caches missed on goes on down the hierarchy, raising the depth
+ * the stall is counted at, with nothing to wake the CPU.
+ */
+bool
+stallSettled(StallReason reason)
+{
+    return reason != StallReason::DTlbStall &&
+           reason != StallReason::LoadL1Bound &&
+           reason != StallReason::LoadL2Bound &&
+           reason != StallReason::LoadL3Bound;
+}
+
+template <typename Reasons>
+bool
+stallsSettled(const Reasons &reasons)
+{
+    for (auto reason : reasons) {
+        if (!stallSettled(reason)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+} // anonymous namespace
+
+bool
+IEW::canSkipCycles()
+{
+    const ThreadID tid = 0;
+    const auto &commit_info = fromCommit->commitInfo[tid];
+
+    if ((dispatchStatus[tid] != Running && dispatchStatus[tid] != Idle) ||
+        exeStatus != Idle || updateLSQNextCycle ||
+        !insts[tid].empty() || !skidBuffer[tid].empty() ||
+        fromRename->size || fromIssue->size || execWB->insts[0] ||
+        commit_info.squash || commit_info.robSquashing ||
+        commit_info.doneSeqNum || commit_info.nonSpecSeqNum) {
+        return false;
+    }
+
+    // Every dispatch queue has to be held up as dispatchInstFromDispQue()
+    // would find it
+    skipIQFullEvents = 0;
+    skipLSQFullEvents = 0;
+    for (int i = 0; i < NumDQ; i++) {
+        if (dispQue[i].empty()) {
+            continue;
+        }
+        const DynInstPtr &inst = dispQue[i].front();
+        if (inst->isSquashed()) {
+            return false;
+        }
+        if (!instQueue.isReady(inst)) {
+            skipIQFullEvents++;
+        } else if ((inst->isAtomic() && ldstQueue.sqFull(tid)) ||
+                   (inst->isLoad() && ldstQueue.lqFull(tid)) ||
+                   (inst->isStore() && ldstQueue.sqFull(tid))) {
+            skipLSQFullEvents++;
+        } else {
+            return false;
+        }
+    }
+
+    const StallReason head_reasons[] = {
+        checkDispatchStall(tid, NumDQ, nullptr),
+        ldstQueue.lqEmpty() ? StallReason::NoStall : checkLSQStall(tid, true),
+        ldstQueue.sqEmpty() ? StallReason::NoStall : checkLSQStall(tid, false)
+    };
+    if (!stallsSettled(head_reasons) ||
+        !stallsSettled(fromRename->fetchStallReason) ||
+        !stallsSettled(fromRename->decodeStallReason) ||
+        !stallsSettled(fromRename->renameStallReason) ||
+        !stallsSettled(dispatchStalls)) {
+        return false;
+    }
+
+    return instQueue.canSkipCycles() && ldstQueue.canSkipCycles();
+}
+
+void
+IEW::skipCycles(Cycles cycles)
+{
+    for (auto reason : fromRename->fetchStallReason) {
+        iewStats.fetchStallReason[reason] += cycles;
+    }
+    for (auto reason : fromRename->decodeStallReason) {
+        iewStats.decodeStallReason[reason] += cycles;
+    }
+    for (auto reason : fromRename->renameStallReason) {
+        iewStats.renameStallReason[reason] += cycles;
+    }
+    for (auto reason : dispatchStalls) {
+        iewStats.dispatchStallReason[reason] += cycles;
+    }
+
+    iewStats.stallEvents[IQFull] += skipIQFullEvents * cycles;
+    iewStats.iqFullEvents += skipIQFullEvents * cycles;
+    iewStats.stallEvents[LSQFull] += skipLSQFullEvents * cycles;
+    iewStats.lsqFullEvents += skipLSQFullEvents * cycles;
+    iewStats.dispDist.sample(0, cycles);
+
+    instQueue.iqIOStats.intInstQueueReads += cycles;
+    instQueue.skipCycles(cycles);
+}
+
 void
 IEW::updateExeInstStats(const DynInstPtr& inst)
 {
@@ -345,6 +345,15 @@ class IEW
      */
     void tick();
 
+    /**
+     * Whether every cycle until a memory response comes back would tick as
+     * this one did, IEW only waiting on loads that left the caches.
+     */
+    bool canSkipCycles();
+
+    /** Counts cycles of the stall seen by canSkipCycles() as if ticked. */
+    void skipCycles(Cycles cycles);
+
   private:
     /** Updates execution stats based on the instruction. */
     void updateExeInstStats(const DynInstPtr &inst);
@@ -561,6 +570,10 @@ class IEW
 
     std::vector<StallReason> dispatchStalls;
 
+    /** Dispatch queues found full by canSkipCycles(), per skipped cycle. */
+    unsigned skipIQFullEvents = 0;
+    unsigned skipLSQFullEvents = 0;
+
     StallReason blockReason{NoStall};
 
     ROB* rob;
@@ -745,6 +745,30 @@ InstructionQueue::notifyExecuted(const DynInstPtr &inst)
     memDepUnit[inst->threadNumber].issue(inst);
 }
 
+bool
+InstructionQueue::canSkipCycles()
+{
+    if (!instsToExecute.empty() || !deferredMemInsts.empty() ||
+        !blockedMemInsts.empty() || !retryMemInsts.empty()) {
+        return false;
+    }
+
+    for (auto &inst : cacheMissLdInsts) {
+        if (!inst->waitingCacheRefill() || inst->isSquashed()) {
+            return false;
+        }
+    }
+
+    return scheduler->canSkipCycles();
+}
+
+void
+InstructionQueue::skipCycles(Cycles cycles)
+{
+    iqStats.numIssuedDist.sample(0, cycles);
+    scheduler->skipCycles(cycles);
+}
+
 void
 InstructionQueue::scheduleNonSpec(const InstSeqNum &inst)
 {
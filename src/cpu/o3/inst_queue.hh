@@ -221,6 +221,15 @@ class InstructionQueue
      */
     void scheduleReadyInsts();
 
+    /**
+     * Returns if nothing would be scheduled or retried until a cache missed
+     * load is woken up by the cache.
+     */
+    bool canSkipCycles();
+
+    /** Counts skipped cycles as ones that scheduled nothing. */
+    void skipCycles(Cycles cycles);
+
     /** Schedules a single specific non-speculative instruction. */
     void scheduleNonSpec(const InstSeqNum &inst);
 
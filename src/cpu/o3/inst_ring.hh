@@ -0,0 +1,216 @@
+#ifndef __CPU_O3_INST_RING_HH__
+#define __CPU_O3_INST_RING_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "cpu/o3/dyn_inst_ptr.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * A list of in flight instructions, in program order, kept in a ring of
+ * slots instead of list nodes, so that appending never allocates and a walk
+ * reads consecutive memory.
+ *
+ * Entries are appended at the back and may be erased anywhere. An erased
+ * slot is left empty (a null T) and skipped by iterators until the front or
+ * back gets to it, so iterators are positions that stay valid until their
+ * own entry is erased, as list iterators do, and that instructions can keep.
+ * Only erasing in the middle leaves such holes: the ROB commits from the
+ * front and squashes from the back, so the walks never meet one there, and
+ * callers never see a null entry as the iterators do the skipping.
+ *
+ * end() is a position of its own rather than the slot after the last entry,
+ * so an end() kept in the ROB state (an idle squash iterator, say) stays
+ * end() when entries are appended after it, as it does for a list.
+ *
+ * The ring doubles if the span from the first to the last entry outgrows
+ * it, which sizing it for the ROB makes rare.
+ */
+template <typename T>
+class InstRing
+{
+  public:
+    using value_type = T;
+
+    template <bool Const>
+    class Iter
+    {
+        using Ring = std::conditional_t<Const, const InstRing, InstRing>;
+        using Value = std::conditional_t<Const, const T, T>;
+
+        Ring *ring;
+        uint64_t pos;
+
+        friend class InstRing;
+        template <bool> friend class Iter;
+
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *;
+        using reference = Value &;
+
+        Iter() : ring(nullptr), pos(0) {}
+        Iter(Ring *ring, uint64_t pos) : ring(ring), pos(pos) {}
+
+        /** Iterators convert to const iterators */
+        template <bool C, typename = std::enable_if_t<Const && !C>>
+        Iter(const Iter<C> &other) : ring(other.ring), pos(other.pos) {}
+
+        reference operator*() const { return ring->slot(pos); }
+        pointer operator->() const { return &ring->slot(pos); }
+
+        Iter &
+        operator++()
+        {
+            do {
+                ++pos;
+            } while (ring->inRange(pos) && !ring->slot(pos));
+            if (!ring->inRange(pos)) {
+                pos = EndPos;
+            }
+            return *this;
+        }
+
+        Iter &
+        operator--()
+        {
+            if (pos == EndPos) {
+                pos = ring->tailPos;
+            }
+            do {
+                --pos;
+            } while (ring->inRange(pos) && !ring->slot(pos));
+            return *this;
+        }
+
+        Iter operator++(int) { Iter it = *this; ++*this; return it; }
+        Iter operator--(int) { Iter it = *this; --*this; return it; }
+
+        bool
+        operator==(const Iter &other) const
+        {
+            return ring == other.ring && pos == other.pos;
+        }
+
+        bool operator!=(const Iter &other) const { return !(*this == other); }
+    };
+
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    explicit InstRing(size_t capacity = 0) { reserve(capacity); }
+
+    /** Make room for a span of capacity entries, rounded to a power of 2 */
+    void
+    reserve(size_t capacity)
+    {
+        if (capacity <= slots.size()) {
+            return;
+        }
+        std::vector<T> grown((size_t)1 << ceilLog2(capacity));
+        for (uint64_t pos = headPos; pos != tailPos; pos++) {
+            grown[pos & (grown.size() - 1)] = std::move(slot(pos));
+        }
+        slots.swap(grown);
+        mask = slots.size() - 1;
+    }
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    iterator begin() { return iterator(this, empty() ? EndPos : headPos); }
+    iterator end() { return iterator(this, EndPos); }
+    const_iterator
+    begin() const
+    {
+        return const_iterator(this, empty() ? EndPos : headPos);
+    }
+    const_iterator end() const { return const_iterator(this, EndPos); }
+
+    // The first and last slots are never empty
+    T &front() { assert(!empty()); return slot(headPos); }
+    T &back() { assert(!empty()); return slot(tailPos - 1); }
+    const T &front() const { assert(!empty()); return slot(headPos); }
+    const T &back() const { assert(!empty()); return slot(tailPos - 1); }
+
+    /** Append entry, which cannot be null, returning where it is */
+    iterator
+    push_back(const T &entry)
+    {
+        assert(entry);
+        if (tailPos - headPos == slots.size()) {
+            reserve(slots.empty() ? 1 : slots.size() * 2);
+        }
+        slot(tailPos) = entry;
+        count++;
+        return iterator(this, tailPos++);
+    }
+
+    void
+    erase(iterator it)
+    {
+        assert(it.ring == this && inRange(it.pos) && slot(it.pos));
+        slot(it.pos) = T();
+        count--;
+        while (headPos != tailPos && !slot(headPos)) {
+            headPos++;
+        }
+        while (tailPos != headPos && !slot(tailPos - 1)) {
+            tailPos--;
+        }
+    }
+
+    void pop_front() { erase(begin()); }
+
+    void
+    clear()
+    {
+        for (uint64_t pos = headPos; pos != tailPos; pos++) {
+            slot(pos) = T();
+        }
+        headPos = tailPos;
+        count = 0;
+    }
+
+  private:
+    /** The position of end(), which no entry ever gets to */
+    static constexpr uint64_t EndPos = ~(uint64_t)0;
+
+    bool
+    inRange(uint64_t pos) const
+    {
+        return pos - headPos < tailPos - headPos;
+    }
+
+    T &slot(uint64_t pos) { return slots[pos & mask]; }
+    const T &slot(uint64_t pos) const { return slots[pos & mask]; }
+
+    std::vector<T> slots;
+    uint64_t mask{0};
+    /** Positions of the first entry and past the last one */
+    uint64_t headPos{0};
+    uint64_t tailPos{0};
+    /** Entries not erased */
+    size_t count{0};
+};
+
+/** The instructions in flight in the CPU or in a thread of the ROB */
+using InstList = InstRing<DynInstPtr>;
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_INST_RING_HH__
@@ -0,0 +1,241 @@
+/*
+ * Copyright (c) 2026 Institute of Computing Technology, Chinese Academy of Sciences
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "cpu/o3/inst_ring.hh"
+
+using namespace gem5::o3;
+
+namespace
+{
+
+/** Entries are pointers into a fixed pool, null being an empty slot */
+class InstRingTest : public testing::Test
+{
+  protected:
+    int pool[64];
+
+    InstRingTest()
+    {
+        for (int i = 0; i < 64; i++)
+            pool[i] = i;
+    }
+
+    std::vector<int>
+    walk(const InstRing<int *> &ring)
+    {
+        std::vector<int> vals;
+        for (auto it = ring.begin(); it != ring.end(); ++it)
+            vals.push_back(**it);
+        return vals;
+    }
+};
+
+} // anonymous namespace
+
+TEST_F(InstRingTest, PushBack)
+{
+    InstRing<int *> ring(4);
+    ASSERT_TRUE(ring.empty());
+    for (int i = 0; i < 4; i++)
+        ring.push_back(&pool[i]);
+    ASSERT_EQ(ring.size(), 4);
+    ASSERT_EQ(*ring.front(), 0);
+    ASSERT_EQ(*ring.back(), 3);
+    ASSERT_EQ(walk(ring), std::vector<int>({0, 1, 2, 3}));
+}
+
+/** Erasing in the middle leaves holes the walk skips */
+TEST_F(InstRingTest, EraseOutOfOrder)
+{
+    InstRing<int *> ring(8);
+    std::vector<InstRing<int *>::iterator> its;
+    for (int i = 0; i < 6; i++)
+        its.push_back(ring.push_back(&pool[i]));
+
+    ring.erase(its[3]);
+    ring.erase(its[1]);
+    ASSERT_EQ(ring.size(), 4);
+    ASSERT_EQ(walk(ring), std::vector<int>({0, 2, 4, 5}));
+
+    // the iterators of the other entries are still valid
+    ASSERT_EQ(**its[2], 2);
+    ASSERT_EQ(**its[4], 4);
+
+    // erasing the front moves the head past the hole behind it
+    ring.erase(its[0]);
+    ASSERT_EQ(ring.begin(), its[2]);
+    ASSERT_EQ(*ring.front(), 2);
+    ASSERT_EQ(walk(ring), std::vector<int>({2, 4, 5}));
+
+    ring.erase(its[4]);
+    ring.erase(its[2]);
+    ASSERT_EQ(ring.size(), 1);
+    ASSERT_EQ(ring.begin(), its[5]);
+    ring.erase(its[5]);
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.begin(), ring.end());
+}
+
+/** ++ and -- step over runs of erased slots */
+TEST_F(InstRingTest, StepOverHoles)
+{
+    InstRing<int *> ring(8);
+    std::vector<InstRing<int *>::iterator> its;
+    for (int i = 0; i < 7; i++)
+        its.push_back(ring.push_back(&pool[i]));
+    ring.erase(its[1]);
+    ring.erase(its[2]);
+    ring.erase(its[4]);
+
+    auto it = its[0];
+    ASSERT_EQ(**++it, 3);
+    ASSERT_EQ(**++it, 5);
+    ASSERT_EQ(**it++, 5);
+    ASSERT_EQ(**it, 6);
+    ASSERT_EQ(++it, ring.end());
+
+    ASSERT_EQ(**--it, 6);
+    ASSERT_EQ(**--it, 5);
+    ASSERT_EQ(**--it, 3);
+    ASSERT_EQ(**it--, 3);
+    ASSERT_EQ(it, ring.begin());
+    ASSERT_EQ(**it, 0);
+}
+
+/** Erasing the back pulls the last entry in over the holes before it */
+TEST_F(InstRingTest, EndAfterTailErase)
+{
+    InstRing<int *> ring(8);
+    std::vector<InstRing<int *>::iterator> its;
+    for (int i = 0; i < 5; i++)
+        its.push_back(ring.push_back(&pool[i]));
+    ring.erase(its[3]);
+
+    auto old_end = ring.end();
+    ring.erase(its[4]);
+    ASSERT_EQ(ring.end(), old_end);
+    ASSERT_EQ(*ring.back(), 2);
+
+    // stepping off the new last entry reaches end(), and back again
+    auto it = its[2];
+    ASSERT_EQ(++it, ring.end());
+    ASSERT_EQ(**--it, 2);
+    ASSERT_EQ(walk(ring), std::vector<int>({0, 1, 2}));
+
+    // the next entry goes right after the last one
+    auto pushed = ring.push_back(&pool[10]);
+    ASSERT_EQ(++its[2], pushed);
+    ASSERT_EQ(walk(ring), std::vector<int>({0, 1, 2, 10}));
+}
+
+/** A kept end() is still end() after entries are appended */
+TEST_F(InstRingTest, EndIsStable)
+{
+    InstRing<int *> ring(4);
+    auto kept = ring.end();
+    ring.push_back(&pool[0]);
+    ASSERT_EQ(kept, ring.end());
+    ASSERT_NE(ring.begin(), kept);
+
+    kept = ring.end();
+    auto last = std::prev(kept);
+    ASSERT_EQ(**last, 0);
+    for (int i = 1; i < 6; i++)
+        ring.push_back(&pool[i]);
+    ASSERT_EQ(kept, ring.end());
+    ASSERT_EQ(**std::prev(kept), 5);
+
+    ring.clear();
+    ASSERT_EQ(kept, ring.end());
+    ASSERT_EQ(ring.begin(), kept);
+}
+
+/** Entries wrap around the end of the slots */
+TEST_F(InstRingTest, WrapAround)
+{
+    InstRing<int *> ring(4);
+    for (int i = 0; i < 4; i++)
+        ring.push_back(&pool[i]);
+    for (int i = 4; i < 20; i++) {
+        ring.pop_front();
+        ring.push_back(&pool[i]);
+        ASSERT_EQ(*ring.front(), i - 3);
+        ASSERT_EQ(*ring.back(), i);
+    }
+    ASSERT_EQ(walk(ring), std::vector<int>({16, 17, 18, 19}));
+}
+
+/** Growing keeps the order and the iterators of live entries */
+TEST_F(InstRingTest, GrowWithLiveIterators)
+{
+    InstRing<int *> ring(4);
+    std::vector<InstRing<int *>::iterator> its;
+    for (int i = 0; i < 4; i++)
+        its.push_back(ring.push_back(&pool[i]));
+    // wrap the head so the span crosses the end of the slots
+    ring.pop_front();
+    ring.pop_front();
+    for (int i = 4; i < 6; i++)
+        its.push_back(ring.push_back(&pool[i]));
+    ring.erase(its[4]);
+
+    // the span is full with a hole, so this push grows the ring
+    for (int i = 6; i < 12; i++)
+        its.push_back(ring.push_back(&pool[i]));
+
+    ASSERT_EQ(walk(ring), std::vector<int>({2, 3, 5, 6, 7, 8, 9, 10, 11}));
+    for (int i : {2, 3, 5, 6, 11})
+        ASSERT_EQ(**its[i], i);
+
+    auto it = its[3];
+    ASSERT_EQ(**++it, 5);
+    ASSERT_EQ(**--it, 3);
+    ASSERT_EQ(ring.begin(), its[2]);
+    ASSERT_EQ(std::next(its[11]), ring.end());
+
+    ring.erase(its[8]);
+    ASSERT_EQ(**++its[7], 9);
+}
+
+TEST_F(InstRingTest, Clear)
+{
+    InstRing<int *> ring(4);
+    for (int i = 0; i < 3; i++)
+        ring.push_back(&pool[i]);
+    ring.clear();
+    ASSERT_TRUE(ring.empty());
+    ASSERT_EQ(ring.begin(), ring.end());
+
+    ring.push_back(&pool[7]);
+    ASSERT_EQ(walk(ring), std::vector<int>({7}));
+}
@@ -1,5 +1,6 @@
 #include "cpu/o3/issue_queue.hh"
 
+#include <algorithm>
 #include <cassert>
 #include <cstdint>
 #include <cstdlib>
@@ -10,6 +11,7 @@
 #include <vector>
 
 #include "arch/riscv/insts/vector.hh"
+#include "base/intmath.hh"
 #include "base/logging.hh"
 #include "base/stats/group.hh"
 #include "base/stats/info.hh"
@@ -66,12 +68,6 @@ IssuePort::IssuePort(const IssuePortParams& params) : SimObject(params), rp(para
     }
 }
 
-bool
-IssueQue::select_policy::operator()(const DynInstPtr& a, const DynInstPtr& b) const
-{
-    return a->seqNum > b->seqNum;
-}
-
 void
 IssueQue::IssueStream::push(const DynInstPtr& inst)
 {
@@ -156,14 +152,14 @@ IssueQue::IssueQue(const IssueQueParams& params)
     if (same_fu) {
         // we only allocate one ReadyQue
         warn("%s: Use one selector by multiple identical fus\n", iqname);
-        auto t = new ReadyQue;
+        auto t = new ReadyQue(iqsize);
         readyQs.resize(outports, t);
         auto& port = params.oports[0];
         fuDescs.insert(fuDescs.begin(), port->fu.begin(), port->fu.end());
     } else {
         readyQs.resize(outports, nullptr);
         for (int i = 0; i < outports; i++) {
-            readyQs[i] = new ReadyQue;
+            readyQs[i] = new ReadyQue(iqsize);
             auto& port = params.oports[i];
             fuDescs.insert(fuDescs.begin(), port->fu.begin(), port->fu.end());
         }
@@ -200,7 +196,7 @@ IssueQue::setCPU(CPU* cpu)
 void
 IssueQue::resetDepGraph(int numPhysRegs)
 {
-    subDepGraph.resize(numPhysRegs);
+    depMatrix.resize(numPhysRegs);
 }
 
 bool
@@ -311,11 +307,9 @@ IssueQue::wakeUpDependents(const DynInstPtr& inst, bool speculative)
         scheduler->regCache.insert(dst->flatIndex(), {});
         DPRINTF(Schedule, "was %s woken by p%lu [sn:%llu]\n", speculative ? "spec" : "wb", dst->flatIndex(),
                 inst->seqNum);
-        for (auto& it : subDepGraph[dst->flatIndex()]) {
-            int srcIdx = it.first;
-            auto& consumer = it.second;
+        depMatrix.forEachWaiting(dst->flatIndex(), [&](const DynInstPtr& consumer, int srcIdx) {
             if (consumer->readySrcIdx(srcIdx)) {
-                continue;
+                return;
             }
             consumer->markSrcRegReady(srcIdx);
 
@@ -325,10 +319,10 @@ IssueQue::wakeUpDependents(const DynInstPtr& inst, bool speculative)
 
             DPRINTF(Schedule, "[sn:%llu] src%d was woken\n", consumer->seqNum, srcIdx);
             addIfReady(consumer);
-        }
+        });
 
         if (!speculative) {
-            subDepGraph[dst->flatIndex()].clear();
+            depMatrix.clear(dst->flatIndex());
         }
     }
 }
@@ -474,6 +468,28 @@ IssueQue::tick()
     }
 }
 
+bool
+IssueQue::canSkipCycles() const
+{
+    for (int i = 0; i <= scheduleToExecDelay; i++) {
+        if (inflightIssues[-i].size) {
+            return false;
+        }
+    }
+    for (auto readyQ : readyQs) {
+        if (!readyQ->empty()) {
+            return false;
+        }
+    }
+    for (auto busy : portBusy) {
+        if (busy) {
+            return false;
+        }
+    }
+    return skidBuffer.empty() && selectQ.empty() && replayQ.empty() &&
+           instNumInsert == 0;
+}
+
 bool
 IssueQue::ready()
 {
@@ -521,7 +537,7 @@ IssueQue::insert(const DynInstPtr& inst)
                     inst->markSrcRegReady(i);
                 }
                 DPRINTF(Schedule, "[sn:%llu] src p%d add to depGraph\n", inst->seqNum, src->flatIndex());
-                subDepGraph[src->flatIndex()].push_back({i, inst});
+                depMatrix.add(src->flatIndex(), inst, i);
                 addToDepGraph = true;
             }
         }
@@ -595,35 +611,7 @@ IssueQue::doSquash(const InstSeqNum seqNum)
     }
 
     // clear in depGraph
-    for (auto& entrys : subDepGraph) {
-        for (auto it = entrys.begin(); it != entrys.end();) {
-            if ((*it).second->isSquashed()) {
-                it = entrys.erase(it);
-            } else {
-                it++;
-            }
-        }
-    }
-}
-
-Scheduler::SpecWakeupCompletion::SpecWakeupCompletion(const DynInstPtr& inst,
-    IssueQue* to, PendingWakeEventsType* owner)
-    : Event(Stat_Event_Pri, AutoDelete),
-      inst(inst), owner(owner), to_issue_queue(to)
-{
-}
-
-void
-Scheduler::SpecWakeupCompletion::process()
-{
-    to_issue_queue->wakeUpDependents(inst, true);
-    (*owner)[inst->seqNum].erase(this);
-}
-
-const char*
-Scheduler::SpecWakeupCompletion::description() const
-{
-    return "Spec wakeup completion";
+    depMatrix.removeIf([](const DynInstPtr& inst) { return inst->isSquashed(); });
 }
 
 Scheduler::SchedulerStats::SchedulerStats(statistics::Group* parent)
@@ -651,7 +639,9 @@ Scheduler::disp_policy::operator()(IssueQue* a, IssueQue* b) const
     return p0 < p1;
 }
 
-Scheduler::Scheduler(const SchedulerParams& params) : SimObject(params), stats(this), issueQues(params.IQs)
+Scheduler::Scheduler(const SchedulerParams& params)
+    : SimObject(params), stats(this), issueQues(params.IQs),
+      specWakeEvent([this] { serviceSpecWakeups(); }, name() + ".specWakeEvent", false, Event::Stat_Event_Pri)
 {
     dispTable.resize(enums::OpClass::Num_OpClass);
     opExecTimeTable.resize(enums::OpClass::Num_OpClass, 1);
@@ -768,6 +758,84 @@ Scheduler::addToFU(const DynInstPtr& inst)
     instsToFu.push_back(inst);
 }
 
+void
+Scheduler::addSpecWakeup(const DynInstPtr& inst, IssueQue* to, int delay)
+{
+    if (delay >= (int)specWakeWheel.size()) {
+        // every pending wakeup is due within the size of the wheel
+        std::vector<std::vector<SpecWakeup>> wheel(1 << ceilLog2(delay + 1));
+        for (auto& slot : specWakeWheel) {
+            for (auto& wakeup : slot) {
+                wheel[wakeup.due & (wheel.size() - 1)].push_back(std::move(wakeup));
+            }
+        }
+        specWakeWheel.swap(wheel);
+    }
+    Cycles due = cpu->curCycle() + Cycles(delay);
+    specWakeWheel[due & (specWakeWheel.size() - 1)].push_back({inst, to, due});
+    numSpecWakeups++;
+    // same point as the event per wakeup had: one tick before the clock
+    // edge of the cycle it is due, ahead of everything in that cycle
+    Tick when = cpu->clockEdge(Cycles(delay)) - 1;
+    if (!specWakeEvent.scheduled()) {
+        cpu->schedule(specWakeEvent, when);
+    } else if (when < specWakeEvent.when()) {
+        cpu->reschedule(specWakeEvent, when);
+    }
+}
+
+void
+Scheduler::serviceSpecWakeups()
+{
+    // rounds up to the cycle whose edge is the next tick
+    Cycles now = cpu->curCycle();
+    std::vector<SpecWakeup> slot;
+    slot.swap(specWakeWheel[now & (specWakeWheel.size() - 1)]);
+    numSpecWakeups -= slot.size();
+    for (auto& wakeup : slot) {
+        assert(wakeup.due == now);
+        if (!wakeup.inst->isSquashed()) {
+            wakeup.to->wakeUpDependents(wakeup.inst, true);
+            continue;
+        }
+        if (wakeup.inst->canceled()) {
+            continue;
+        }
+        // a squashed producer has no dependents left to wake, but the
+        // register cache still sees its write as it did before the squash
+        for (int i = 0; i < wakeup.inst->numDestRegs(); i++) {
+            PhysRegIdPtr dst = wakeup.inst->renamedDestIdx(i);
+            if (!dst->isFixedMapping() && dst->getNumPinnedWritesToComplete() == 1) {
+                regCache.insert(dst->flatIndex(), {});
+            }
+        }
+    }
+    scheduleSpecWakeups(now);
+}
+
+void
+Scheduler::scheduleSpecWakeups(Cycles now)
+{
+    for (Cycles next = now + Cycles(1); numSpecWakeups; ++next) {
+        if (!specWakeWheel[next & (specWakeWheel.size() - 1)].empty()) {
+            cpu->schedule(specWakeEvent, cpu->clockEdge(next - now) - 1);
+            return;
+        }
+    }
+}
+
+template <typename P>
+void
+Scheduler::dropSpecWakeups(P pred)
+{
+    for (auto& slot : specWakeWheel) {
+        auto it = std::remove_if(slot.begin(), slot.end(),
+                                 [&](const SpecWakeup& wakeup) { return pred(wakeup.inst); });
+        numSpecWakeups -= slot.end() - it;
+        slot.erase(it, slot.end());
+    }
+}
+
 void
 Scheduler::tick()
 {
@@ -789,11 +857,7 @@ Scheduler::issueAndSelect()
         if (lsq->anyStoreNotExecute()) stats.memstall_any_store++;
     }
     if (instsToFu.size() == 0) {
-        int misslevel = lsq->anyInflightLoadsNotComplete();
-        if (misslevel != 0) stats.memstall_any_load++;
-        if ((misslevel & ((1<<1) - 1)) == ((1<<1) - 1)) stats.memstall_l1miss++;
-        if ((misslevel & ((1<<2) - 1)) == ((1<<2) - 1)) stats.memstall_l2miss++;
-        if ((misslevel & ((1<<3) - 1)) == ((1<<3) - 1)) stats.memstall_l3miss++;
+        countLoadStalls(lsq->anyInflightLoadsNotComplete(), 1);
     }
 
     // must wait for all insts was issued
@@ -809,6 +873,44 @@ Scheduler::issueAndSelect()
     std::fill(rfPortOccupancy.begin(), rfPortOccupancy.end(), std::make_pair(nullptr, 0));
 }
 
+void
+Scheduler::countLoadStalls(int misslevel, uint64_t cycles)
+{
+    if (misslevel != 0) stats.memstall_any_load += cycles;
+    if ((misslevel & ((1<<1) - 1)) == ((1<<1) - 1)) stats.memstall_l1miss += cycles;
+    if ((misslevel & ((1<<2) - 1)) == ((1<<2) - 1)) stats.memstall_l2miss += cycles;
+    if ((misslevel & ((1<<3) - 1)) == ((1<<3) - 1)) stats.memstall_l3miss += cycles;
+}
+
+bool
+Scheduler::canSkipCycles()
+{
+    if (numSpecWakeups || !instsToFu.empty() || !arbFailedInsts.empty()) {
+        return false;
+    }
+    for (auto it : issueQues) {
+        if (!it->canSkipCycles()) {
+            return false;
+        }
+    }
+    // a load still in the caches would change the miss level counted
+    if (!lsq->inflightLoadsAtMemory()) {
+        return false;
+    }
+    skipMissLevel = lsq->anyInflightLoadsNotComplete();
+    skipStoreNotExecuted = lsq->anyStoreNotExecute();
+    return true;
+}
+
+void
+Scheduler::skipCycles(Cycles cycles)
+{
+    // nothing goes to the FUs while skipping
+    stats.exec_stall_cycle += cycles;
+    if (skipStoreNotExecuted) stats.memstall_any_store += cycles;
+    countLoadStalls(skipMissLevel, cycles);
+}
+
 bool
 Scheduler::ready(const DynInstPtr& inst)
 {
@@ -945,10 +1047,7 @@ Scheduler::specWakeUpDependents(const DynInstPtr& inst, IssueQue* from_issue_que
                 }
             }
         } else {
-            auto wakeEvent = new SpecWakeupCompletion(inst, to, &specWakeEvents);
-            // track these pending events
-            specWakeEvents[inst->seqNum].insert(wakeEvent);
-            cpu->schedule(wakeEvent, cpu->clockEdge(Cycles(wakeDelay)) - 1);
+            addSpecWakeup(inst, to, wakeDelay);
         }
     }
 }
@@ -1017,12 +1116,8 @@ Scheduler::loadCancel(const DynInstPtr& inst)
     while (!dfs.empty()) {
         auto top = dfs.top();
         dfs.pop();
-        // clear pending wake events scheduled by top
-        auto& pendingEvents = specWakeEvents[top->seqNum];
-        for (auto it = pendingEvents.begin(); it != pendingEvents.end();) {
-            cpu->deschedule(*it);
-        }
-        specWakeEvents.erase(top->seqNum);
+        // clear pending wakeups scheduled by top
+        dropSpecWakeups([&](const DynInstPtr& producer) { return producer == top; });
         for (int i = 0; i < top->numDestRegs(); i++) {
             auto dst = top->renamedDestIdx(i);
             if (dst->isFixedMapping()) {
@@ -1030,9 +1125,7 @@ Scheduler::loadCancel(const DynInstPtr& inst)
             }
             earlyScoreboard[dst->flatIndex()] = false;
             for (auto iq : issueQues) {
-                for (auto& it : iq->subDepGraph[dst->flatIndex()]) {
-                    int srcIdx = it.first;
-                    auto& depInst = it.second;
+                iq->depMatrix.forEachWaiting(dst->flatIndex(), [&](const DynInstPtr& depInst, int srcIdx) {
                     if (depInst->readySrcIdx(srcIdx) && depInst->renamedSrcIdx(srcIdx) != cpu->vecOnesPhysRegId) {
                         DPRINTF(Schedule, "cancel [sn:%llu], clear src p%d ready\n", depInst->seqNum,
                                 depInst->renamedSrcIdx(srcIdx)->flatIndex());
@@ -1040,7 +1133,7 @@ Scheduler::loadCancel(const DynInstPtr& inst)
                         depInst->clearSrcRegReady(srcIdx);
                         dfs.push(depInst);
                     }
-                }
+                });
             }
         }
     }
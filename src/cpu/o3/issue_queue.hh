@@ -4,18 +4,17 @@
 #include <cstdint>
 #include <list>
 #include <string>
-#include <unordered_map>
-#include <unordered_set>
 
 #include <boost/compute/detail/lru_cache.hpp>
 #include <boost/dynamic_bitset/dynamic_bitset.hpp>
-#include <boost/heap/priority_queue.hpp>
 
 #include "base/statistics.hh"
 #include "base/stats/group.hh"
 #include "cpu/inst_seq.hh"
+#include "cpu/o3/dep_matrix.hh"
 #include "cpu/o3/dyn_inst.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/o3/ready_bitmap.hh"
 #include "cpu/reg_class.hh"
 #include "cpu/timebuf.hh"
 #include "params/IssuePort.hh"
@@ -81,11 +80,8 @@ class IssueQue : public SimObject
     std::vector<bool> opPipelined;
     int IQID = -1;
 
-    struct select_policy
-    {
-        bool operator()(const DynInstPtr& a, const DynInstPtr& b) const;
-    };
-    using ReadyQue = boost::heap::priority_queue<DynInstPtr, boost::heap::compare<select_policy>>;
+    // oldest first
+    using ReadyQue = ReadyInsts;
     using SelectQue = std::vector<std::pair<uint32_t, DynInstPtr>>;
 
     struct IssueStream
@@ -117,8 +113,8 @@ class IssueQue : public SimObject
     // s1: schedule readyInsts
     SelectQue selectQ;
 
-    // srcIdx : inst
-    std::vector<std::vector<std::pair<int, DynInstPtr>>> subDepGraph;
+    // preg : [inst, srcIdx] waiting on it
+    DepMatrix depMatrix;
 
     std::queue<DynInstPtr> replayQ;  // only for mem
 
@@ -158,6 +154,8 @@ class IssueQue : public SimObject
     void resetDepGraph(int numPhysRegs);
 
     void tick();
+    /** Nothing in flight, ready or busy that a tick would move on */
+    bool canSkipCycles() const;
     bool full();
     bool ready();
     int emptyEntries() const { return iqsize - instNum; }
@@ -193,19 +191,13 @@ class SpecWakeupChannel : public SimObject
 class Scheduler : public SimObject
 {
     friend class IssueQue;
-    class SpecWakeupCompletion;
-    // structured as <instruction seqNum -> [pending speculate wakeup events]>
-    using PendingWakeEventsType = std::unordered_map<uint64_t, std::unordered_set<SpecWakeupCompletion*>>;
-    class SpecWakeupCompletion : public Event
+
+    /** A speculative wakeup of the dependents of inst in an issue queue */
+    struct SpecWakeup
     {
-      public:
         DynInstPtr inst;
-        PendingWakeEventsType* owner;
-        IssueQue* to_issue_queue = nullptr;
-
-        SpecWakeupCompletion(const DynInstPtr& inst, IssueQue* to, PendingWakeEventsType* owner);
-        void process() override;
-        const char* description() const override;
+        IssueQue* to;
+        Cycles due;
     };
 
     CPU* cpu;
@@ -260,12 +252,27 @@ class Scheduler : public SimObject
     // used for searching dependency chain
     std::stack<DynInstPtr> dfs;
 
+    // Timing wheel of the pending speculative wakeups, a slot per cycle
+    // modulo its size, taking the place of an event per wakeup
+    std::vector<std::vector<SpecWakeup>> specWakeWheel;
+    uint64_t numSpecWakeups = 0;
+    // services the slot due next, one tick before its clock edge
+    EventFunctionWrapper specWakeEvent;
+
+    // what issueAndSelect() counts the stalled cycles under while skipping
+    int skipMissLevel = 0;
+    bool skipStoreNotExecuted = false;
+    void countLoadStalls(int misslevel, uint64_t cycles);
+
     // should call at issue first/last cycle,
     void specWakeUpDependents(const DynInstPtr& inst, IssueQue* from_issue_queue);
+    void addSpecWakeup(const DynInstPtr& inst, IssueQue* to, int delay);
+    void serviceSpecWakeups();
+    void scheduleSpecWakeups(Cycles now);
+    template <typename P>
+    void dropSpecWakeups(P pred);
 
   public:
-    PendingWakeEventsType specWakeEvents;
-
     Scheduler(const SchedulerParams& params);
     void setCPU(CPU* cpu, LSQ* lsq);
     void resetDepGraph(uint64_t numPhysRegs);
@@ -273,6 +280,9 @@ class Scheduler : public SimObject
 
     void tick();
     void issueAndSelect();
+    // whether nothing issues until a load comes back from memory
+    bool canSkipCycles();
+    void skipCycles(Cycles cycles);
     bool full(const DynInstPtr& inst);
     bool ready(const DynInstPtr& inst);
     DynInstPtr getInstByDstReg(RegIndex flatIdx);
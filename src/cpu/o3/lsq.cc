@@ -216,6 +216,23 @@ LSQ::tick()
     }
 
 }
+
+bool
+LSQ::canSkipCycles()
+{
+    if (usedLoadPorts || usedStorePorts || dcacheWriteStall ||
+        waitingForStaleTranslation) {
+        return false;
+    }
+
+    for (ThreadID tid : *activeThreads) {
+        if (!thread[tid].canSkipCycles()) {
+            return false;
+        }
+    }
+    return true;
+}
+
 Tick
 LSQ::getLastConflictCheckTick()
 {
@@ -461,6 +478,18 @@ LSQ::anyStoreNotExecute()
     return false;
 }
 
+bool
+LSQ::inflightLoadsAtMemory()
+{
+    // Depth 3 is past the L3, as IEW::checkLoadStoreInst() counts it
+    for (auto it : thread.at(0).inflightLoads) {
+        if (it->isAnyOutstandingRequest() && it->mainReq()->depth < 3) {
+            return false;
+        }
+    }
+    return true;
+}
+
 int LSQ::numStores(ThreadID tid) { return thread.at(tid).numStores(); }
 
 int
@@ -525,6 +554,9 @@ LSQ::completeDataAccess(PacketPtr pkt)
 bool
 LSQ::recvTimingResp(PacketPtr pkt)
 {
+    // The CPU may have stopped ticking to wait for this
+    cpu->wakeFromStallSkip();
+
     if (pkt->isError())
         DPRINTF(LSQ, "Got error packet back for address: %#X\n",
                 pkt->getAddr());
@@ -567,6 +599,8 @@ LSQ::recvTimingResp(PacketPtr pkt)
 void
 LSQ::recvTimingSnoopReq(PacketPtr pkt)
 {
+    cpu->wakeFromStallSkip();
+
     DPRINTF(LSQ, "received pkt for addr:%#x %s\n", pkt->getAddr(),
             pkt->cmdString());
 
@@ -599,6 +633,7 @@ LSQ::recvFunctionalCustomSignal(PacketPtr pkt, int sig)
     if (sig <= 0) {
         return;
     }
+    cpu->wakeFromStallSkip();
     DPRINTF(LSQ, "recvFunctionalCustomSignal: Resp type: %d\n", sig);
 
     LSQRequest *request = nullptr;
@@ -791,6 +791,12 @@ class LSQ
     /** Ticks the LSQ. */
     void tick();
 
+    /**
+     * Returns if ticking the LSQ would do nothing until a response or a
+     * retry comes from the cache.
+     */
+    bool canSkipCycles();
+
     /** Inserts a load into the LSQ. */
     void insertLoad(const DynInstPtr &load_inst);
     /** Inserts a store into the LSQ. */
@@ -867,6 +873,9 @@ class LSQ
 
     bool anyStoreNotExecute();
 
+    /** Returns if every outstanding load has missed in all the caches. */
+    bool inflightLoadsAtMemory();
+
     /** Returns the total number of stores in the store queue. */
     int numStores();
     /** Returns the total number of stores for a single thread. */
@@ -483,6 +483,23 @@ LSQUnit::tick()
     storePipe.advance();
 }
 
+bool
+LSQUnit::canSkipCycles()
+{
+    for (auto &stage : loadPipeSx) {
+        if (stage->size) {
+            return false;
+        }
+    }
+    for (auto &stage : storePipeSx) {
+        if (stage->size) {
+            return false;
+        }
+    }
+    return !willWB() && !isStoreBlocked && storesToWB == 0 &&
+           storeBuffer.unsentSize() == 0;
+}
+
 void
 LSQUnit::init(CPU *cpu_ptr, IEW *iew_ptr, const BaseO3CPUParams &params,
         LSQ *lsq_ptr, unsigned id)
@@ -541,6 +541,9 @@ class LSQUnit
      */
     void tick();
 
+    /** Returns if the load/store pipes and the store buffer are idle. */
+    bool canSkipCycles();
+
     /** Process instructions in each load pipeline stages. */
     void executeLoadPipeSx();
 
@@ -1,85 +1,134 @@
 #include "cpu/o3/perfCCT.hh"
 
+#include <cerrno>
+#include <cstring>
+
+#include "base/cprintf.hh"
 #include "cpu/o3/dyn_inst.hh"
+#include "sim/sim_exit.hh"
 
 namespace gem5
 {
 namespace o3
 {
 
-void
-InstMeta::reset(const DynInstPtr inst)
+/*
+ * Layout of <arch_db_file>.cpu<cpu_id>.perfcct:
+ *   "PERFCCT\0", u32 version, u32 number of stages, stage names (NUL
+ *   terminated), zero padding to 8 bytes;
+ *   InstMeta records in commit order;
+ *   disassembly table: one NUL terminated string per disasmId, that is
+ *   per committed StaticInst and pc;
+ *   u64 file offset of the disassembly table, "PCCTEND\0".
+ */
+static const char perfCCTMagic[8] = {'P', 'E', 'R', 'F', 'C', 'C', 'T', '\0'};
+static const char perfCCTEndMagic[8] = {'P', 'C', 'C', 'T', 'E', 'N', 'D', '\0'};
+static const uint32_t perfCCTVersion = 1;
+
+PerfCCT::PerfCCT(bool enable, ArchDBer* db, int cpu_id)
+    : enableCCT(enable), archdb(db), cpuId(cpu_id)
 {
-    this->sn = inst->seqNum;
-    posTick.clear();
-    posTick.resize((int)PerfRecord::AtCommit + 1);
-    disasm = inst->staticInst->disassemble(inst->pcState().instAddr());
-    pc = inst->pcState().instAddr();
-}
+    if (!enableCCT) {
+        return;
+    }
+    batch.reserve(BatchRecords);
 
+    registerExitCallback([this]() { dump(); });
+}
 
-PerfCCT::PerfCCT(bool enable, ArchDBer* db) : enableCCT(enable), archdb(db)
+void
+PerfCCT::open()
 {
-    if (enableCCT) {
-        metas.resize(MaxMetas);
+    // Only now, as a forked simulator may have moved the arch db
+    outPath = csprintf("%s.cpu%d.perfcct", archdb->db_path, cpuId);
+    out = fopen(outPath.c_str(), "wb");
+    fatal_if(!out, "Can't open %s: %s\n", outPath, strerror(errno));
 
-        ss << "INSERT INTO LifeTimeCommitTrace(";
-        ss << PerfRecordStrings[0];
-        for (int i=1; i < (int)PerfRecord::Num_PerfRecord; i++) {
-            ss << "," << PerfRecordStrings[i];
-        }
-        ss << ") VALUES(";
-        sql_insert_cmd = ss.str();
-        ss.str(std::string());
+    std::string header(perfCCTMagic, sizeof(perfCCTMagic));
+    uint32_t nums[2] = {perfCCTVersion, NumPerfStages};
+    header.append((const char *)nums, sizeof(nums));
+    for (int i = 0; i < NumPerfStages; i++) {
+        header.append(PerfRecordStrings[i]);
+        header.push_back('\0');
     }
+    header.resize((header.size() + 7) & ~7, '\0');
+    fwrite(header.data(), 1, header.size(), out);
 }
 
-InstMeta*
-PerfCCT::getMeta(InstSeqNum sn)
+PerfCCT::~PerfCCT()
 {
-    auto& meta = metas[sn % MaxMetas];
-    return &meta;
+    dump();
 }
 
 void
-PerfCCT::createMeta(const DynInstPtr inst)
+PerfCCT::createMeta(const DynInstPtr &inst)
 {
     if (!enableCCT) [[likely]] {
         return;
     }
-    auto& old = metas[inst->seqNum % MaxMetas];
-    old.reset(inst);
+    auto meta = getMeta(inst->seqNum);
+    meta->sn = inst->seqNum;
+    meta->pc = inst->pcState().instAddr();
+    meta->disasmId = 0;
+    memset(meta->posTick, 0, sizeof(meta->posTick));
 }
 
 void
-PerfCCT::updateInstPos(InstSeqNum sn, const PerfRecord pos)
+PerfCCT::commitMeta(const DynInstPtr &inst)
 {
     if (!enableCCT) [[likely]] {
         return;
     }
-    auto meta = getMeta(sn);
-    meta->posTick.at((int)pos) = curTick();
+    auto meta = getMeta(inst->seqNum);
+    DisasmKey key(inst->staticInst.get(), meta->pc);
+    auto it = disasmIds.find(key);
+    if (it == disasmIds.end()) {
+        it = disasmIds.emplace(key, disasmInsts.size()).first;
+        disasmInsts.emplace_back(inst->staticInst, meta->pc);
+    }
+    meta->disasmId = it->second;
+    batch.push_back(*meta);
+    if (batch.size() == BatchRecords) {
+        flushBatch();
+    }
+}
+
+void
+PerfCCT::flushBatch()
+{
+    if (batch.empty()) {
+        return;
+    }
+    if (!out) {
+        open();
+    }
+    size_t n = fwrite(batch.data(), sizeof(InstMeta), batch.size(), out);
+    fatal_if(n != batch.size(), "Write error on %s: %s\n", outPath, strerror(errno));
+    batch.clear();
 }
 
 void
-PerfCCT::commitMeta(InstSeqNum sn)
+PerfCCT::dump()
 {
-    if (!enableCCT) [[likely]] {
+    if (!enableCCT || dumped) {
+        return;
+    }
+    dumped = true;
+    flushBatch();
+    if (!out) {
+        // Nothing committed
         return;
     }
-    auto meta = getMeta(sn);
-    ss << sql_insert_cmd;
-    // dump counter first
-    ss << meta->posTick[0];
-    for (auto it = meta->posTick.begin() + 1; it != meta->posTick.end(); it++) {
-        ss << "," << *it;
+    uint64_t table_offset = ftell(out);
+    for (auto &[inst, pc] : disasmInsts) {
+        std::string disasm = inst->disassemble(pc);
+        fwrite(disasm.c_str(), 1, disasm.size() + 1, out);
     }
-    // dump string last
-    ss << ",\'" << meta->disasm << "\'";
-    ss << "," << meta->pc;
-    ss << ");";
-    archdb->execmd(ss.str());
-    ss.str(std::string());
+    fwrite(&table_offset, sizeof(table_offset), 1, out);
+    fwrite(perfCCTEndMagic, 1, sizeof(perfCCTEndMagic), out);
+    fclose(out);
+    out = nullptr;
+    warn("perfCCT trace saved to %s\n", outPath.c_str());
 }
 
 }
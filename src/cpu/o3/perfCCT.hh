@@ -1,55 +1,108 @@
 #ifndef __CPU_O3_PERFCCT_HH__
 #define __CPU_O3_PERFCCT_HH__
 
+#include <cassert>
+#include <cstdio>
 #include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "base/types.hh"
+#include "cpu/inst_seq.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/static_inst_fwd.hh"
 #include "enums/PerfRecord.hh"
 #include "sim/arch_db.hh"
+#include "sim/cur_tick.hh"
 
 namespace gem5
 {
 namespace o3
 {
 
+/** Number of stage timestamps kept per instruction */
+constexpr int NumPerfStages = (int)PerfRecord::AtCommit + 1;
 
-class InstMeta
+/**
+ * Fixed-layout lifetime record of one instruction. It is the in-flight
+ * ring entry and, once committed, the on-disk record as is.
+ */
+struct InstMeta
 {
-    friend class PerfCCT;
     InstSeqNum sn;
-    std::vector<uint64_t> posTick;
-    std::string disasm;
     Addr pc;
-  public:
-
-    void reset(const DynInstPtr inst);
+    /** Index into the disassembly table, assigned at commit */
+    uint64_t disasmId;
+    Tick posTick[NumPerfStages];
 };
 
 // performanceCounter commitTrace
 class PerfCCT
 {
-    const int MaxMetas = 1500;  // same as MaxNum of DynInst
+    // Power of two no smaller than MaxNum of DynInst
+    static constexpr int MaxMetas = 2048;
+    /** Committed records buffered before each fwrite */
+    static constexpr int BatchRecords = 4096;
+
     bool enableCCT;
     ArchDBer* archdb;
-    std::string sql_insert_cmd;
-
-    std::vector<InstMeta> metas;
-
-    std::stringstream ss;
-
-    InstMeta* getMeta(InstSeqNum sn);
+    /** Each CPU writes its own trace next to the shared arch db */
+    int cpuId;
+
+    InstMeta metas[MaxMetas];
+
+    std::vector<InstMeta> batch;
+    /** Opened with the first records, none if nothing commits */
+    FILE *out = nullptr;
+    std::string outPath;
+    bool dumped = false;
+
+    /**
+     * Distinct committed StaticInsts at each pc, disassembled when dumping.
+     * A decoded StaticInst is shared by every pc with the same encoding,
+     * and PC-relative ones disassemble differently at each.
+     */
+    using DisasmKey = std::pair<const StaticInst *, Addr>;
+    struct DisasmKeyHash
+    {
+        size_t
+        operator()(const DisasmKey &key) const
+        {
+            return std::hash<const StaticInst *>()(key.first) ^
+                   std::hash<Addr>()(key.second) * 0x9e3779b97f4a7c15ULL;
+        }
+    };
+    std::unordered_map<DisasmKey, uint64_t, DisasmKeyHash> disasmIds;
+    std::vector<std::pair<StaticInstPtr, Addr>> disasmInsts;
+
+    InstMeta* getMeta(InstSeqNum sn) { return &metas[sn & (MaxMetas - 1)]; }
+
+    /** Create the trace file and write its header */
+    void open();
+
+    void flushBatch();
+
+    /** Write the disassembly table and the trailer, then close */
+    void dump();
 
   public:
-    PerfCCT(bool enable, ArchDBer* db);
-
-    void createMeta(const DynInstPtr inst);
-
-    void updateInstPos(InstSeqNum sn, const PerfRecord pos);
-
-    // void updateInstMeta
-
-    void commitMeta(InstSeqNum sn);
+    PerfCCT(bool enable, ArchDBer* db, int cpu_id);
+    ~PerfCCT();
+
+    void createMeta(const DynInstPtr &inst);
+
+    void
+    updateInstPos(InstSeqNum sn, const PerfRecord pos)
+    {
+        if (!enableCCT) [[likely]] {
+            return;
+        }
+        assert((int)pos < NumPerfStages);
+        getMeta(sn)->posTick[(int)pos] = curTick();
+    }
+
+    void commitMeta(const DynInstPtr &inst);
 };
 
 
@@ -0,0 +1,176 @@
+#ifndef __CPU_O3_READY_BITMAP_HH__
+#define __CPU_O3_READY_BITMAP_HH__
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/bitfield.hh"
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "cpu/inst_seq.hh"
+#include "cpu/o3/dyn_inst_ptr.hh"
+
+namespace gem5
+{
+
+namespace o3
+{
+
+/**
+ * The ready instructions of a selector of an issue queue, that is of the
+ * ports sharing a mask of op classes, handed out oldest first as the
+ * priority queue it replaces did.
+ *
+ * An instruction sets the bit of its sequence number, modulo the size of
+ * the bitmap, so the bits are in age order from any point older than every
+ * ready instruction. The bitmap spans more sequence numbers than there are
+ * between the oldest and the youngest instruction it holds, growing if it
+ * has to, and remembers where the last oldest one was. Selecting the oldest
+ * is then masking the words below that point and finding the first set
+ * bit, without comparing instructions at all.
+ *
+ * T is a pointer to something with a seqNum, sequence numbers being unique.
+ */
+template <typename T>
+class ReadyBitmap
+{
+  public:
+    /** Room for a span of capacity sequence numbers, to start with */
+    explicit ReadyBitmap(size_t capacity = 64) { grow(capacity); }
+
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    void
+    push(const T &inst)
+    {
+        InstSeqNum seq_num = inst->seqNum;
+        if (count == 0) {
+            base = youngest = seq_num;
+        } else if (seq_num < base || seq_num >= base + span()) {
+            fit(seq_num);
+        }
+        youngest = std::max(youngest, seq_num);
+
+        size_t pos = seq_num & mask;
+        if (ready[pos / 64] & bit(pos)) {
+            // the same instruction, pushed again before it was selected
+            assert(insts[pos] == inst);
+            return;
+        }
+        ready[pos / 64] |= bit(pos);
+        insts[pos] = inst;
+        if (count == 0 || (oldestValid && seq_num < insts[oldest]->seqNum)) {
+            oldest = pos;
+            oldestValid = true;
+        }
+        count++;
+    }
+
+    /** The oldest instruction */
+    const T &
+    top()
+    {
+        assert(!empty());
+        if (!oldestValid) {
+            oldest = findFirst(base & mask);
+            oldestValid = true;
+        }
+        return insts[oldest];
+    }
+
+    /** Drop the oldest instruction */
+    void
+    pop()
+    {
+        top();
+        // everything left is younger
+        base = insts[oldest]->seqNum + 1;
+        ready[oldest / 64] &= ~bit(oldest);
+        insts[oldest] = T();
+        oldestValid = false;
+        count--;
+    }
+
+  private:
+    static uint64_t bit(size_t pos) { return 1ULL << (pos % 64); }
+
+    size_t span() const { return insts.size(); }
+
+    /** The first ready position at or after from, wrapping around */
+    size_t
+    findFirst(size_t from) const
+    {
+        size_t words = ready.size();
+        size_t w = from / 64;
+        uint64_t bits = ready[w] & (~0ULL << (from % 64));
+        for (size_t i = 0; i <= words; i++) {
+            if (bits) {
+                return w * 64 + findLsbSet(bits);
+            }
+            w = (w + 1) % words;
+            bits = ready[w];
+        }
+        panic("No ready instruction of %lu\n", count);
+    }
+
+    /**
+     * Make seq_num fit in the span along with the instructions held, from
+     * the oldest of them on, growing it if that is not enough
+     */
+    void
+    fit(InstSeqNum seq_num)
+    {
+        base = std::min(top()->seqNum, seq_num);
+        InstSeqNum hi = std::max(youngest, seq_num);
+        if (hi - base >= span()) {
+            grow(hi - base + 1);
+        }
+    }
+
+    /** Room for a span of capacity sequence numbers, a power of 2 */
+    void
+    grow(size_t capacity)
+    {
+        size_t new_span = std::max<size_t>(64, (size_t)1 << ceilLog2(capacity));
+        std::vector<T> new_insts(new_span);
+        std::vector<uint64_t> new_ready(new_span / 64, 0);
+        for (size_t w = 0; w < ready.size(); w++) {
+            for (uint64_t bits = ready[w]; bits; bits &= bits - 1) {
+                size_t pos = w * 64 + findLsbSet(bits);
+                size_t new_pos = insts[pos]->seqNum & (new_span - 1);
+                new_ready[new_pos / 64] |= bit(new_pos);
+                new_insts[new_pos] = std::move(insts[pos]);
+            }
+        }
+        insts.swap(new_insts);
+        ready.swap(new_ready);
+        mask = new_span - 1;
+        oldestValid = false;
+    }
+
+    /** A bit per sequence number in the span, set if it is ready */
+    std::vector<uint64_t> ready;
+    std::vector<T> insts;
+    uint64_t mask{0};
+    size_t count{0};
+
+    /** No older than the oldest ready instruction */
+    InstSeqNum base{0};
+    /** No younger than the youngest ready instruction */
+    InstSeqNum youngest{0};
+
+    size_t oldest{0};
+    bool oldestValid{false};
+};
+
+/** The ready instructions of a selector */
+using ReadyInsts = ReadyBitmap<DynInstPtr>;
+
+} // namespace o3
+} // namespace gem5
+
+#endif // __CPU_O3_READY_BITMAP_HH__
@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2026 Institute of Computing Technology, Chinese Academy of Sciences
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+#include "cpu/o3/ready_bitmap.hh"
+
+using namespace gem5;
+using namespace gem5::o3;
+
+namespace
+{
+
+struct Inst
+{
+    InstSeqNum seqNum;
+};
+
+/** Instructions with sequence numbers of their own, by index */
+class ReadyBitmapTest : public testing::Test
+{
+  protected:
+    std::vector<Inst> pool;
+
+    ReadyBitmapTest() : pool(4096)
+    {
+        for (size_t i = 0; i < pool.size(); i++)
+            pool[i].seqNum = i;
+    }
+
+    std::vector<InstSeqNum>
+    drain(ReadyBitmap<Inst *> &ready)
+    {
+        std::vector<InstSeqNum> seq_nums;
+        while (!ready.empty()) {
+            seq_nums.push_back(ready.top()->seqNum);
+            ready.pop();
+        }
+        return seq_nums;
+    }
+};
+
+} // anonymous namespace
+
+TEST_F(ReadyBitmapTest, OldestFirst)
+{
+    ReadyBitmap<Inst *> ready(64);
+    for (int i : {7, 3, 12, 5, 40, 1})
+        ready.push(&pool[i]);
+    ASSERT_EQ(ready.size(), 6);
+    ASSERT_EQ(ready.top()->seqNum, 1);
+
+    // an older one becomes the top right away
+    ready.push(&pool[0]);
+    ASSERT_EQ(ready.top()->seqNum, 0);
+    ASSERT_EQ(drain(ready), std::vector<InstSeqNum>({0, 1, 3, 5, 7, 12, 40}));
+}
+
+/** Pushing an instruction that is already ready keeps a single entry */
+TEST_F(ReadyBitmapTest, PushAgain)
+{
+    ReadyBitmap<Inst *> ready(64);
+    ready.push(&pool[4]);
+    ready.push(&pool[9]);
+    ready.push(&pool[4]);
+    ASSERT_EQ(ready.size(), 2);
+    ASSERT_EQ(drain(ready), std::vector<InstSeqNum>({4, 9}));
+}
+
+/** Instructions older than the last one popped still come out first */
+TEST_F(ReadyBitmapTest, OlderThanPopped)
+{
+    ReadyBitmap<Inst *> ready(64);
+    for (int i : {20, 30})
+        ready.push(&pool[i]);
+    ready.pop();
+    ready.push(&pool[10]);
+    ready.push(&pool[25]);
+    ASSERT_EQ(drain(ready), std::vector<InstSeqNum>({10, 25, 30}));
+}
+
+/** The bits wrap around the span as sequence numbers go up */
+TEST_F(ReadyBitmapTest, WrapAround)
+{
+    ReadyBitmap<Inst *> ready(64);
+    for (int i = 0; i < 40; i++)
+        ready.push(&pool[i]);
+    for (int i = 40; i < 1000; i++) {
+        ASSERT_EQ(ready.top()->seqNum, i - 40);
+        ready.pop();
+        ready.push(&pool[i]);
+    }
+    ASSERT_EQ(ready.size(), 40);
+    ASSERT_EQ(ready.top()->seqNum, 960);
+}
+
+/** An instruction far from the oldest one held grows the span */
+TEST_F(ReadyBitmapTest, Grow)
+{
+    ReadyBitmap<Inst *> ready(64);
+    for (int i : {100, 50, 63})
+        ready.push(&pool[i]);
+    ready.push(&pool[700]);
+    ready.push(&pool[10]);
+    ready.push(&pool[2000]);
+    ASSERT_EQ(drain(ready),
+              std::vector<InstSeqNum>({10, 50, 63, 100, 700, 2000}));
+}
+
+/** Any order of pushes and pops hands out the oldest, as a heap does */
+TEST_F(ReadyBitmapTest, MatchesSorted)
+{
+    ReadyBitmap<Inst *> ready(64);
+    std::vector<InstSeqNum> ref;
+    std::mt19937 rng(1);
+    InstSeqNum window = 0;
+    for (int step = 0; step < 20000; step++) {
+        if (rng() % 3 && window + 256 < pool.size()) {
+            InstSeqNum seq_num = window + rng() % 256;
+            if (std::find(ref.begin(), ref.end(), seq_num) == ref.end())
+                ref.push_back(seq_num);
+            ready.push(&pool[seq_num]);
+        } else if (!ref.empty()) {
+            auto oldest = std::min_element(ref.begin(), ref.end());
+            ASSERT_EQ(ready.top()->seqNum, *oldest);
+            ready.pop();
+            ref.erase(oldest);
+        }
+        if (step % 16 == 0 && window + 256 + 1 < pool.size())
+            window++;
+        ASSERT_EQ(ready.size(), ref.size());
+    }
+}
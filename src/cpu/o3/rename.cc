@@ -493,6 +493,24 @@ Rename::tick()
 
 }
 
+bool
+Rename::canSkipCycles() const
+{
+    const ThreadID tid = 0;
+    const auto &commit_info = fromCommit->commitInfo[tid];
+    const auto &iew_info = fromIEW->iewInfo[tid];
+    return renameStatus[tid] == Blocked && fromDecode->size == 0 &&
+        !commit_info.squash && !commit_info.doneSeqNum &&
+        !fromIEW->iewUnblock[tid] && !iew_info.dispatched &&
+        !iew_info.dispatchedToLQ && !iew_info.dispatchedToSQ;
+}
+
+void
+Rename::skipCycles(Cycles cycles)
+{
+    stats.blockCycles += cycles;
+}
+
 void
 Rename::rename(bool &status_change, ThreadID tid)
 {
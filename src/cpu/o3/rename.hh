@@ -208,6 +208,14 @@ class Rename
      */
     void tick();
 
+    /** Whether the next ticks would only count a cycle blocked on the back
+     * end, with nothing coming from decode.
+     */
+    bool canSkipCycles() const;
+
+    /** Count cycles skipped while canSkipCycles() held as blocked. */
+    void skipCycles(Cycles cycles);
+
     /** Debugging function used to dump history buffer of renamings. */
     void dumpHistory();
 
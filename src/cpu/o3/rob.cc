@@ -107,6 +107,10 @@ ROB::ROB(CPU *_cpu, const BaseO3CPUParams &params)
         maxEntries[tid] = 0;
     }
 
+    for (ThreadID tid = 0; tid < numThreads; tid++) {
+        instList[tid].reserve(numEntries);
+    }
+
     resetState();
 }
 
@@ -248,10 +252,8 @@ ROB::retireHead(ThreadID tid)
     assert(numInstsInROB > 0);
 
     // Get the head ROB instruction by copying it and remove it from the list
-    InstIt head_it = instList[tid].begin();
-
-    DynInstPtr head_inst = std::move(*head_it);
-    instList[tid].erase(head_it);
+    DynInstPtr head_inst = instList[tid].front();
+    instList[tid].pop_front();
 
     assert(head_inst->readyToCommit());
     assert(!head_inst->isSquashed());
@@ -50,6 +50,7 @@
 #include "config/the_isa.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/o3/inst_ring.hh"
 #include "cpu/o3/limits.hh"
 #include "cpu/reg_class.hh"
 #include "enums/ROBWalkPolicy.hh"
@@ -74,7 +75,7 @@ class ROB
 {
   public:
     typedef std::pair<RegIndex, RegIndex> UnmapInfo;
-    typedef typename std::list<DynInstPtr>::iterator InstIt;
+    typedef InstList::iterator InstIt;
 
     /** Possible ROB statuses. */
     enum Status
@@ -290,7 +291,7 @@ class ROB
     unsigned maxEntries[MaxThreads];
 
     /** ROB List of Instructions */
-    std::list<DynInstPtr> instList[MaxThreads];
+    InstList instList[MaxThreads];
 
     /** Number of instructions that can be squashed in a single cycle. */
     unsigned rollbackWidth;
@@ -304,7 +305,7 @@ class ROB
     unsigned computeDynSquashWidth(unsigned uncommitted_insts, unsigned to_squash);
 
   public:
-    std::list<DynInstPtr>* getInstList(ThreadID tid){
+    InstList* getInstList(ThreadID tid){
         return &instList[tid];
     }
     /** Iterator pointing to the instruction which is the last instruction
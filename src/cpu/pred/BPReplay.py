@@ -0,0 +1,25 @@
+from m5.objects.ClockedObject import ClockedObject
+from m5.params import *
+from m5.proxy import *
+
+class BPReplay(ClockedObject):
+    type = 'BPReplay'
+    cxx_class = 'gem5::branch_prediction::ftb_pred::BPReplay'
+    cxx_header = "cpu/pred/ftb/bp_replay.hh"
+
+    bpu = Param.DecoupledBPUWithFTB("Predictor to drive")
+    trace = Param.String("Committed control flow trace, recorded with "
+        "the cfiTrace parameter of DecoupledBPUWithFTB or by NEMU")
+    numThreads = Param.Unsigned(1, "Threads of the replayed core")
+    maxInsts = Param.UInt64(0, "Replay at most this many instructions, "
+        "0 for the whole trace")
+
+    fetchWidth = Param.Unsigned(16, "Instructions fetched per cycle")
+    commitWidth = Param.Unsigned(8, "Instructions committed per cycle")
+    windowSize = Param.Unsigned(320, "Instructions in flight, i.e. ROB "
+        "entries")
+    decodeRedirectLatency = Param.Cycles(5, "Cycles from fetch to a "
+        "redirect by decode")
+    executeRedirectLatency = Param.Cycles(14, "Cycles from fetch to a "
+        "redirect by execute")
+    commitLatency = Param.Cycles(20, "Cycles from fetch to commit")
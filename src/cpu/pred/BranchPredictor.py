@@ -958,3 +958,19 @@ class DecoupledBPUWithFTB(BranchPredictor):
     enableLoopPredictor = Param.Bool(False, "Use loop predictor to predict loop exit")
     enableJumpAheadPredictor = Param.Bool(False, "Use jump ahead predictor to skip no-need-to-predict blocks")
     enableTwoTaken = Param.Bool(False, "Enable predicting two taken blocks per cycle")
+    cfiTrace = Param.String("", "Record the committed control flow to this "
+        "file in the outdir, for replay with BPReplay (.gz to compress)")
+    warmStateIn = Param.String("", "Load the trained predictor state from "
+        "this file at startup, e.g. one saved with warmStateOut")
+    warmStateOut = Param.String("", "Save the trained predictor state to "
+        "this file in the outdir at exit (.gz to compress)")
+    enableProfiling = Param.Bool(False, "Profile committed branches to the "
+        "topMispredict*, *ByPhase and *BySubPhase files in the outdir")
+    profilingSamplePeriod = Param.Unsigned(1, "Profile one of this many "
+        "committed streams and branches, picked at random")
+    profilingTopK = Param.Unsigned(4096, "Entries kept by each profiling "
+        "table, the most frequent ones, 0 for no limit")
+    profilingPhaseSize = Param.Unsigned(100000, "Committed instructions per "
+        "profiling phase")
+    profilingSubPhaseRatio = Param.Unsigned(10, "Sub phases per profiling "
+        "phase")
@@ -0,0 +1,319 @@
+#include "cpu/pred/ftb/bp_profiler.hh"
+
+#include <cassert>
+
+#include "base/trace.hh"
+#include "debug/Profiling.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+namespace {
+
+// top branches of each phase
+constexpr int outputTopN = 5;
+// top FTB entries of each phase, plus one
+constexpr int outputTopNEntries = 1;
+// minimum executions for the misrate list
+constexpr uint64_t mispCntThres = 100;
+
+} // anonymous namespace
+
+BPProfiler::BPProfiler(unsigned num_br, unsigned sample_period,
+                       unsigned top_k, unsigned phase_size,
+                       unsigned sub_phase_ratio)
+    : numBr(num_br), samplePeriod(sample_period), phaseSize(phase_size),
+      subPhaseSize(phase_size / sub_phase_ratio),
+      topMispredicts(top_k), topMispredictsByBranch(top_k),
+      topMispredHist(top_k), topMispredIndirect(top_k),
+      phases(top_k, "topMispredictByPhase.txt", "phaseID"),
+      subPhases(top_k, "topMispredictBySubPhase.txt", "subPhaseID"),
+      phaseFTBEntries(top_k)
+{
+    fatal_if(sample_period == 0, "Profiling sample period cannot be 0\n");
+    fatal_if(subPhaseSize == 0, "Profiling phase of %u instructions has no "
+             "sub phases of 1/%u of it\n", phase_size, sub_phase_ratio);
+    openPhaseFiles();
+}
+
+void
+BPProfiler::commitStream(const FetchStream &stream)
+{
+    // cheap, so exact
+    if (stream.commitInstNum >= 0 && stream.commitInstNum <= 16) {
+        phaseCommittedInstDist[stream.commitInstNum]++;
+    }
+    if (stream.fetchInstNum >= 0 && stream.fetchInstNum <= 16) {
+        phaseFetchedInstDist[stream.fetchInstNum]++;
+    }
+
+    if (!sample()) {
+        return;
+    }
+    if (stream.squashType == SQUASH_CTRL) {
+        topMispredicts.add(
+            std::make_pair(stream.startPC, stream.exeBranchInfo.pc))++;
+        topMispredHist.add(stream.history.bits(0, 18))++;
+        if (stream.exeBranchInfo.isIndirect) {
+            topMispredIndirect.add(stream.startPC)++;
+        }
+    }
+    if (stream.isHit || stream.exeTaken) {
+        phaseFTBEntries.add(stream.startPC) = stream.updateFTBEntry;
+    }
+}
+
+void
+BPProfiler::commitBranch(const FetchStream &entry, BranchInfo &info,
+                         bool taken, bool miss)
+{
+    if (!sample()) {
+        return;
+    }
+    Addr branchAddr = info.pc;
+    MispredType mtype = FAKE_LAST;
+    if (miss) {
+        // not taken can only be
+        if (!taken) {
+            assert(info.isCond);
+            mtype = DIR_WRONG;
+        } else {
+            bool predBranchInFTB = false;
+            if (entry.isHit) {
+                for (auto slot : entry.predFTBEntry.slots) {
+                    if (slot.pc == branchAddr &&
+                        slot.getType() == info.getType()) {
+                        predBranchInFTB = true;
+                    }
+                }
+            }
+            if (!predBranchInFTB) {
+                mtype = NO_PRED;
+            } else if (entry.predTaken &&
+                       entry.predBranchInfo.pc == branchAddr) {
+                mtype = TARGET_WRONG;
+            } else {
+                // pred stream not taken or taken with other branch
+                mtype = DIR_WRONG;
+            }
+        }
+        DPRINTF(Profiling, "branchAddr %#lx is mispredicted, taken %d, "
+                "type %d, missType %d\n", branchAddr, taken, info.getType(),
+                mtype);
+    }
+
+    auto key = std::make_pair(branchAddr, info.getType());
+    for (auto *table : {&topMispredictsByBranch, &phases.branches,
+                        &subPhases.branches}) {
+        auto &rec = table->add(key);
+        rec.total++;
+        if (miss) {
+            rec.mispredicts++;
+            rec.reasons[mtype]++;
+        }
+    }
+    if (miss) {
+        phases.mispredicts++;
+        subPhases.mispredicts++;
+    }
+    if (taken) {
+        phases.takenBranches.add(branchAddr)++;
+        subPhases.takenBranches.add(branchAddr)++;
+    }
+}
+
+void
+BPProfiler::commitInst()
+{
+    numInstCommitted++;
+    if (numInstCommitted % phaseSize == 0) {
+        DPRINTF(Profiling, "numInstCommitted %lu, dump phase %d\n",
+                numInstCommitted, phases.id);
+        dumpPhase(phases);
+        dumpFsqDist(committedInstDistOut, phaseCommittedInstDist);
+        dumpFsqDist(fetchedInstDistOut, phaseFetchedInstDist);
+        dumpFTBEntries();
+        phases.id++;
+    }
+    if (numInstCommitted % subPhaseSize == 0) {
+        DPRINTF(Profiling, "numInstCommitted %lu, dump sub phase %d\n",
+                numInstCommitted, subPhases.id);
+        dumpPhase(subPhases);
+        subPhases.id++;
+    }
+}
+
+void
+BPProfiler::openPhaseFiles()
+{
+    for (auto *p : {&phases, &subPhases}) {
+        p->out = simout.create(p->file, false, true);
+        auto &os = *p->out->stream();
+        os << p->idName << " numBranches numEverTakenBranches "
+           << "totalMispredicts";
+        for (int i = 0; i < outputTopN; i++) {
+            os << " topMispPC_" << i << " type_" << i << " misCnt_" << i;
+        }
+        os << std::endl;
+    }
+
+    auto open_fsq_dist = [](const char *file) {
+        auto out = simout.create(file, false, true);
+        auto &os = *out->stream();
+        os << "phaseID";
+        for (int i = 0; i <= 16; i++) {
+            os << " " << i;
+        }
+        os << " average" << std::endl;
+        return out;
+    };
+    committedInstDistOut =
+        open_fsq_dist("fsqEntryCommittedInstNumDistsByPhase.txt");
+    fetchedInstDistOut =
+        open_fsq_dist("fsqEntryFetchedInstNumDistsByPhase.txt");
+
+    ftbEntriesOut = simout.create("ftbEntriesByPhase.txt", false, true);
+    auto &os = *ftbEntriesOut->stream();
+    os << "phaseID numFTBEntries";
+    for (int i = 0; i <= outputTopNEntries; i++) {
+        os << " entry_" << i << "_pc";
+        for (int n = 0; n < numBr; n++) {
+            os << " entry_" << i << "_br_" << n << "_pc";
+            os << " entry_" << i << "_br_" << n << "_type";
+        }
+    }
+    os << std::endl;
+}
+
+void
+BPProfiler::dumpPhase(Phases &p)
+{
+    auto &os = *p.out->stream();
+    os << p.id << " " << p.branches.size() << " "
+       << p.takenBranches.size() << " " << p.mispredicts;
+    auto top = p.branches.sorted(
+        [](const BranchRecord &a, const BranchRecord &b) {
+            return a.mispredicts > b.mispredicts;
+        }, outputTopN);
+    for (auto *rec : top) {
+        os << " " << std::hex << rec->first.first << std::dec << " "
+           << rec->first.second << " " << rec->second.value.mispredicts;
+    }
+    os << std::endl;
+
+    p.branches.clear();
+    p.takenBranches.clear();
+    p.mispredicts = 0;
+}
+
+void
+BPProfiler::dumpFsqDist(OutputStream *out, std::array<uint64_t, 17> &dist)
+{
+    auto &os = *out->stream();
+    os << phases.id;
+    uint64_t numFsqEntries = 0;
+    for (auto n : dist) {
+        os << " " << n;
+        numFsqEntries += n;
+    }
+    os << " " << (double)phaseSize / (double)numFsqEntries << std::endl;
+    dist.fill(0);
+}
+
+void
+BPProfiler::dumpFTBEntries()
+{
+    auto &os = *ftbEntriesOut->stream();
+    os << std::dec << phases.id << " " << phaseFTBEntries.size();
+    // by the number of updates
+    auto top = phaseFTBEntries.heaviest(outputTopNEntries + 1);
+    for (auto *rec : top) {
+        os << " " << std::hex << rec->first;
+        auto &entry = rec->second.value;
+        for (int b = 0; b < numBr; b++) {
+            auto slot = entry.slots.size() <= b ? FTBSlot() : entry.slots[b];
+            os << " " << slot.pc << " " << slot.getType();
+        }
+    }
+    os << std::dec << std::endl;
+
+    phaseFTBEntries.clear();
+}
+
+void
+BPProfiler::dump()
+{
+    for (auto **out : {&phases.out, &subPhases.out, &committedInstDistOut,
+                       &fetchedInstDistOut, &ftbEntriesOut}) {
+        simout.close(*out);
+        *out = nullptr;
+    }
+
+    auto out_handle = simout.create("topMisPredicts.txt", false, true);
+    *out_handle->stream() << "startPC control pc count" << std::endl;
+    for (auto *rec : topMispredicts.sorted(std::greater<uint64_t>())) {
+        *out_handle->stream() << std::hex << rec->first.first << " "
+                              << rec->first.second << " " << std::dec
+                              << rec->second.value << std::endl;
+    }
+    simout.close(out_handle);
+
+    // at a per branch basis
+    auto print_branch = [](std::ostream &os, const auto *rec) {
+        auto &b = rec->second.value;
+        os << std::hex << rec->first.first << std::dec << " "
+           << rec->first.second << " " << b.mispredicts << " " << b.total
+           << " " << b.mispredicts * 1000 / b.total << " "
+           << b.reasons[DIR_WRONG] << " " << b.reasons[TARGET_WRONG] << " "
+           << b.reasons[NO_PRED] << std::endl;
+    };
+    const char *branch_header = "pc type mispredicts total misPermil "
+                                "dirMiss tgtMiss noPredMiss";
+    out_handle = simout.create("topMispredictsByBranch.txt", false, true);
+    *out_handle->stream() << branch_header << std::endl;
+    for (auto *rec : topMispredictsByBranch.sorted(
+             [](const BranchRecord &a, const BranchRecord &b) {
+                 return a.mispredicts > b.mispredicts;
+             })) {
+        print_branch(*out_handle->stream(), rec);
+    }
+    simout.close(out_handle);
+
+    // top misrate branches, of the ones executed often enough
+    out_handle = simout.create("topMisrateByBranch.txt", false, true);
+    *out_handle->stream() << branch_header << std::endl;
+    for (auto *rec : topMispredictsByBranch.sorted(
+             [](const BranchRecord &a, const BranchRecord &b) {
+                 return a.mispredicts * b.total > b.mispredicts * a.total;
+             })) {
+        // counts are of sampled branches
+        if (rec->second.value.total * samplePeriod >= mispCntThres) {
+            print_branch(*out_handle->stream(), rec);
+        }
+    }
+    simout.close(out_handle);
+
+    out_handle = simout.create("topMisPredictHist.txt", false, true);
+    *out_handle->stream() << "Hist count" << std::endl;
+    for (auto *rec : topMispredHist.sorted(std::greater<uint64_t>())) {
+        *out_handle->stream() << std::hex << rec->first << " " << std::dec
+                              << rec->second.value << std::endl;
+    }
+    simout.close(out_handle);
+
+    out_handle = simout.create("misPredIndirectStream.txt", false, true);
+    for (auto *rec : topMispredIndirect.sorted(std::greater<uint64_t>())) {
+        *out_handle->stream() << std::oct << rec->second.value << " "
+                              << std::hex << rec->first << std::endl;
+    }
+    simout.close(out_handle);
+}
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
@@ -0,0 +1,263 @@
+#ifndef __CPU_PRED_FTB_BP_PROFILER_HH__
+#define __CPU_PRED_FTB_BP_PROFILER_HH__
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "base/output.hh"
+#include "base/random.hh"
+#include "base/types.hh"
+#include "cpu/pred/ftb/stream_struct.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+struct PairHash
+{
+    template <typename A, typename B>
+    size_t
+    operator()(const std::pair<A, B> &p) const
+    {
+        size_t h = std::hash<A>()(p.first);
+        return h ^ (std::hash<B>()(p.second) + 0x9e3779b97f4a7c15ULL +
+                    (h << 6) + (h >> 2));
+    }
+};
+
+/**
+ * A hash table holding at most capacity keys, the heaviest ones of a
+ * stream of weighted updates (0 for no limit).
+ *
+ * Once full, a new key evicts the lighter half of the table, and every key
+ * inserted from then on starts at the weight of the heaviest key evicted so
+ * far, as in space saving. A key heavier than that weight is thus never
+ * lost, and eviction costs O(1) per insertion amortized. The value of a key
+ * only counts what happened since it was last inserted.
+ */
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class TopKTable
+{
+  public:
+    struct Entry
+    {
+        Value value{};
+        uint64_t weight{0};
+    };
+    using Map = std::unordered_map<Key, Entry, Hash>;
+    using Record = std::pair<const Key, Entry>;
+
+    explicit TopKTable(size_t capacity) : capacity(capacity)
+    {
+        table.reserve(capacity);
+    }
+
+    Value &
+    add(const Key &key, uint64_t weight = 1)
+    {
+        auto it = table.find(key);
+        if (it == table.end()) {
+            if (capacity && table.size() >= capacity) {
+                evict();
+            }
+            it = table.emplace(key, Entry{Value(), floor}).first;
+        }
+        it->second.weight += weight;
+        return it->second.value;
+    }
+
+    size_t size() const { return table.size(); }
+    /** Whether keys were ever evicted, making size() a lower bound */
+    bool saturated() const { return floor != 0; }
+
+    void
+    clear()
+    {
+        table.clear();
+        floor = 0;
+    }
+
+    /** The records sorted by cmp on their values, at most n of them */
+    template <typename Cmp>
+    std::vector<const Record *>
+    sorted(Cmp cmp, size_t n = SIZE_MAX) const
+    {
+        std::vector<const Record *> recs;
+        recs.reserve(table.size());
+        for (auto &rec : table) {
+            recs.push_back(&rec);
+        }
+        auto by_value = [&](const Record *a, const Record *b) {
+            return cmp(a->second.value, b->second.value);
+        };
+        n = std::min(n, recs.size());
+        std::partial_sort(recs.begin(), recs.begin() + n, recs.end(),
+                          by_value);
+        recs.resize(n);
+        return recs;
+    }
+
+    /** The n heaviest records */
+    std::vector<const Record *>
+    heaviest(size_t n) const
+    {
+        std::vector<const Record *> recs;
+        recs.reserve(table.size());
+        for (auto &rec : table) {
+            recs.push_back(&rec);
+        }
+        n = std::min(n, recs.size());
+        std::partial_sort(recs.begin(), recs.begin() + n, recs.end(),
+                          [](const Record *a, const Record *b) {
+                              return a->second.weight > b->second.weight;
+                          });
+        recs.resize(n);
+        return recs;
+    }
+
+  private:
+    void
+    evict()
+    {
+        std::vector<typename Map::iterator> recs;
+        recs.reserve(table.size());
+        for (auto it = table.begin(); it != table.end(); ++it) {
+            recs.push_back(it);
+        }
+        auto mid = recs.begin() + recs.size() / 2;
+        std::nth_element(recs.begin(), mid, recs.end(),
+                         [](const auto &a, const auto &b) {
+                             return a->second.weight < b->second.weight;
+                         });
+        for (auto it = recs.begin(); it != mid; ++it) {
+            floor = std::max(floor, (*it)->second.weight);
+            table.erase(*it);
+        }
+    }
+
+    const size_t capacity;
+    Map table;
+    uint64_t floor{0};
+};
+
+/**
+ * The branch profiles of DecoupledBPUWithFTB, on with enableProfiling.
+ *
+ * Committed streams and branches update tables of bounded size, see
+ * TopKTable, one of every samplePeriod of them picked at random. Per phase
+ * tables are written to their files as each phase ends and then cleared,
+ * so memory does not grow with the run, the whole run tables at exit.
+ */
+class BPProfiler
+{
+  public:
+    enum MispredType
+    {
+        DIR_WRONG,
+        TARGET_WRONG,
+        NO_PRED,
+        FAKE_LAST
+    };
+
+    BPProfiler(unsigned num_br, unsigned sample_period, unsigned top_k,
+               unsigned phase_size, unsigned sub_phase_ratio);
+
+    /** Stream committed, with the FTB updated by it */
+    void commitStream(const FetchStream &stream);
+
+    /** The branch of info committed in stream entry */
+    void commitBranch(const FetchStream &entry, BranchInfo &info, bool taken,
+                      bool miss);
+
+    /** Count a committed instruction, ending phases */
+    void commitInst();
+
+    /** Write the whole run tables, close the phase files */
+    void dump();
+
+  private:
+    struct BranchRecord
+    {
+        uint64_t mispredicts{0};
+        std::array<uint64_t, FAKE_LAST> reasons{};
+        uint64_t total{0};
+    };
+    //                               (pc, type)
+    using BranchTable = TopKTable<std::pair<Addr, int>, BranchRecord,
+                                  PairHash>;
+    using CountTable = TopKTable<Addr, uint64_t>;
+
+    /** The per phase tables and files, of phases or sub phases */
+    struct Phases
+    {
+        Phases(size_t top_k, const char *file, const char *id_name)
+            : branches(top_k), takenBranches(top_k), file(file),
+              idName(id_name)
+        {}
+
+        BranchTable branches;
+        CountTable takenBranches;
+        const char *file;
+        const char *idName;
+        uint64_t mispredicts{0};
+        OutputStream *out{nullptr};
+        int id{0};
+    };
+
+    /** Whether to profile the next stream or branch */
+    bool
+    sample()
+    {
+        return samplePeriod == 1 ||
+               rng.random<unsigned>(0, samplePeriod - 1) == 0;
+    }
+
+    void openPhaseFiles();
+    void dumpPhase(Phases &p);
+    void dumpFsqDist(OutputStream *out, std::array<uint64_t, 17> &dist);
+    void dumpFTBEntries();
+
+    const unsigned numBr;
+    const unsigned samplePeriod;
+    const uint64_t phaseSize;
+    const uint64_t subPhaseSize;
+
+    Random rng{0};
+
+    uint64_t numInstCommitted{0};
+
+    //                   (startPC, branch pc)
+    TopKTable<std::pair<Addr, Addr>, uint64_t, PairHash> topMispredicts;
+    BranchTable topMispredictsByBranch;
+    CountTable topMispredHist;
+    CountTable topMispredIndirect;
+
+    Phases phases;
+    Phases subPhases;
+
+    /** Fetch streams by committed and fetched instructions this phase */
+    std::array<uint64_t, 17> phaseCommittedInstDist{};
+    std::array<uint64_t, 17> phaseFetchedInstDist{};
+    OutputStream *committedInstDistOut{nullptr};
+    OutputStream *fetchedInstDistOut{nullptr};
+
+    //                       startPC   last entry, weighted by updates
+    TopKTable<Addr, FTBEntry> phaseFTBEntries;
+    OutputStream *ftbEntriesOut{nullptr};
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_BP_PROFILER_HH__
@@ -0,0 +1,334 @@
+#include "cpu/pred/ftb/bp_replay.hh"
+
+#include "arch/riscv/pcstate.hh"
+#include "base/logging.hh"
+#include "cpu/static_inst.hh"
+#include "sim/sim_exit.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+namespace
+{
+
+/** Carries the control flags of a trace record, nothing else */
+class ReplayInst : public StaticInst
+{
+  public:
+    explicit ReplayInst(uint8_t cfi)
+        : StaticInst(cfi ? "replay_branch" : "replay_inst", No_OpClass)
+    {
+        if (cfi) {
+            flags[IsControl] = true;
+            flags[IsCondControl] = cfi & CfiTrace::Cond;
+            flags[IsUncondControl] = !(cfi & CfiTrace::Cond);
+            flags[IsIndirectControl] = cfi & CfiTrace::Indirect;
+            flags[IsDirectControl] = !(cfi & CfiTrace::Indirect);
+            flags[IsCall] = cfi & CfiTrace::Call;
+            flags[IsReturn] = cfi & CfiTrace::Return;
+            flags[IsNonSpeculative] = cfi & CfiTrace::NonSpec;
+        }
+    }
+
+    Fault
+    execute(ExecContext *xc, Trace::InstRecord *traceData) const override
+    {
+        panic("Replayed instructions are never executed\n");
+    }
+
+    void
+    advancePC(PCStateBase &pc) const override
+    {
+        pc.advance();
+    }
+
+    std::string
+    generateDisassembly(Addr pc,
+            const loader::SymbolTable *symtab) const override
+    {
+        return mnemonic;
+    }
+};
+
+RiscvISA::PCState
+pcStateOf(const CfiTrace::Inst &inst)
+{
+    RiscvISA::PCState pc(inst.pc);
+    pc.compressed(inst.size == 2);
+    pc.npc(inst.pc + inst.size);
+    return pc;
+}
+
+}  // anonymous namespace
+
+std::atomic<unsigned> BPReplay::running{0};
+
+BPReplay::BPReplay(const Params &p)
+    : ClockedObject(p),
+      bpu(p.bpu),
+      reader(p.trace),
+      fetchWidth(p.fetchWidth),
+      commitWidth(p.commitWidth),
+      windowSize(p.windowSize),
+      decodeRedirectLatency(p.decodeRedirectLatency),
+      executeRedirectLatency(p.executeRedirectLatency),
+      commitLatency(p.commitLatency),
+      maxInsts(p.maxInsts),
+      tickEvent([this]{ tick(); }, name()),
+      stats(this)
+{
+    fatal_if(!fetchWidth || !commitWidth || !windowSize,
+             "%s: widths and window size must not be zero\n", name());
+    fatal_if(executeRedirectLatency < decodeRedirectLatency,
+             "%s: execute redirects before decode\n", name());
+    fatal_if(commitLatency <= executeRedirectLatency,
+             "%s: commitLatency must be larger than executeRedirectLatency\n",
+             name());
+    bpu->setClockSource(this);
+    staticInsts[0] = new ReplayInst(0);
+    running++;
+}
+
+void
+BPReplay::startup()
+{
+    traceLeft = reader.next(nextInst);
+    fetchPC = reader.startPC();
+    bpu->resetPC(fetchPC);
+    schedule(tickEvent, clockEdge());
+}
+
+const StaticInstPtr &
+BPReplay::staticInstFor(uint8_t flags)
+{
+    auto it = staticInsts.find(flags);
+    if (it == staticInsts.end()) {
+        it = staticInsts.emplace(flags, new ReplayInst(flags)).first;
+    }
+    return it->second;
+}
+
+void
+BPReplay::tick()
+{
+    stats.cycles++;
+
+    applyRedirect();
+    commit();
+
+    if (bpu->enableTwoTaken) {
+        bpu->ideal_tick();
+    } else {
+        bpu->tick();
+    }
+    bpu->trySupplyFetchWithTarget(fetchPC, fetchTargetInLoop);
+
+    fetch();
+
+    if (!traceLeft && window.empty()) {
+        finish();
+        return;
+    }
+    schedule(tickEvent, clockEdge(Cycles(1)));
+}
+
+void
+BPReplay::applyRedirect()
+{
+    if (!redirect.valid || curCycle() < redirect.when) {
+        return;
+    }
+    redirect.valid = false;
+
+    auto &fi = *redirect.inst;
+    RiscvISA::PCState target(fi.inst.npc);
+    bpu->controlSquash(fi.ftqId, fi.fsqId, pcStateOf(fi.inst), target,
+                       fi.staticInst, fi.inst.size, redirect.actuallyTaken,
+                       fi.seqNum, 0, fi.loopIter, redirect.fromCommit);
+    if (redirect.fromCommit) {
+        stats.executeRedirects++;
+    } else {
+        stats.decodeRedirects++;
+    }
+
+    fetchPC = fi.inst.npc;
+    // a trap after it still stalls fetch until it commits
+    fetchStalled = fi.inst.redirect;
+}
+
+void
+BPReplay::commit()
+{
+    FetchStreamId done_fsq_id = 0;
+    for (unsigned n = 0; n < commitWidth && !window.empty(); n++) {
+        const auto &fi = window.front();
+        if (fi.commitCycle > curCycle()) {
+            break;
+        }
+        assert(!redirect.valid || redirect.inst != &fi);
+
+        CommittedInst ci{fi.inst.pc, fi.inst.npc, fi.inst.pc + fi.inst.size,
+                         fi.inst.npc != fi.inst.pc + fi.inst.size,
+                         fi.staticInst, fi.fsqId};
+        // as in commit, xret is not trained on
+        if (fi.staticInst->isControl() && !fi.staticInst->isNonSpeculative()) {
+            bpu->commitBranch(ci, fi.mispred);
+            stats.committedBranches++;
+        }
+        bpu->notifyInstCommit(ci);
+        stats.committedInsts++;
+        if (fi.fsqId > 1) {
+            done_fsq_id = fi.fsqId - 1;
+        }
+
+        bool trap = fi.inst.redirect;
+        if (trap) {
+            RiscvISA::PCState target(fi.inst.redirectPC);
+            bpu->trapSquash(fi.ftqId, fi.fsqId, fi.inst.pc, target, 0,
+                            fi.loopIter);
+            stats.traps++;
+            fetchPC = fi.inst.redirectPC;
+            fetchStalled = false;
+        }
+        window.pop_front();
+        if (trap) {
+            break;
+        }
+    }
+
+    if (done_fsq_id) {
+        bpu->update(done_fsq_id, 0);
+    }
+}
+
+bool
+BPReplay::checkPrediction(InFlight &fi, Addr pred_pc, bool pred_taken)
+{
+    const auto &inst = fi.inst;
+    if (pred_pc == inst.npc) {
+        return true;
+    }
+    fi.mispred = true;
+
+    const auto &si = fi.staticInst;
+    bool actually_taken = inst.npc != inst.pc + inst.size;
+    bool from_decode = false;
+    if (!si->isControl()) {
+        // decode finds no branch where one was predicted taken
+        from_decode = true;
+        actually_taken = true;
+    } else if (si->isDirectCtrl() && actually_taken &&
+               (si->isUncondCtrl() || pred_taken)) {
+        // decode computes the target of direct jumps and of branches
+        // predicted taken, and corrects the predicted target of the inst
+        from_decode = true;
+        fi.mispred = false;
+    } else if (si->isReturn() && !si->isNonSpeculative() && !pred_taken &&
+               bpu->getPreservedReturnAddr(fi.fsqId) == inst.npc) {
+        // unpredicted return resteered by decode from the RAS. If the RAS
+        // is wrong too, execute is left to redirect instead of both
+        from_decode = true;
+        fi.mispred = false;
+    }
+
+    redirect.valid = true;
+    redirect.fromCommit = !from_decode;
+    redirect.actuallyTaken = actually_taken;
+    redirect.when = curCycle() +
+        (from_decode ? decodeRedirectLatency : executeRedirectLatency);
+    redirect.inst = &fi;
+    return false;
+}
+
+void
+BPReplay::fetch()
+{
+    if (fetchStalled || !traceLeft) {
+        return;
+    }
+    if (!bpu->fetchTargetAvailable()) {
+        bpu->addFtqNotValid();
+        return;
+    }
+
+    for (unsigned n = 0; n < fetchWidth && window.size() < windowSize &&
+                         bpu->fetchTargetAvailable(); n++) {
+        const auto inst = nextInst;
+        panic_if(inst.pc != fetchPC,
+                 "%s: trace goes on at %#lx, fetch is at %#lx\n", name(),
+                 inst.pc, fetchPC);
+
+        window.push_back({inst, staticInstFor(inst.flags),
+                          bpu->getSupplyingStreamId(),
+                          bpu->getSupplyingTargetId(), 0, seqNum++,
+                          curCycle() + commitLatency, false});
+        auto &fi = window.back();
+
+        auto pc = pcStateOf(inst);
+        bool taken, used_up;
+        std::tie(taken, used_up) = bpu->decoupledPredict(
+            fi.staticInst, fi.seqNum, pc, 0, fi.loopIter);
+        fetchPC = pc.instAddr();
+
+        fetchedInsts++;
+        traceLeft = (!maxInsts || fetchedInsts < maxInsts) &&
+                    reader.next(nextInst);
+
+        if (!checkPrediction(fi, fetchPC, taken) || inst.redirect) {
+            // the trace has no wrong path to fetch down
+            fetchStalled = true;
+            break;
+        }
+        if (!traceLeft || (taken && !fetchTargetInLoop) || used_up) {
+            break;
+        }
+    }
+}
+
+void
+BPReplay::finish()
+{
+    if (done) {
+        return;
+    }
+    done = true;
+    inform("%s: replayed %lu instructions of %s\n", name(), fetchedInsts,
+           params().trace);
+    if (--running == 0) {
+        exitSimLoop("all branch predictor replays are done");
+    }
+}
+
+BPReplay::BPReplayStats::BPReplayStats(statistics::Group *parent)
+    : statistics::Group(parent),
+      ADD_STAT(cycles, statistics::units::Cycle::get(),
+               "Number of cycles replayed"),
+      ADD_STAT(committedInsts, statistics::units::Count::get(),
+               "Number of instructions committed"),
+      ADD_STAT(committedBranches, statistics::units::Count::get(),
+               "Number of control instructions trained on at commit"),
+      ADD_STAT(decodeRedirects, statistics::units::Count::get(),
+               "Number of mispredictions redirected by decode"),
+      ADD_STAT(executeRedirects, statistics::units::Count::get(),
+               "Number of mispredictions redirected by execute"),
+      ADD_STAT(traps, statistics::units::Count::get(),
+               "Number of discontinuities of the trace squashed as traps"),
+      ADD_STAT(executeRedirectsPKI, statistics::units::Rate<
+                    statistics::units::Count, statistics::units::Count>::get(),
+               "Redirects from execute per thousand instructions",
+               executeRedirects * 1000 / committedInsts),
+      ADD_STAT(ipc, statistics::units::Rate<
+                    statistics::units::Count, statistics::units::Cycle>::get(),
+               "Instructions per cycle of the replay model",
+               committedInsts / cycles)
+{
+}
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
@@ -0,0 +1,148 @@
+#ifndef __CPU_PRED_FTB_BP_REPLAY_HH__
+#define __CPU_PRED_FTB_BP_REPLAY_HH__
+
+#include <atomic>
+#include <deque>
+#include <map>
+
+#include "base/statistics.hh"
+#include "cpu/pred/ftb/cfi_trace.hh"
+#include "cpu/pred/ftb/decoupled_bpred.hh"
+#include "params/BPReplay.hh"
+#include "sim/clocked_object.hh"
+#include "sim/eventq.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/**
+ * Drives a DecoupledBPUWithFTB from a committed control flow trace
+ * (CfiTrace) instead of an O3 core.
+ *
+ * The predictor runs exactly as it does behind fetch: it is ticked every
+ * cycle, fetch consumes its FTQ through decoupledPredict, mispredictions
+ * come back as controlSquash from decode or from execute, traps as
+ * trapSquash, and commit trains it through commitBranch and update. What
+ * is replaced is the core around it, by a fixed latency model:
+ *  - fetch takes up to fetchWidth instructions per cycle from the trace,
+ *    stopping at a predicted taken branch or the end of an FTQ entry;
+ *  - a wrong prediction is found decodeRedirectLatency cycles after
+ *    fetch if decode would catch it, executeRedirectLatency otherwise,
+ *    and fetch stalls until then, as no wrong path is in the trace;
+ *  - instructions commit commitLatency cycles after fetch, commitWidth
+ *    per cycle, with at most windowSize in flight.
+ *
+ * Predictor statistics are therefore computed by the same code as in a
+ * full run, but the timing they see is that of the model, so cycle
+ * sensitive ones (override bubbles, squash latencies) differ from O3.
+ *
+ * Several replays can run in one process, each with its own eventq_index
+ * to run them on separate host threads. The simulation exits when the
+ * last one is done.
+ */
+class BPReplay : public ClockedObject
+{
+  public:
+    PARAMS(BPReplay);
+    BPReplay(const Params &p);
+
+    void startup() override;
+
+  private:
+    /** An instruction between fetch and commit */
+    struct InFlight
+    {
+        CfiTrace::Inst inst;
+        StaticInstPtr staticInst;
+        FetchStreamId fsqId;
+        FetchTargetId ftqId;
+        unsigned loopIter;
+        InstSeqNum seqNum;
+        Cycles commitCycle;
+        bool mispred;
+    };
+
+    /** A pending redirect of fetch by decode or execute */
+    struct Redirect
+    {
+        bool valid{false};
+        bool fromCommit;
+        bool actuallyTaken;
+        Cycles when;
+        InFlight *inst;
+    };
+
+    void tick();
+
+    void applyRedirect();
+    void commit();
+    void fetch();
+
+    /**
+     * Check the prediction of a fetched instruction, schedule a redirect
+     * if it is wrong. Returns whether it was right.
+     */
+    bool checkPrediction(InFlight &fi, Addr pred_pc, bool pred_taken);
+
+    const StaticInstPtr &staticInstFor(uint8_t flags);
+
+    void finish();
+
+    DecoupledBPUWithFTB *bpu;
+    CfiTraceReader reader;
+
+    const unsigned fetchWidth;
+    const unsigned commitWidth;
+    const unsigned windowSize;
+    const Cycles decodeRedirectLatency;
+    const Cycles executeRedirectLatency;
+    const Cycles commitLatency;
+    const uint64_t maxInsts;
+
+    /** Next instruction of the trace to fetch */
+    CfiTrace::Inst nextInst;
+    bool traceLeft{false};
+    uint64_t fetchedInsts{0};
+
+    Addr fetchPC{0};
+    /** No prediction to follow until a redirect or trap comes back */
+    bool fetchStalled{false};
+    bool fetchTargetInLoop{false};
+    InstSeqNum seqNum{1};
+
+    std::deque<InFlight> window;
+    Redirect redirect;
+
+    std::map<uint8_t, StaticInstPtr> staticInsts;
+
+    bool done{false};
+    EventFunctionWrapper tickEvent;
+
+    /** Replays that have not finished yet, over all threads */
+    static std::atomic<unsigned> running;
+
+    struct BPReplayStats : public statistics::Group
+    {
+        BPReplayStats(statistics::Group *parent);
+
+        statistics::Scalar cycles;
+        statistics::Scalar committedInsts;
+        statistics::Scalar committedBranches;
+        statistics::Scalar decodeRedirects;
+        statistics::Scalar executeRedirects;
+        statistics::Scalar traps;
+        statistics::Formula executeRedirectsPKI;
+        statistics::Formula ipc;
+    } stats;
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_BP_REPLAY_HH__
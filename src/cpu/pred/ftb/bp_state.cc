@@ -0,0 +1,112 @@
+#include "cpu/pred/ftb/bp_state.hh"
+
+#include <cstring>
+
+#include "base/cprintf.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+constexpr char BPState::magic[9];
+
+BPStateOut::BPStateOut(const std::string &path)
+    : path(path)
+{
+    bool gz = path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+    file = gzopen(path.c_str(), gz ? "wb" : "wbT");
+    fatal_if(!file, "Cannot open predictor state %s for writing\n", path);
+    write(BPState::magic, 8);
+}
+
+BPStateOut::~BPStateOut()
+{
+    gzclose(file);
+}
+
+void
+BPStateOut::write(const void *buf, unsigned len)
+{
+    fatal_if(gzwrite(file, buf, len) != (int)len,
+             "Failed to write predictor state %s\n", path);
+}
+
+void
+BPStateOut::section(const std::string &name,
+                    const std::vector<uint64_t> &geometry)
+{
+    put((uint32_t)name.size());
+    write(name.data(), name.size());
+    put((uint32_t)geometry.size());
+    for (auto dim : geometry) {
+        put(dim);
+    }
+}
+
+BPStateIn::BPStateIn(const std::string &path)
+    : path(path)
+{
+    file = gzopen(path.c_str(), "rb");
+    fatal_if(!file, "Cannot open predictor state %s\n", path);
+
+    char buf[8];
+    fatal_if(gzread(file, buf, 8) != 8 || memcmp(buf, BPState::magic, 8),
+             "%s is not a predictor state file\n", path);
+}
+
+BPStateIn::~BPStateIn()
+{
+    gzclose(file);
+}
+
+void
+BPStateIn::read(void *buf, unsigned len)
+{
+    fatal_if(gzread(file, buf, len) != (int)len,
+             "Truncated predictor state %s\n", path);
+}
+
+void
+BPStateIn::section(const std::string &name,
+                   const std::vector<uint64_t> &geometry)
+{
+    uint32_t len;
+    get(len);
+    std::string saved(len, '\0');
+    read(saved.data(), len);
+    fatal_if(saved != name, "%s: expected the state of %s, found %s\n",
+             path, name, saved);
+    curSection = name;
+
+    uint32_t n;
+    get(n);
+    bool same = n == geometry.size();
+    std::string want, found;
+    auto dim = geometry.begin();
+    for (uint32_t i = 0; i < n; i++) {
+        uint64_t val;
+        get(val);
+        found += csprintf(" %lu", val);
+        same = same && dim != geometry.end() && *dim++ == val;
+    }
+    for (auto d : geometry) {
+        want += csprintf(" %lu", d);
+    }
+    fatal_if(!same, "%s: %s was saved with geometry%s, the predictor "
+             "has%s\n", path, name, found, want);
+}
+
+bool
+BPStateIn::atEnd()
+{
+    char c;
+    return gzread(file, &c, 1) == 0;
+}
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
@@ -0,0 +1,134 @@
+#ifndef __CPU_PRED_FTB_BP_STATE_HH__
+#define __CPU_PRED_FTB_BP_STATE_HH__
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "base/logging.hh"
+#include "sim/byteswap.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/**
+ * Trained state of the FTB predictors, the "warm state" of
+ * DecoupledBPUWithFTB, in a compact binary file.
+ *
+ *   header:  "XSBPS001"
+ *   section: u32 name length, name, u32 n, n x u64 geometry, data
+ *
+ * Every predictor writes one section, named after it and opened with
+ * the geometry its tables were built with. Loading checks both, so a
+ * file only loads into a predictor of the same configuration. Integers
+ * are little endian and take sizeof their type, vectors are prefixed
+ * with their u64 size. Files ending in .gz are gzip compressed.
+ */
+struct BPState
+{
+    static constexpr char magic[9] = "XSBPS001";
+};
+
+class BPStateOut
+{
+  public:
+    explicit BPStateOut(const std::string &path);
+    ~BPStateOut();
+
+    BPStateOut(const BPStateOut &) = delete;
+    BPStateOut &operator=(const BPStateOut &) = delete;
+
+    void section(const std::string &name,
+                 const std::vector<uint64_t> &geometry);
+
+    template <typename T>
+    void
+    put(T val)
+    {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                      "only integers are saved as they are");
+        uint64_t le = htole((uint64_t)val);
+        write(&le, sizeof(T));
+    }
+
+    template <typename T>
+    void
+    put(const std::vector<T> &vals)
+    {
+        put((uint64_t)vals.size());
+        for (const auto &val : vals) {
+            put(val);
+        }
+    }
+
+  private:
+    void write(const void *buf, unsigned len);
+
+    const std::string path;
+    gzFile file;
+};
+
+class BPStateIn
+{
+  public:
+    explicit BPStateIn(const std::string &path);
+    ~BPStateIn();
+
+    BPStateIn(const BPStateIn &) = delete;
+    BPStateIn &operator=(const BPStateIn &) = delete;
+
+    /** Fatal unless the next section was saved with the same geometry */
+    void section(const std::string &name,
+                 const std::vector<uint64_t> &geometry);
+
+    template <typename T>
+    void
+    get(T &val)
+    {
+        static_assert(std::is_integral_v<T> || std::is_enum_v<T>,
+                      "only integers are saved as they are");
+        uint64_t le = 0;
+        read(&le, sizeof(T));
+        val = (T)letoh(le);
+    }
+
+    /** Vectors keep the size the configuration gave them */
+    template <typename T>
+    void
+    get(std::vector<T> &vals)
+    {
+        uint64_t size;
+        get(size);
+        fatal_if(size != vals.size(), "%s: %s has %lu elements, the "
+                 "predictor %lu\n", path, curSection, size, vals.size());
+        for (auto &val : vals) {
+            get(val);
+        }
+    }
+
+    /** Everything in the file has been read */
+    bool atEnd();
+
+    const std::string &name() const { return curSection; }
+
+  private:
+    void read(void *buf, unsigned len);
+
+    const std::string path;
+    gzFile file;
+    std::string curSection;
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_BP_STATE_HH__
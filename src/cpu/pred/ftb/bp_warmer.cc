@@ -0,0 +1,117 @@
+#include "cpu/pred/ftb/bp_warmer.hh"
+
+#include "base/logging.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+void
+BPWarmer::redirect(Addr target)
+{
+    // the last committed instruction is where the stream breaks
+    RiscvISA::PCState target_pc(target);
+    bpu->trapSquash(ftqId, fsqId, pc.instAddr(), target_pc, 0, loopIter);
+    expectPC = target;
+}
+
+void
+BPWarmer::fetch(const StaticInstPtr &static_inst, const PCStateBase &cur_pc)
+{
+    Addr addr = cur_pc.instAddr();
+    if (!started) {
+        bpu->resetPC(addr);
+        started = true;
+    } else if (addr != expectPC) {
+        // interrupt, or a fault of the previous fetch
+        redirect(addr);
+    }
+
+    bpu->trySupplyFetchWithTarget(addr, fetchTargetInLoop);
+    for (unsigned n = 0; !bpu->fetchTargetAvailable(); n++) {
+        panic_if(n == maxTicks, "%s: no fetch target for %#lx after %u "
+                 "ticks\n", bpu->name(), addr, maxTicks);
+        if (bpu->enableTwoTaken) {
+            bpu->ideal_tick();
+        } else {
+            bpu->tick();
+        }
+        bpu->trySupplyFetchWithTarget(addr, fetchTargetInLoop);
+    }
+
+    inst = static_inst;
+    pc = cur_pc.as<RiscvISA::PCState>();
+    fsqId = bpu->getSupplyingStreamId();
+    ftqId = bpu->getSupplyingTargetId();
+
+    RiscvISA::PCState pred_pc = pc;
+    bool used_up;
+    std::tie(predTaken, used_up) = bpu->decoupledPredict(
+        inst, seqNum, pred_pc, 0, loopIter);
+    predPC = pred_pc.instAddr();
+    pending = true;
+}
+
+void
+BPWarmer::commit(const PCStateBase &next_pc, bool faulted)
+{
+    if (!pending) {
+        // fetch faulted, the next fetch sees the jump to the handler
+        return;
+    }
+    pending = false;
+
+    Addr npc = next_pc.instAddr();
+    if (faulted) {
+        redirect(npc);
+        seqNum++;
+        return;
+    }
+
+    Addr fall_thru = pc.getFallThruPC();
+    bool taken = npc != fall_thru;
+    bool mispred = npc != predPC;
+    if (mispred) {
+        RiscvISA::PCState target(npc);
+        // a non-control predicted taken goes on as if it jumped
+        bpu->controlSquash(ftqId, fsqId, pc, target, inst,
+                           fall_thru - pc.instAddr(),
+                           inst->isControl() ? taken : true, seqNum, 0,
+                           loopIter, true);
+    }
+
+    CommittedInst ci{pc.instAddr(), npc, fall_thru, taken, inst, fsqId};
+    // as in commit, xret is not trained on
+    if (inst->isControl() && !inst->isNonSpeculative()) {
+        bpu->commitBranch(ci, mispred);
+    }
+    bpu->notifyInstCommit(ci);
+    if (fsqId > 1) {
+        bpu->update(fsqId - 1, 0);
+    }
+
+    expectPC = npc;
+    seqNum++;
+}
+
+void
+BPWarmer::switchOut()
+{
+    if (!started) {
+        return;
+    }
+    // leave nothing predicted beyond the committed path, the next CPU
+    // only resets the pc of the predictor
+    panic_if(pending, "%s: switched out with an instruction in flight\n",
+             bpu->name());
+    redirect(expectPC);
+    started = false;
+}
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
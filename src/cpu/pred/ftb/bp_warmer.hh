@@ -0,0 +1,77 @@
+#ifndef __CPU_PRED_FTB_BP_WARMER_HH__
+#define __CPU_PRED_FTB_BP_WARMER_HH__
+
+#include "arch/riscv/pcstate.hh"
+#include "cpu/pred/ftb/decoupled_bpred.hh"
+#include "cpu/static_inst.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/**
+ * Trains a DecoupledBPUWithFTB from a CPU that executes one instruction at
+ * a time, as the simple CPUs used for functional warmup do.
+ *
+ * Every instruction is fetched through the FTQ as O3 fetch would, with the
+ * predictor ticked until it supplies a target, and committed right after
+ * execution. A wrong prediction is squashed from commit at once, a
+ * discontinuity that is no control instruction (fault, interrupt) as a
+ * trap. No wrong path is ever fetched, so the predictor tables, history and
+ * RAS see the committed path only.
+ */
+class BPWarmer
+{
+  public:
+    explicit BPWarmer(DecoupledBPUWithFTB *bpu) : bpu(bpu) {}
+
+    /** Before executing static_inst at cur_pc */
+    void fetch(const StaticInstPtr &static_inst, const PCStateBase &cur_pc);
+
+    /**
+     * After executing the instruction of the last fetch, next_pc being
+     * where the CPU goes on, the handler if it faulted.
+     */
+    void commit(const PCStateBase &next_pc, bool faulted);
+
+    /**
+     * Squash everything in flight so that another CPU can take over the
+     * predictor at the next pc.
+     */
+    void switchOut();
+
+  private:
+    void redirect(Addr target);
+
+    DecoupledBPUWithFTB *bpu;
+
+    bool started{false};
+    /** Fetched and not committed yet */
+    bool pending{false};
+
+    StaticInstPtr inst;
+    RiscvISA::PCState pc;
+    Addr predPC{0};
+    bool predTaken{false};
+    FetchStreamId fsqId{0};
+    FetchTargetId ftqId{0};
+    unsigned loopIter{0};
+    InstSeqNum seqNum{1};
+
+    /** Where the committed path goes on, checked at the next fetch */
+    Addr expectPC{0};
+    bool fetchTargetInLoop{false};
+
+    /** Ticks to wait for a fetch target before giving up */
+    static constexpr unsigned maxTicks = 1000;
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_BP_WARMER_HH__
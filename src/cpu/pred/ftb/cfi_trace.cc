@@ -0,0 +1,207 @@
+#include "cpu/pred/ftb/cfi_trace.hh"
+
+#include <cstring>
+
+#include "base/logging.hh"
+#include "sim/byteswap.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+constexpr char CfiTrace::magic[9];
+
+CfiTraceWriter::CfiTraceWriter(const std::string &path)
+    : path(path)
+{
+    bool gz = path.size() > 3 && path.compare(path.size() - 3, 3, ".gz") == 0;
+    // 'T' writes without compression through the same interface
+    file = gzopen(path.c_str(), gz ? "wb" : "wbT");
+    fatal_if(!file, "Cannot open control flow trace %s for writing\n",
+             path.c_str());
+}
+
+CfiTraceWriter::~CfiTraceWriter()
+{
+    if (started && expectPC != runStart) {
+        writeRecord(expectPC, expectPC, CfiTrace::End);
+    }
+    gzclose(file);
+}
+
+void
+CfiTraceWriter::write(const void *buf, unsigned len)
+{
+    fatal_if(gzwrite(file, buf, len) != (int)len,
+             "Failed to write control flow trace %s\n", path.c_str());
+}
+
+void
+CfiTraceWriter::writeRecord(Addr end, Addr target, uint8_t flags)
+{
+    uint64_t end_le = htole((uint64_t)end);
+    uint64_t target_le = htole((uint64_t)target);
+    write(&end_le, sizeof(end_le));
+    write(&target_le, sizeof(target_le));
+    write(&flags, sizeof(flags));
+
+    unsigned parcels = (end - runStart) / 2;
+    bitmap.resize((parcels + 7) / 8, 0);
+    if (!bitmap.empty()) {
+        write(bitmap.data(), bitmap.size());
+    }
+    bitmap.clear();
+}
+
+void
+CfiTraceWriter::commit(const CommittedInst &inst)
+{
+    if (!started) {
+        write(CfiTrace::magic, 8);
+        uint64_t start_le = htole((uint64_t)inst.pc);
+        write(&start_le, sizeof(start_le));
+        runStart = expectPC = inst.pc;
+        started = true;
+    }
+
+    if (inst.pc != expectPC) {
+        writeRecord(expectPC, inst.pc, CfiTrace::Redirect);
+        runStart = inst.pc;
+    }
+
+    unsigned parcel = (inst.pc - runStart) / 2;
+    if (bitmap.size() <= parcel / 8) {
+        bitmap.resize(parcel / 8 + 1, 0);
+    }
+    bitmap[parcel / 8] |= 1 << (parcel % 8);
+
+    const auto &static_inst = inst.staticInst;
+    if (static_inst->isControl()) {
+        uint8_t flags = 0;
+        flags |= static_inst->isCondCtrl() ? CfiTrace::Cond : 0;
+        flags |= static_inst->isIndirectCtrl() ? CfiTrace::Indirect : 0;
+        flags |= static_inst->isCall() ? CfiTrace::Call : 0;
+        flags |= static_inst->isReturn() ? CfiTrace::Return : 0;
+        flags |= static_inst->isNonSpeculative() ? CfiTrace::NonSpec : 0;
+        writeRecord(inst.fallThruPC, inst.npc, flags);
+        runStart = expectPC = inst.npc;
+    } else {
+        expectPC = inst.fallThruPC;
+    }
+}
+
+CfiTraceReader::CfiTraceReader(const std::string &path)
+    : path(path)
+{
+    file = gzopen(path.c_str(), "rb");
+    fatal_if(!file, "Cannot open control flow trace %s\n", path.c_str());
+
+    char buf[8];
+    uint64_t start_le;
+    fatal_if(!read(buf, 8) || memcmp(buf, CfiTrace::magic, 8) != 0 ||
+             !read(&start_le, sizeof(start_le)),
+             "%s is not a control flow trace\n", path.c_str());
+    _startPC = runStart = letoh(start_le);
+}
+
+CfiTraceReader::~CfiTraceReader()
+{
+    gzclose(file);
+}
+
+bool
+CfiTraceReader::read(void *buf, unsigned len)
+{
+    int n = gzread(file, buf, len);
+    if (n == 0 && gzeof(file)) {
+        return false;
+    }
+    fatal_if(n != (int)len, "Truncated control flow trace %s\n", path.c_str());
+    return true;
+}
+
+bool
+CfiTraceReader::readRecord()
+{
+    uint64_t end_le, target_le;
+    uint8_t flags;
+    if (!read(&end_le, sizeof(end_le))) {
+        return false;
+    }
+    fatal_if(!read(&target_le, sizeof(target_le)) || !read(&flags, 1),
+             "Truncated control flow trace %s\n", path.c_str());
+    Addr end = letoh(end_le);
+    Addr target = letoh(target_le);
+    fatal_if(end < runStart || (end - runStart) % 2,
+             "Bad run [%#lx, %#lx) in control flow trace %s\n", runStart,
+             end, path.c_str());
+
+    unsigned parcels = (end - runStart) / 2;
+    bitmap.resize((parcels + 7) / 8);
+    fatal_if(!bitmap.empty() && !read(bitmap.data(), bitmap.size()),
+             "Truncated control flow trace %s\n", path.c_str());
+    records++;
+
+    bool redirect = flags & CfiTrace::Redirect;
+    if (parcels == 0) {
+        fatal_if(!redirect, "Empty run before a control instruction in %s\n",
+                 path.c_str());
+        // trap right at a branch target, the branch is still held back
+        if (!pending.empty()) {
+            pending.back().redirect = true;
+            pending.back().redirectPC = target;
+        }
+        runStart = target;
+        return true;
+    }
+
+    fatal_if(!(bitmap[0] & 1), "Run at %#lx of %s does not start with an "
+             "instruction\n", runStart, path.c_str());
+    for (unsigned p = 0; p < parcels;) {
+        unsigned size = 1;
+        while (p + size < parcels &&
+               !(bitmap[(p + size) / 8] & (1 << ((p + size) % 8)))) {
+            size++;
+        }
+        fatal_if(size != 1 && size != 2, "Bad instruction size at %#lx "
+                 "in %s\n", runStart + p * 2, path.c_str());
+        Addr pc = runStart + p * 2;
+        pending.push_back({pc, pc + size * 2, (uint8_t)(size * 2), 0, false, 0});
+        p += size;
+    }
+
+    auto &last = pending.back();
+    if (flags & CfiTrace::End) {
+        eof = true;
+    } else if (redirect) {
+        last.redirect = true;
+        last.redirectPC = target;
+    } else {
+        last.npc = target;
+        last.flags = flags;
+    }
+    runStart = target;
+    return true;
+}
+
+bool
+CfiTraceReader::next(CfiTrace::Inst &inst)
+{
+    while (!eof && pending.size() < 2) {
+        eof |= !readRecord();
+    }
+    if (pending.empty()) {
+        return false;
+    }
+    inst = pending.front();
+    pending.pop_front();
+    return true;
+}
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
@@ -0,0 +1,143 @@
+#ifndef __CPU_PRED_FTB_CFI_TRACE_HH__
+#define __CPU_PRED_FTB_CFI_TRACE_HH__
+
+#include <zlib.h>
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "base/types.hh"
+#include "cpu/pred/ftb/stream_struct.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/**
+ * Committed control flow trace, the input of BPReplay.
+ *
+ * The trace only records where the committed path leaves straight line
+ * code, plus the instruction boundaries in between, which is all the
+ * predictors need. Multi-byte fields are little endian.
+ *
+ *   header: "XSCFI001", u64 startPC
+ *   record: u64 end, u64 target, u8 flags, bitmap
+ *
+ * A record covers the run of instructions in [runStart, end), where
+ * runStart is startPC for the first record and the target of the
+ * previous record after that. The bitmap has one bit per 16-bit parcel
+ * of the run, (end - runStart) / 2 bits rounded up to whole bytes, bit
+ * i % 8 of byte i / 8 set if parcel i starts an instruction.
+ *
+ * Unless flags has Redirect, the last instruction of the run is a
+ * control instruction of the kind flags describe, and target is where it
+ * went, taken or not. Redirect marks a discontinuity that is no control
+ * instruction (trap, interrupt, xret), target being the next committed
+ * pc. Its run may be empty. End marks the straight line code the trace
+ * ends with, target is meaningless.
+ *
+ * Files ending in .gz are gzip compressed, any file is read through zlib
+ * so compressed or not does not matter to the reader.
+ */
+struct CfiTrace
+{
+    static constexpr char magic[9] = "XSCFI001";
+
+    enum Flags : uint8_t
+    {
+        Cond = 1,
+        Indirect = 2,
+        Call = 4,
+        Return = 8,
+        NonSpec = 16,
+        Redirect = 32,
+        End = 64,
+    };
+
+    /** One committed instruction read back from a trace */
+    struct Inst
+    {
+        Addr pc;
+        Addr npc;
+        uint8_t size;
+        /** Flags of the record for its control instruction, else 0 */
+        uint8_t flags;
+        /** Last instruction before a Redirect, and where it went */
+        bool redirect;
+        Addr redirectPC;
+    };
+};
+
+/** Writes the committed path of a core as a CfiTrace */
+class CfiTraceWriter
+{
+  public:
+    explicit CfiTraceWriter(const std::string &path);
+    ~CfiTraceWriter();
+
+    CfiTraceWriter(const CfiTraceWriter &) = delete;
+    CfiTraceWriter &operator=(const CfiTraceWriter &) = delete;
+
+    /** Call for every committed instruction, in commit order */
+    void commit(const CommittedInst &inst);
+
+  private:
+    void write(const void *buf, unsigned len);
+    void writeRecord(Addr end, Addr target, uint8_t flags);
+
+    const std::string path;
+    gzFile file;
+    bool started{false};
+    Addr runStart{0};
+    /** Where the committed path goes next if it does not jump */
+    Addr expectPC{0};
+    std::vector<uint8_t> bitmap;
+};
+
+/** Reads a CfiTrace back one instruction at a time */
+class CfiTraceReader
+{
+  public:
+    explicit CfiTraceReader(const std::string &path);
+    ~CfiTraceReader();
+
+    CfiTraceReader(const CfiTraceReader &) = delete;
+    CfiTraceReader &operator=(const CfiTraceReader &) = delete;
+
+    Addr startPC() const { return _startPC; }
+
+    /** False at the end of the trace */
+    bool next(CfiTrace::Inst &inst);
+
+    uint64_t numRecords() const { return records; }
+
+  private:
+    bool read(void *buf, unsigned len);
+    bool readRecord();
+
+    const std::string path;
+    gzFile file;
+    Addr _startPC{0};
+    Addr runStart{0};
+    uint64_t records{0};
+    bool eof{false};
+
+    /**
+     * Decoded but not yet returned instructions. One is held back until
+     * the next record is read, which may be an empty Redirect for it.
+     */
+    std::deque<CfiTrace::Inst> pending;
+    std::vector<uint8_t> bitmap;
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_CFI_TRACE_HH__
@@ -29,6 +29,7 @@ DecoupledBPUWithFTB::DecoupledBPUWithFTB(const DecoupledBPUWithFTBParams &p)
       enableJumpAheadPredictor(p.enableJumpAheadPredictor),
       enableTwoTaken(p.enableTwoTaken),
       fetchTargetQueue(p.ftq_size),
+      fetchStreamQueue(p.fsq_size),
       fetchStreamQueueSize(p.fsq_size),
       numBr(p.numBr),
       predictWidth(p.predictWidth),
@@ -45,7 +46,22 @@ DecoupledBPUWithFTB::DecoupledBPUWithFTB(const DecoupledBPUWithFTBParams &p)
       historyManager(p.numBr),
       dbpFtbStats(this, p.numStages, p.fsq_size)
 {
+    // shared by every BPU in the process
+    static bool predictWidthSet = false;
+    fatal_if(predictWidthSet && ftb_pred::predictWidth != p.predictWidth,
+             "All DecoupledBPUWithFTB instances must have the same predictWidth\n");
+    predictWidthSet = true;
     gem5::branch_prediction::ftb_pred::predictWidth = p.predictWidth;
+    if (!p.cfiTrace.empty()) {
+        cfiTrace = std::make_unique<CfiTraceWriter>(simout.resolve(p.cfiTrace));
+        // SimObjects outlive the simulation, flush the trace on exit
+        registerExitCallback([this]() { cfiTrace.reset(); });
+    }
+    warmStateIn = p.warmStateIn;
+    if (!p.warmStateOut.empty()) {
+        warmStateOut = simout.resolve(p.warmStateOut);
+        registerExitCallback([this]() { saveState(warmStateOut); });
+    }
     if (bpDBSwitches.size() > 0) {
         
         bpdb.init_db();
@@ -133,10 +149,13 @@ DecoupledBPUWithFTB::DecoupledBPUWithFTB(const DecoupledBPUWithFTBParams &p)
 
     s0PC = 0x80000000;
 
-    s0History.resize(historyBits, 0);
+    fatal_if(historyBits > PackedHist::maxBits,
+             "maxHistLen %u exceeds the %u bits of global history\n",
+             historyBits, PackedHist::maxBits);
+    s0History.resize(historyBits);
     fetchTargetQueue.setName(name());
 
-    commitHistory.resize(historyBits, 0);
+    commitHistory.resize(historyBits);
     squashing = true;
 
     lp = LoopPredictor(16, 4, enableLoopDB);
@@ -147,289 +166,16 @@ DecoupledBPUWithFTB::DecoupledBPUWithFTB(const DecoupledBPUWithFTBParams &p)
     if (!enableLoopPredictor && enableLoopBuffer) {
         fatal("loop buffer cannot be enabled without loop predictor\n");
     }
-    commitFsqEntryHasInstsVector.resize(16+1, 0);
-    lastPhaseFsqEntryNumCommittedInstDist.resize(16+1, 0);
-    commitFsqEntryFetchedInstsVector.resize(16+1, 0);
-    lastPhaseFsqEntryNumFetchedInstDist.resize(16+1, 0);
+    if (p.enableProfiling) {
+        profiler = std::make_unique<BPProfiler>(
+            numBr, p.profilingSamplePeriod, p.profilingTopK,
+            p.profilingPhaseSize, p.profilingSubPhaseRatio);
+    }
 
     registerExitCallback([this]() {
-        auto out_handle = simout.create("topMisPredicts.txt", false, true);
-        *out_handle->stream() << "startPC" << " " << "control pc" << " " << "count" << std::endl;
-        std::vector<std::pair<std::pair<Addr, Addr>, int>> topMisPredPC;
-        for (auto &it : topMispredicts) {
-            topMisPredPC.push_back(it);
-        }
-        std::sort(topMisPredPC.begin(), topMisPredPC.end(), [](const std::pair<std::pair<Addr, Addr>, int> &a, const std::pair<std::pair<Addr, Addr>, int> &b) {
-            return a.second > b.second;
-        });
-        for (auto& it : topMisPredPC) {
-            *out_handle->stream() << std::hex << it.first.first << " " << it.first.second << " " << std::dec << it.second << std::endl;
-        }
-        simout.close(out_handle);
-
-        // at a per branch basis
-        out_handle = simout.create("topMispredictsByBranch.txt", false, true);
-        std::vector<std::tuple<Addr, int, int, int, double, int, int, int>> topMisPredPCByBranch;
-        *out_handle->stream() << "pc" << " " << "type" << " " << "mispredicts" << " " << "total" << " " << "misPermil" << " " << "dirMiss" << " " << "tgtMiss" << " " << "noPredMiss" << std::endl;
-        for (auto &it : topMispredictsByBranch) {
-            topMisPredPCByBranch.push_back(std::make_tuple(
-                it.first.first, it.first.second, it.second.first.first, it.second.second,
-                (double)(it.second.first.first * 1000) / (double)it.second.second,
-                it.second.first.second.at(DIR_WRONG), it.second.first.second.at(TARGET_WRONG), it.second.first.second.at(NO_PRED)));
-        }
-        std::sort(topMisPredPCByBranch.begin(), topMisPredPCByBranch.end(), [](
-            const std::tuple<Addr, int, int, int, double, int, int, int> &a,
-            const std::tuple<Addr, int, int, int, double, int, int, int> &b) {
-                return std::get<2>(a) > std::get<2>(b);
-        });
-        for (auto& it : topMisPredPCByBranch) {
-            *out_handle->stream() << std::hex << std::get<0>(it) << std::dec << " " << std::get<1>(it) << " " << std::get<2>(it) << " " << std::get<3>(it);
-            *out_handle->stream() << " " << (int)std::get<4>(it) << " " << (int)std::get<5>(it) << " " << (int)std::get<6>(it) << " " << (int)std::get<7>(it) << std::endl;
-        }
-        simout.close(out_handle);
-
-        // top misrate branches
-        out_handle = simout.create("topMisrateByBranch.txt", false, true);
-        // sort by misrate (permil), filter by total count
-        *out_handle->stream() << "pc" << " " << "type" << " " << "mispredicts" << " " << "total" << " " << "misPermil" << " " << "dirMiss" << " " << "tgtMiss" << " " << "noPredMiss" << std::endl;
-        std::sort(topMisPredPCByBranch.begin(), topMisPredPCByBranch.end(), [](
-            const std::tuple<Addr, int, int, int, double, int, int, int> &a,
-            const std::tuple<Addr, int, int, int, double, int, int, int> &b) {
-                return std::get<4>(a) > std::get<4>(b);
-        });
-
-        int mispCntThres = 100;
-        for (auto& it : topMisPredPCByBranch) {
-            if (std::get<3>(it) < mispCntThres) {
-                continue;
-            }
-            *out_handle->stream() << std::hex << std::get<0>(it) << std::dec << " " << std::get<1>(it) << " " << std::get<2>(it) << " " << std::get<3>(it);
-            *out_handle->stream() << " " << (int)std::get<4>(it) << " " << (int)std::get<5>(it) << " " << (int)std::get<6>(it) << " " << (int)std::get<7>(it) << std::endl;
-        }
-        simout.close(out_handle);
-
-        int phaseID = 0;
-        int outputTopN = 5;
-        out_handle = simout.create("topMispredictByPhase.txt", false, true);
-        *out_handle->stream() << "phaseID" << " " << "numBranches" << " " << "numEverTakenBranches" << " " << "totalMispredicts";
-        for (int i = 0; i < outputTopN; i++) {
-            *out_handle->stream() << " " << "topMispPC_" << i;
-            *out_handle->stream() << " " << "type_" << i;
-            *out_handle->stream() << " " << "misCnt_" << i;
-            // *out_handle->stream() << " " << "topReason" << i;
-        }
-        *out_handle->stream()<< std::endl;
-        for (auto& it : topMispredictsByBranchByPhase) {
-            int numStaticBranches = it.size();
-            int numEverTakenStaticBranches = takenBranchesByPhase[phaseID].size();
-            int totalMispredicts = 0;
-            std::vector<MispredRecord> temp;
-            for (auto& it2 : it) {
-                temp.push_back(it2);
-            }
-            for (auto& it2 : temp) {
-                totalMispredicts += getMispredCount(it2);
-            }
-            *out_handle->stream() << phaseID << " " << numStaticBranches << " " << numEverTakenStaticBranches << " " << totalMispredicts;
-            // sort by mispredicts
-            std::sort(temp.begin(), temp.end(), [&](const MispredRecord &a, const MispredRecord &b) {
-                return gem5::branch_prediction::ftb_pred::DecoupledBPUWithFTB::getMispredCount(a) >
-                gem5::branch_prediction::ftb_pred::DecoupledBPUWithFTB::getMispredCount(b);
-            });
-            for (int i = 0; i < outputTopN && i < temp.size(); i++) {
-                *out_handle->stream() << " " << std::hex << temp[i].first.first; // pc
-                *out_handle->stream() << " " << std::dec << temp[i].first.second; // type
-                *out_handle->stream() << " " << std::dec << getMispredCount(temp[i]); // mispred count
-                // *out_handle->stream() << " " << temp[i].first.first;
-            }
-            *out_handle->stream() << std::dec << std::endl;
-            phaseID++;
-        }
-        simout.close(out_handle);
-
-        phaseID = 0;
-        out_handle = simout.create("topMispredictBySubPhase.txt", false, true);
-        *out_handle->stream() << "subPhaseID" << " " << "numBranches" << " " << "numEverTakenBranches" << " " << "totalMispredicts";
-        for (int i = 0; i < outputTopN; i++) {
-            *out_handle->stream() << " " << "topMispPC_" << i;
-            *out_handle->stream() << " " << "type_" << i;
-            *out_handle->stream() << " " << "misCnt_" << i;
-        }
-        *out_handle->stream()<< std::endl;
-        for (auto& it : topMispredictsByBranchBySubPhase) {
-            int numStaticBranches = it.size();
-            int numEverTakenStaticBranches = takenBranchesBySubPhase[phaseID].size();
-            int totalMispredicts = 0;
-            std::vector<MispredRecord> temp;
-            for (auto& it2 : it) {
-                temp.push_back(it2);
-            }
-            for (auto& it2 : temp) {
-                totalMispredicts += getMispredCount(it2);
-            }
-            *out_handle->stream() << phaseID << " " << numStaticBranches << " " << numEverTakenStaticBranches << " " << totalMispredicts;
-            // sort by mispredicts
-            std::sort(temp.begin(), temp.end(), [&](const MispredRecord &a, const MispredRecord &b) {
-                return gem5::branch_prediction::ftb_pred::DecoupledBPUWithFTB::getMispredCount(a) >
-                gem5::branch_prediction::ftb_pred::DecoupledBPUWithFTB::getMispredCount(b);
-            });
-            *out_handle->stream() << std::hex;
-            for (int i = 0; i < outputTopN && i < temp.size(); i++) {
-                *out_handle->stream() << " " << std::hex << temp[i].first.first; // pc
-                *out_handle->stream() << " " << std::dec << temp[i].first.second; // type
-                *out_handle->stream() << " " << std::dec << getMispredCount(temp[i]); // mispred count
-                // *out_handle->stream() << " " << temp[i].first.first;
-            }
-            *out_handle->stream() << std::dec << std::endl;
-            phaseID++;
-        }
-        simout.close(out_handle);
-
-
-        out_handle = simout.create("topMisPredictHist.txt", false, true);
-        // *out_handle->stream() << "use loop but invalid: " << useLoopButInvalid 
-        //                       << " use loop and valid: " << useLoopAndValid 
-        //                       << " not use loop: " << notUseLoop << std::endl;
-        *out_handle->stream() << "Hist" << " " << "count" << std::endl;
-        std::vector<std::pair<uint64_t, uint64_t>> topMisPredHistVec;
-        for (const auto &entry: topMispredHist) {
-            topMisPredHistVec.push_back(entry);
-        }
-        std::sort(topMisPredHistVec.begin(), topMisPredHistVec.end(),
-                  [](const std::pair<uint64_t, uint64_t> &a,
-                     const std::pair<uint64_t, uint64_t> &b) {
-                      return a.second > b.second;
-                  });
-        for (const auto &entry: topMisPredHistVec) {
-            *out_handle->stream() << std::hex << entry.first << " " << std::dec << entry.second << std::endl;
-        }
-
-        // if (dumpLoopPred) {
-        //     out_handle = simout.create("misPredTripCount.txt", false, true);
-        //     *out_handle->stream() << missCount << std::endl;
-        //     for (const auto &entry : misPredTripCount) {
-        //         *out_handle->stream()
-        //             << entry.first << " " << entry.second << std::endl;
-        //     }
-
-        //     out_handle = simout.create("loopInfo.txt", false, true);
-        //     for (const auto &entry : storedLoopStreams) {
-        //         bool misPred = entry.second.squashType == SQUASH_CTRL;
-        //         *out_handle->stream()
-        //             << std::dec << "miss: " << misPred << " " << entry.first << " "
-        //             << std::hex << entry.second.startPC << ", "
-        //             << (misPred ? entry.second.exeBranchPC
-        //                         : entry.second.predBranchPC)
-        //             << "--->"
-        //             << (misPred ? entry.second.exeTarget : entry.second.predTarget)
-        //             << std::dec
-        //             << " useLoopPred: " << entry.second.useLoopPrediction
-        //             << " tripCount: " << entry.second.tripCount << std::endl;
-        //     }
-        // }
-
-        // out_handle = simout.create("targets.txt", false, true);
-        // for (const auto it : storeTargets) {
-        //     *out_handle->stream() << std::hex << it << std::endl;
-        // }
-
-        out_handle = simout.create("misPredIndirectStream.txt", false, true);
-        std::vector<std::pair<Addr, unsigned>> tempVec;
-        for (auto &it : topMispredIndirect) {
-            tempVec.push_back(std::make_pair(it.first, it.second));
-        }
-        std::sort(tempVec.begin(), tempVec.end(),
-            [](const std::pair<Addr, unsigned> &a,
-               const std::pair<Addr, unsigned> &b) {
-                return a.second > b.second;
-            });
-        for (auto it : tempVec) {
-            *out_handle->stream() << std::oct << it.second << " " << std::hex << it.first << std::endl;
-        }
-
-        simout.close(out_handle);
-
-        // dump fsq entry committed insts
-        out_handle = simout.create("fsqEntryCommittedInstNumDistsByPhase.txt", false, true);
-        *out_handle->stream() << "phaseID";
-        for (int i = 0; i <= 16; i++) {
-            *out_handle->stream() << " " << i;
-        }
-        *out_handle->stream() << " " << "average" << std::endl;
-
-        phaseID = 0;
-        for (auto& it : fsqEntryNumCommittedInstDistByPhase) {
-            *out_handle->stream() << phaseID;
-            int numFsqEntries = 0;
-            for (int i = 0; i <= 16; i++) {
-                *out_handle->stream() << " " << it[i];
-                numFsqEntries += it[i];
-            }
-            *out_handle->stream() << " " << (double)phaseSizeByInst / (double)numFsqEntries << std::endl;
-            phaseID++;
-        }
-        simout.close(out_handle);
-
-        // dump fsq entry fetched insts
-        out_handle = simout.create("fsqEntryFetchedInstNumDistsByPhase.txt", false, true);
-        *out_handle->stream() << "phaseID";
-        for (int i = 0; i <= 16; i++) {
-            *out_handle->stream() << " " << i;
-        }
-        *out_handle->stream() << " " << "average" << std::endl;
-        phaseID = 0;
-        for (auto& it : fsqEntryNumFetchedInstDistByPhase) {
-            *out_handle->stream() << phaseID;
-            int numFsqEntries = 0;
-            for (int i = 0; i <= 16; i++) {
-                *out_handle->stream() << " " << it[i];
-                numFsqEntries += it[i];
-            }
-            *out_handle->stream() << " " << (double)phaseSizeByInst / (double)numFsqEntries << std::endl;
-            phaseID++;
-        }
-        simout.close(out_handle);
-
-        // dump ftb entries
-        int outputTopNEntries = 1;
-        out_handle = simout.create("ftbEntriesByPhase.txt", false, true);
-        *out_handle->stream() << "phaseID"<< " " << "numFTBEntries";
-        for (int i = 0; i <= outputTopNEntries; i++) {
-            *out_handle->stream() << " " << "entry_" << i << "_pc";
-            for (int n = 0; n < numBr; n++) {
-                *out_handle->stream() << " " << "entry_" << i << "_br_" << n << "_pc";
-                *out_handle->stream() << " " << "entry_" << i << "_br_" << n << "_type";
-            }
-        }
-        *out_handle->stream() << std::endl;
-        phaseID = 0;
-
-        for (auto& it : FTBEntriesByPhase) {
-            *out_handle->stream() << std::dec << phaseID;
-            *out_handle->stream() << " " << it.size();
-            std::vector<std::tuple<Addr, FTBEntry, int>> ftbEntryTempVec;
-            for (auto& rec : it) {
-                ftbEntryTempVec.push_back(std::make_tuple(rec.first, rec.second.first, rec.second.second));
-            }
-            std::sort(ftbEntryTempVec.begin(), ftbEntryTempVec.end(),
-                [](const std::tuple<Addr, FTBEntry, int> &a,
-                const std::tuple<Addr, FTBEntry, int> &b) {
-                    return std::get<2>(a) > std::get<2>(b);
-                });
-            for (int i = 0; i <= outputTopNEntries && i < ftbEntryTempVec.size(); i++) {
-                auto &rec = ftbEntryTempVec[i];
-                *out_handle->stream() << " " << std::hex << std::get<0>(rec);
-                auto &entry = std::get<1>(rec);
-                for (int n = 0; n < numBr; n++) {
-                    auto slot = entry.slots.size() <= n ? FTBSlot() : entry.slots[n];
-                    *out_handle->stream() << " " << slot.pc;
-                    *out_handle->stream() << " " << slot.getType();
-                }
-            }
-            *out_handle->stream() << std::endl;
-            phaseID++;
+        if (profiler) {
+            profiler->dump();
         }
-        simout.close(out_handle);
 
         if (someDBenabled) {
             bpdb.save_db("bp.db");
@@ -590,15 +336,14 @@ DecoupledBPUWithFTB::DBPFTBStats::DBPFTBStats(statistics::Group* parent, unsigne
     ftqEndReasonDist.subname(static_cast<int>(FTQEndReason::LOOP_END), "loop_end");
 }
 
-DecoupledBPUWithFTB::BpTrace::BpTrace(FetchStream &stream, const DynInstPtr &inst, bool mispred)
+DecoupledBPUWithFTB::BpTrace::BpTrace(FetchStream &stream, const CommittedInst &inst, bool mispred)
 {
     _tick = curTick();
-    Addr pc = inst->pcState().instAddr();
-    const auto &rv_pc = inst->pcState().as<RiscvISA::PCState>();
-    Addr target = rv_pc.npc();
-    Addr fallThru = rv_pc.getFallThruPC();
-    BranchInfo info(pc, target, inst->staticInst, fallThru-pc);
-    set(stream.startPC, pc, info.getType(), inst->branching(), mispred, fallThru, stream.predSource, target);
+    Addr pc = inst.pc;
+    Addr target = inst.npc;
+    Addr fallThru = inst.fallThruPC;
+    BranchInfo info(pc, target, inst.staticInst, fallThru-pc);
+    set(stream.startPC, pc, info.getType(), inst.branching, mispred, fallThru, stream.predSource, target);
     // for (auto it = _uint64_data.begin(); it != _uint64_data.end(); it++) {
     //     printf("%s: %ld\n", it->first.c_str(), it->second);
     // }
@@ -676,6 +421,25 @@ DecoupledBPUWithFTB::tick()
     squashing = false;
 }
 
+bool
+DecoupledBPUWithFTB::canSkipCycles()
+{
+    bool loop_buffer_query = enableLoopBuffer && !lb.isActive() &&
+        lb.streamBeforeLoop.getTakenTarget() == lb.streamBeforeLoop.startPC &&
+        !lb.streamBeforeLoop.resolved;
+    return !enableTwoTaken && !squashing && !receivedPred && !sentPCHist &&
+        numOverrideBubbles == 0 && streamQueueFull() &&
+        fetchTargetQueue.full() && fetchTargetQueue.fetchTargetAvailable() &&
+        !loop_buffer_query;
+}
+
+void
+DecoupledBPUWithFTB::skipCycles(Cycles cycles)
+{
+    dbpFtbStats.fsqEntryDist.sample(fetchStreamQueue.size(), cycles);
+    dbpFtbStats.fsqFullCannotEnq += cycles;
+}
+
 // ideal_tick() is copied from commit: e7294f1813c331dbce8bcfa4d5eb981f7c8440c5
 // TODO: Fix bug in ideal_tick(): Bubbles created by generateFinalPredAndCreateBubbles() are lost in the next tick,
 // resulting in almost NO override bubbles. To resolve this, move tryEnqFetchTarget() and tryEnqFetchStream()
@@ -1411,9 +1175,6 @@ void DecoupledBPUWithFTB::update(unsigned stream_id, ThreadID tid)
         if (miss_predicted) {
             DPRINTF(FTBITTAGE || (stream.squashPC == 0x1e0eb6), "miss predicted stream.startAddr=%#lx\n", stream.startPC);
         }
-        if (miss_predicted && stream.exeBranchInfo.isIndirect) {
-            topMispredIndirect[stream.startPC]++;
-        }
         // if (stream.startPC == ObservingPC) {
         //     debugFlagOn = true;
         // }
@@ -1606,19 +1367,14 @@ void DecoupledBPUWithFTB::update(unsigned stream_id, ThreadID tid)
                 components[i]->update(stream);
             }
             // ftb entry stats
-            auto it = totalFTBEntries.find(stream.startPC);
-            if (it == totalFTBEntries.end()) {
+            if (ftbEntryStarts.insert(stream.startPC).second) {
                 auto &ftb_entry = stream.updateFTBEntry;
-                totalFTBEntries[stream.startPC] = std::make_pair(ftb_entry, 1);
                 dbpFtbStats.ftbEntriesWithDifferentStart++;
                 if (ftb_entry.slots.size() == 1) {
                     if (ftb_entry.slots[0].pc == stream.startPC && ftb_entry.slots[0].isUncond()) {
                         dbpFtbStats.ftbEntriesWithOnlyOneJump++;
                     }
                 }
-            } else {
-                it->second.second++;
-                it->second.first = stream.updateFTBEntry;
             }
         }
 
@@ -1705,56 +1461,15 @@ void DecoupledBPUWithFTB::update(unsigned stream_id, ThreadID tid)
             }
         }
         dbpFtbStats.commitFsqEntryHasInsts.sample(stream.commitInstNum, 1);
-        if (stream.commitInstNum >= 0 && stream.commitInstNum <= 16) {
-            commitFsqEntryHasInstsVector[stream.commitInstNum]++;
-            if (stream.commitInstNum == 1 && stream.exeBranchInfo.isUncond()) {
-                dbpFtbStats.commitFsqEntryOnlyHasOneJump++;
-            }
+        if (stream.commitInstNum == 1 && stream.exeBranchInfo.isUncond()) {
+            dbpFtbStats.commitFsqEntryOnlyHasOneJump++;
         }
         dbpFtbStats.commitFsqEntryFetchedInsts.sample(stream.fetchInstNum, 1);
-        if (stream.fetchInstNum >= 0 && stream.fetchInstNum <= 16) {
-            commitFsqEntryFetchedInstsVector[stream.fetchInstNum]++;
-        }
-
-
-        if (stream.squashType == SQUASH_CTRL) {
-            auto find_it = topMispredicts.find(std::make_pair(stream.startPC, stream.exeBranchInfo.pc));
-            if (find_it == topMispredicts.end()) {
-                topMispredicts[std::make_pair(stream.startPC, stream.exeBranchInfo.pc)] = 1;
-            } else {
-                find_it->second++;
-            }
-
-            // if (stream.isMiss /* && stream.exeBranchPC == ObservingPC */) {
-            //     missCount++;
-            // }
-
-            // if (stream.exeBranchPC == ObservingPC) {
-            //     debugFlagOn = true;
-            //     auto misTripCount = misPredTripCount.find(stream.tripCount);
-            //     if (misTripCount == misPredTripCount.end()) {
-            //         misPredTripCount[stream.tripCount] = 1;
-            //     } else {
-            //         misPredTripCount[stream.tripCount]++;
-            //     }
-            //     DPRINTF(DecoupleBP || debugFlagOn, "commit mispredicted stream %lu\n", it->first);
-            // }
-        }
-
-        if (/* stream.startPC == ObservingPC &&  */stream.squashType == SQUASH_CTRL) {
-            auto hist(stream.history);
-            hist.resize(18);
-            uint64_t pattern = hist.to_ulong();
-            auto find_it = topMispredHist.find(pattern);
-            if (find_it == topMispredHist.end()) {
-                topMispredHist[pattern] = 1;
-            } else {
-                find_it->second++;
-            }
+        if (profiler) {
+            profiler->commitStream(stream);
         }
 
 
-
         if (enableLoopBuffer) {
             // if current stream is a short loop, try to peek loop buffer
             if (stream.startPC == lastCommittedStream.startPC &&
@@ -1784,28 +1499,43 @@ void DecoupledBPUWithFTB::update(unsigned stream_id, ThreadID tid)
     historyManager.commit(stream_id);
 }
 
+CommittedInst
+DecoupledBPUWithFTB::committedInst(const DynInstPtr &inst)
+{
+    const auto &rv_pc = inst->pcState().as<RiscvISA::PCState>();
+    return CommittedInst{rv_pc.instAddr(), rv_pc.npc(), rv_pc.getFallThruPC(),
+                         rv_pc.branching(), inst->staticInst, inst->fsqId};
+}
+
 void
 DecoupledBPUWithFTB::commitBranch(const DynInstPtr &inst, bool miss)
 {
+    commitBranch(committedInst(inst), miss);
+}
+
+void
+DecoupledBPUWithFTB::commitBranch(const CommittedInst &inst, bool miss)
+{
+    const auto &static_inst = inst.staticInst;
     // do overall statistics
-    if (inst->isUncondCtrl()) {
+    if (static_inst->isUncondCtrl()) {
         addCfi(branch_prediction::ftb_pred::DecoupledBPUWithFTB::CfiType::UNCOND, miss);
     }
-    if (inst->isCondCtrl()) {
+    if (static_inst->isCondCtrl()) {
         addCfi(branch_prediction::ftb_pred::DecoupledBPUWithFTB::CfiType::COND, miss);
     }
-    if (inst->isReturn()) {
+    if (static_inst->isReturn()) {
         addCfi(branch_prediction::ftb_pred::DecoupledBPUWithFTB::CfiType::RETURN, miss);
-    } else if (inst->isIndirectCtrl()) {
+    } else if (static_inst->isIndirectCtrl()) {
         addCfi(branch_prediction::ftb_pred::DecoupledBPUWithFTB::CfiType::OTHER, miss);
     }
-    DPRINTF(DBPFTBStats, "inst=%s\n", inst->staticInst->disassemble(inst->pcState().instAddr()));
+    DPRINTF(DBPFTBStats, "inst=%s\n", static_inst->disassemble(inst.pc));
     DPRINTF(DBPFTBStats, "isUncondCtrl=%d, isCondCtrl=%d, isReturn=%d, isIndirectCtrl=%d\n",
-            inst->isUncondCtrl(), inst->isCondCtrl(), inst->isReturn(), inst->isIndirectCtrl());
+            static_inst->isUncondCtrl(), static_inst->isCondCtrl(), static_inst->isReturn(), static_inst->isIndirectCtrl());
 
     // break down into each predictor and each stage
     // find corresponding fsq entry first
-    auto it = fetchStreamQueue.find(inst->fsqId);
+    auto it = fetchStreamQueue.find(inst.fsqId);
     assert(it != fetchStreamQueue.end());
 
     auto &entry = it->second;
@@ -1813,102 +1543,28 @@ DecoupledBPUWithFTB::commitBranch(const DynInstPtr &inst, bool miss)
 
         bptrace->write_record(BpTrace(entry, inst, miss));
     }
-    Addr branchAddr = inst->pcState().instAddr();
-    const auto &rv_pc = inst->pcState().as<RiscvISA::PCState>();
-    Addr targetAddr = rv_pc.npc();
-    Addr fallThruPC = rv_pc.getFallThruPC();
-    BranchInfo info(branchAddr, targetAddr, inst->staticInst, fallThruPC-branchAddr);
-    bool taken = rv_pc.branching();
-    taken |= inst->isUncondCtrl();
-    auto find_it = topMispredictsByBranch.find(std::make_pair(branchAddr, info.getType()));
-    MispredType mtype = FAKE_LAST;
-    if (miss) {
-        // not taken can only be
-        if (!taken) {
-            assert(info.isCond);
-            mtype = DIR_WRONG;
-        } else {
-            bool predBranchInFTB = false;
-            if (entry.isHit) {
-                for (auto &slot : entry.predFTBEntry.slots) {
-                    if (slot.pc == branchAddr && slot.getType() == info.getType()) {
-                        predBranchInFTB = true;
-                    }
-                }
-            }
-            if (!predBranchInFTB) {
-                mtype = NO_PRED;
-            } else {
-                if (entry.predTaken && entry.predBranchInfo.pc == branchAddr) {
-                    mtype = TARGET_WRONG;
-                } else {
-                    // pred stream not taken or taken with other branch
-                    mtype = DIR_WRONG;
-                }
-            }
-        }
-        DPRINTF(Profiling, "branchAddr %#lx is mispredicted, taken %d, type %d, missType %d\n",
-            branchAddr, taken, info.getType(), mtype);
-        assert(mtype != FAKE_LAST);
-    }
-    DPRINTF(Profiling, "lookup topMispredictsByBranch for branchAddr %#lx, type %d\n",
-            branchAddr, info.getType());
-    if (find_it == topMispredictsByBranch.end()) {
-        DPRINTF(Profiling, "not found, insert miss %d\n", miss);
-        MispredReasonMap rm;
-        for (int i = 0; i < FAKE_LAST; i++) {
-            rm[MispredType(i)] = mtype == i ? 1 : 0;
-        }
-        MispredDesc desc = std::make_pair((int)miss, rm);
-        topMispredictsByBranch[std::make_pair(branchAddr, info.getType())] = std::make_pair(desc,1);
+    Addr branchAddr = inst.pc;
+    Addr targetAddr = inst.npc;
+    Addr fallThruPC = inst.fallThruPC;
+    BranchInfo info(branchAddr, targetAddr, static_inst, fallThruPC-branchAddr);
+    bool taken = inst.branching;
+    taken |= static_inst->isUncondCtrl();
+    if (staticBranches.emplace(branchAddr, info.getType()).second) {
         dbpFtbStats.staticBranchNum++;
-    } else {
-        DPRINTF(Profiling, "found, total %d, miss %d\n", find_it->second.second, find_it->second.first.first);
-        find_it->second.second++;
-        if (miss) {
-            find_it->second.first.first++;
-            auto it = find_it->second.first.second.find(mtype);
-            assert(it != find_it->second.first.second.end());
-            it->second++;
-        }
     }
-    if (taken) {
-        auto itt = takenBranches.find(branchAddr);
-        DPRINTF(Profiling, "lookup takenBranches for taken branchAddr %#lx\n", branchAddr);
-        if (itt == takenBranches.end()) {
-            DPRINTF(Profiling, "not found, insert\n");
-            takenBranches[branchAddr] = 1;
-            dbpFtbStats.staticBranchNumEverTaken++;
-        } else {
-            DPRINTF(Profiling, "found, inc count %d to %d\n", itt->second, itt->second+1);
-            itt->second++;
-        }
-        DPRINTF(Profiling, "lookup currentPhaseTakenBranches for taken branchAddr %#lx\n", branchAddr);
-        auto ittt = currentPhaseTakenBranches.find(branchAddr);
-        if (ittt == currentPhaseTakenBranches.end()) {
-            DPRINTF(Profiling, "not found, insert\n");
-            currentPhaseTakenBranches[branchAddr] = 1;
-        } else {
-            DPRINTF(Profiling, "found, inc count %d to %d\n", ittt->second, ittt->second+1);
-            ittt->second++;
-        }
-        DPRINTF(Profiling, "lookup currentSubPhaseTakenBranches for taken branchAddr %#lx\n", branchAddr);
-        auto ittts = currentSubPhaseTakenBranches.find(branchAddr);
-        if (ittts == currentSubPhaseTakenBranches.end()) {
-            DPRINTF(Profiling, "not found, insert\n");
-            currentSubPhaseTakenBranches[branchAddr] = 1;
-        } else {
-            DPRINTF(Profiling, "found, inc count %d to %d\n", ittts->second, ittt->second+1);
-            ittts->second++;
-        }
+    if (taken && everTakenBranches.insert(branchAddr).second) {
+        dbpFtbStats.staticBranchNumEverTaken++;
+    }
+    if (profiler) {
+        profiler->commitBranch(entry, info, taken, miss);
     }
     entry.commitMispredictions[branchAddr] = miss;
-    DPRINTF(DBPFTBStats, "commit branchAddr %#lx, miss %d, fsqID %d\n", branchAddr, miss, inst->fsqId);
+    DPRINTF(DBPFTBStats, "commit branchAddr %#lx, miss %d, fsqID %d\n", branchAddr, miss, inst.fsqId);
 
     LoopTrace rec;
     LoopEntry predLoopEntry = LoopEntry();
     for (int i = 0; i < numBr; i++) {
-        if (entry.loopRedirectInfos[i].branch_pc == inst->pcState().instAddr()) {
+        if (entry.loopRedirectInfos[i].branch_pc == inst.pc) {
             predLoopEntry = entry.loopRedirectInfos[i].e;
             break;
         }
@@ -1922,7 +1578,7 @@ DecoupledBPUWithFTB::commitBranch(const DynInstPtr &inst, bool miss)
     }
 
     for (int i = 0; i < numBr; i++) {
-        if (entry.loopRedirectInfos[i].branch_pc == inst->pcState().instAddr()) {
+        if (entry.loopRedirectInfos[i].branch_pc == inst.pc) {
             auto &loopEntry = entry.loopRedirectInfos[i].e;
             if (loopEntry.specCnt == loopEntry.tripCnt ||
                 (loopEntry.specCnt == loopEntry.tripCnt - 1 && entry.isDouble))
@@ -1936,7 +1592,7 @@ DecoupledBPUWithFTB::commitBranch(const DynInstPtr &inst, bool miss)
         }
     }
     for (auto &info : entry.unseenLoopRedirectInfos) {
-        if (info.branch_pc == inst->pcState().instAddr()) {
+        if (info.branch_pc == inst.pc) {
             auto &loopEntry = info.e;
             dbpFtbStats.commitFTBUnseenLoopBranchInLp++;
             if (loopEntry.specCnt == loopEntry.tripCnt) {
@@ -1952,117 +1608,31 @@ DecoupledBPUWithFTB::commitBranch(const DynInstPtr &inst, bool miss)
 void
 DecoupledBPUWithFTB::notifyInstCommit(const DynInstPtr &inst)
 {
-    auto it = fetchStreamQueue.find(inst->fsqId);
+    notifyInstCommit(committedInst(inst));
+}
+
+void
+DecoupledBPUWithFTB::notifyInstCommit(const CommittedInst &inst)
+{
+    if (cfiTrace) {
+        cfiTrace->commit(inst);
+    }
+    auto it = fetchStreamQueue.find(inst.fsqId);
     assert(it != fetchStreamQueue.end());
     it->second.commitInstNum++;
-    numInstCommitted++;
     DPRINTF(Profiling, "notifyInstCommit, inst=%s, commitInstNum=%d\n",
-            inst->staticInst->disassemble(inst->pcState().instAddr()),
+            inst.staticInst->disassemble(inst.pc),
             it->second.commitInstNum);
-    if (numInstCommitted % phaseSizeByInst == 0) {
-        DPRINTF(Profiling, "numInstCommitted %d\n", numInstCommitted);
-        int currentPhaseID = numInstCommitted / phaseSizeByInst;
-        // dump current phase only once
-        if (phaseIdToDump <= currentPhaseID) {
-            DPRINTF(Profiling, "dump phase %d\n", phaseIdToDump);
-            // fsq entry inst num distribution
-            std::vector<int> currentPhaseFsqEntryNumCommittedInstDist;
-            std::vector<int> currentPhaseFsqEntryNumFetchedInstDist;
-            currentPhaseFsqEntryNumCommittedInstDist.resize(16+1, 0);
-            currentPhaseFsqEntryNumFetchedInstDist.resize(16+1, 0);
-            // FIXME: parameterize
-            for (int i = 0; i <= 16; i++) {
-                currentPhaseFsqEntryNumCommittedInstDist[i] = commitFsqEntryHasInstsVector[i] - lastPhaseFsqEntryNumCommittedInstDist[i];
-                lastPhaseFsqEntryNumCommittedInstDist[i] = commitFsqEntryHasInstsVector[i];
-                currentPhaseFsqEntryNumFetchedInstDist[i] = commitFsqEntryFetchedInstsVector[i] - lastPhaseFsqEntryNumFetchedInstDist[i];
-                lastPhaseFsqEntryNumFetchedInstDist[i] = commitFsqEntryFetchedInstsVector[i];
-            }
-            fsqEntryNumCommittedInstDistByPhase.push_back(currentPhaseFsqEntryNumCommittedInstDist);
-            fsqEntryNumFetchedInstDistByPhase.push_back(currentPhaseFsqEntryNumFetchedInstDist);
-
-            // per phase topMispredicts, can be used to calculate static branch
-            MispredMap currentPhaseTopMispredictsByBranch;
-            for (auto &it : topMispredictsByBranch) {
-                auto miss = it.second.first.first;
-                auto missMap = it.second.first.second;
-                auto total = it.second.second;
-                auto last_it = lastPhaseTopMispredictsByBranch.find(it.first);
-                if (last_it != lastPhaseTopMispredictsByBranch.end()) {
-                    miss -= last_it->second.first.first;
-                    total -= last_it->second.second;
-                    for (int i = 0; i < FAKE_LAST; i++) {
-                        missMap[MispredType(i)] -= last_it->second.first.second[MispredType(i)];
-                    }
-                }
-                if (total > 0) {
-                    currentPhaseTopMispredictsByBranch[it.first] = std::make_pair(std::make_pair(miss, missMap), total);
-                }
-            }
-            lastPhaseTopMispredictsByBranch = topMispredictsByBranch;
-            topMispredictsByBranchByPhase.push_back(currentPhaseTopMispredictsByBranch);
-
-            takenBranchesByPhase.push_back(currentPhaseTakenBranches);
-            currentPhaseTakenBranches.clear();
-
-            // per phase FTB entries
-            std::map<Addr, std::pair<FTBEntry, int>> currentPhaseFTBEntries;
-            for (auto &it : totalFTBEntries) {
-                auto &entry = it.second.first;
-                auto visit_cnt = it.second.second;
-                auto last_it = lastPhaseFTBEntries.find(it.first);
-                if (last_it != lastPhaseFTBEntries.end()) {
-                    visit_cnt -= last_it->second.second;
-                }
-                // use new entries, what if entry of the same start addr changes?
-                if (visit_cnt > 0) {
-                    currentPhaseFTBEntries[it.first] = std::make_pair(entry, visit_cnt);
-                }
-            }
-            lastPhaseFTBEntries = totalFTBEntries;
-            FTBEntriesByPhase.push_back(currentPhaseFTBEntries);
-
-            phaseIdToDump++;
-        }
-    }
-
-    if (numInstCommitted % subPhaseSizeByInst()) {
-        DPRINTF(Profiling, "numInstCommitted %d\n", numInstCommitted);
-        int currentSubPhaseID = numInstCommitted / subPhaseSizeByInst();
-        if (subPhaseIdToDump <= currentSubPhaseID) {
-            DPRINTF(Profiling, "dump sub phase %d\n", subPhaseIdToDump);
-            // per phase topMispredicts, can be used to calculate static branch
-            MispredMap currentSubPhaseTopMispredictsByBranch;
-            for (auto &it : topMispredictsByBranch) {
-                auto miss = it.second.first.first;
-                auto missMap = it.second.first.second;
-                auto total = it.second.second;
-                auto last_it = lastSubPhaseTopMispredictsByBranch.find(it.first);
-                if (last_it != lastSubPhaseTopMispredictsByBranch.end()) {
-                    miss -= last_it->second.first.first;
-                    total -= last_it->second.second;
-                    for (int i = 0; i < FAKE_LAST; i++) {
-                        missMap[MispredType(i)] -= last_it->second.first.second[MispredType(i)];
-                    }
-                }
-                if (total > 0) {
-                    currentSubPhaseTopMispredictsByBranch[it.first] = std::make_pair(std::make_pair(miss, missMap), total);
-                }
-            }
-            lastSubPhaseTopMispredictsByBranch = topMispredictsByBranch;
-            topMispredictsByBranchBySubPhase.push_back(currentSubPhaseTopMispredictsByBranch);
-
-            takenBranchesBySubPhase.push_back(currentSubPhaseTakenBranches);
-            currentSubPhaseTakenBranches.clear();
-            subPhaseIdToDump++;
-        }
+    if (profiler) {
+        profiler->commitInst();
     }
 }
 
 void
 DecoupledBPUWithFTB::squashStreamAfter(unsigned squash_stream_id)
 {
-    auto erase_it = fetchStreamQueue.upper_bound(squash_stream_id);
-    while (erase_it != fetchStreamQueue.end()) {
+    for (auto erase_it = fetchStreamQueue.upper_bound(squash_stream_id);
+         erase_it != fetchStreamQueue.end(); ++erase_it) {
         DPRINTF(DecoupleBP || debugFlagOn || erase_it->second.startPC == ObservingPC,
                 "Erasing stream %lu when squashing %lu\n", erase_it->first,
                 squash_stream_id);
@@ -2087,8 +1657,8 @@ DecoupledBPUWithFTB::squashStreamAfter(unsigned squash_stream_id)
                 j++;
             }
         }
-        fetchStreamQueue.erase(erase_it++);
     }
+    fetchStreamQueue.eraseAfter(squash_stream_id);
 }
 
 void
@@ -2269,13 +1839,12 @@ DecoupledBPUWithFTB::tryEnqFetchTarget()
 }
 
 void
-DecoupledBPUWithFTB::histShiftIn(int shamt, bool taken, boost::dynamic_bitset<> &history)
+DecoupledBPUWithFTB::histShiftIn(int shamt, bool taken, PackedHist &history)
 {
     if (shamt == 0) {
         return;
     }
-    history <<= shamt;
-    history[0] = taken;
+    history.shiftIn(shamt, taken);
 }
 
 void
@@ -2562,7 +2131,7 @@ DecoupledBPUWithFTB::enqueueFetchStream()
 }
 
 void
-DecoupledBPUWithFTB::checkHistory(const boost::dynamic_bitset<> &history)
+DecoupledBPUWithFTB::checkHistory(const PackedHist &history)
 {/*
     unsigned ideal_size = 0;
     boost::dynamic_bitset<> ideal_hash_hist(historyBits, 0);
@@ -2614,17 +2183,97 @@ DecoupledBPUWithFTB::resetPC(Addr new_pc)
     fetchTargetQueue.resetPC(new_pc);
 }
 
+void
+DecoupledBPUWithFTB::saveState(const std::string &path) const
+{
+    BPStateOut out(path);
+
+    // the history the oldest uncommitted stream was predicted with
+    const auto &history = fetchStreamQueue.empty() ?
+        s0History : fetchStreamQueue.front().second.history;
+    out.section("bpu", {historyBits, numBr, predictWidth});
+    for (unsigned i = 0; i < historyBits; i += PackedHist::wordBits) {
+        out.put(history.bits(i, std::min(PackedHist::wordBits,
+                                          historyBits - i)));
+    }
+
+    for (auto component : components) {
+        component->saveState(out);
+    }
+    lp.saveState(out, "lp");
+    jap.saveState(out, "jap");
+    inform("%s: saved predictor state to %s\n", name(), path);
+}
+
+void
+DecoupledBPUWithFTB::loadState(const std::string &path)
+{
+    BPStateIn in(path);
+
+    in.section("bpu", {historyBits, numBr, predictWidth});
+    for (unsigned i = 0; i < historyBits; i += PackedHist::wordBits) {
+        uint64_t word;
+        in.get(word);
+        for (unsigned b = 0; b < PackedHist::wordBits &&
+                             i + b < historyBits; b++) {
+            s0History.set(i + b, (word >> b) & 1);
+        }
+    }
+
+    for (auto component : components) {
+        component->loadState(in);
+        component->resetHist(s0History);
+    }
+    lp.loadState(in, "lp");
+    jap.loadState(in, "jap");
+    fatal_if(!in.atEnd(), "%s: trailing data in predictor state %s\n",
+             name(), path);
+    inform("%s: loaded predictor state from %s\n", name(), path);
+}
+
+void
+DecoupledBPUWithFTB::serialize(CheckpointOut &cp) const
+{
+    std::string filename = name() + ".bpstate.gz";
+    saveState(CheckpointIn::dir() + "/" + filename);
+    SERIALIZE_SCALAR(filename);
+}
+
+void
+DecoupledBPUWithFTB::unserialize(CheckpointIn &cp)
+{
+    // checkpoints taken before the predictor was saved start cold
+    std::string filename;
+    if (UNSERIALIZE_OPT_SCALAR(filename)) {
+        loadState(cp.getCptDir() + "/" + filename);
+    }
+}
+
+void
+DecoupledBPUWithFTB::startup()
+{
+    // after unserialize, so a given state file overrides the checkpoint
+    if (!warmStateIn.empty()) {
+        loadState(warmStateIn);
+    }
+}
+
 Cycles
 DecoupledBPUWithFTB::curCycle()
 {
-    return cpu->curCycle();
+    return cpu ? cpu->curCycle() : clockSource->curCycle();
 }
 
 Addr
 DecoupledBPUWithFTB::getPreservedReturnAddr(const DynInstPtr &dynInst)
 {
     DPRINTF(DecoupleBP, "acquiring reutrn address for inst pc %#lx from decode\n", dynInst->pcState().instAddr());
-    auto fsqid = dynInst->getFsqId();
+    return getPreservedReturnAddr(dynInst->getFsqId());
+}
+
+Addr
+DecoupledBPUWithFTB::getPreservedReturnAddr(FetchStreamId fsqid)
+{
     auto it = fetchStreamQueue.find(fsqid);
     auto retAddr = ras->getTopAddrFromMetas(it->second);
     DPRINTF(DecoupleBP, "get ret addr %#lx\n", retAddr);
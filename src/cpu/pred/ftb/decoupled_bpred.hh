@@ -2,8 +2,10 @@
 #define __CPU_PRED_FTB_DECOUPLED_BPRED_HH__
 
 #include <array>
+#include <memory>
 #include <queue>
 #include <stack>
+#include <unordered_set>
 #include <utility> 
 #include <vector>
 
@@ -16,6 +18,8 @@
 // #include "cpu/o3/fetch.hh"
 #include "cpu/pred/bpred_unit.hh"
 #include "cpu/pred/general_arch_db.hh"
+#include "cpu/pred/ftb/bp_profiler.hh"
+#include "cpu/pred/ftb/cfi_trace.hh"
 #include "cpu/pred/ftb/fetch_target_queue.hh"
 #include "cpu/pred/ftb/ftb.hh"
 #include "cpu/pred/ftb/ftb_tage.hh"
@@ -27,6 +31,7 @@
 #include "cpu/pred/ftb/uras.hh"
 #include "cpu/pred/ftb/stream_struct.hh"
 #include "cpu/pred/ftb/timed_base_pred.hh"
+#include "cpu/pred/id_queue.hh"
 #include "debug/DecoupleBP.hh"
 #include "debug/DecoupleBPHist.hh"
 #include "debug/DecoupleBPProbe.hh"
@@ -39,6 +44,7 @@
 #include "debug/LoopPredictor.hh"
 #include "debug/LoopPredictorVerbose.hh"
 #include "params/DecoupledBPUWithFTB.hh"
+#include "sim/clocked_object.hh"
 
 namespace gem5
 {
@@ -203,13 +209,23 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     FetchTargetQueue fetchTargetQueue;
 
-    std::map<FetchStreamId, FetchStream> fetchStreamQueue;
+    IdQueue<FetchStreamId, FetchStream> fetchStreamQueue;
     unsigned fetchStreamQueueSize;
     FetchStreamId fsqId{1};
     FetchStream lastCommittedStream;
     FetchStream streamToEnqueue;
 
-    CPU *cpu;
+    CPU *cpu{nullptr};
+
+    /** Cycle source when driven without a CPU, see BPReplay */
+    const ClockedObject *clockSource{nullptr};
+
+    /** Committed control flow is recorded here if cfiTrace is set */
+    std::unique_ptr<CfiTraceWriter> cfiTrace;
+
+    /** Predictor state loaded at startup, saved at exit, if set */
+    std::string warmStateIn;
+    std::string warmStateOut;
 
     unsigned numBr;
 
@@ -270,10 +286,10 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     Addr s0PC;
     // Addr s0StreamStartPC;
-    boost::dynamic_bitset<> s0History;
+    PackedHist s0History;
     FullFTBPrediction finalPred;
 
-    boost::dynamic_bitset<> commitHistory;
+    PackedHist commitHistory;
 
     bool squashing{false};
 
@@ -308,7 +324,7 @@ class DecoupledBPUWithFTB : public BPredUnit
     Addr computePathHash(Addr br, Addr target);
 
     // TODO: compare phr and ghr
-    void histShiftIn(int shamt, bool taken, boost::dynamic_bitset<> &history);
+    void histShiftIn(int shamt, bool taken, PackedHist &history);
 
     void printStream(const FetchStream &e)
     {
@@ -550,6 +566,11 @@ class DecoupledBPUWithFTB : public BPredUnit
     void tick();
     void ideal_tick();
 
+    // Whether tick() has nothing to do but count a full stream queue
+    // until fetch takes a target or a squash comes
+    bool canSkipCycles();
+    void skipCycles(Cycles cycles);
+
     bool trySupplyFetchWithTarget(Addr fetch_demand_pc, bool &fetchTargetInLoop);
 
     void squash(const InstSeqNum &squashed_sn, ThreadID tid)
@@ -564,6 +585,8 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     void setCpu(CPU *_cpu) { cpu = _cpu; }
 
+    void setClockSource(const ClockedObject *clk) { clockSource = clk; }
+
     Cycles curCycle();
 
     struct BpTrace : public Record {
@@ -579,7 +602,7 @@ class DecoupledBPUWithFTB : public BPredUnit
             _uint64_data["source"] = source;
             _uint64_data["target"] = target;
         }
-        BpTrace(FetchStream &stream, const DynInstPtr &inst, bool mispred);
+        BpTrace(FetchStream &stream, const CommittedInst &inst, bool mispred);
     };
 
     std::pair<bool, bool> decoupledPredict(const StaticInstPtr &inst,
@@ -645,73 +668,27 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     bool lookup(ThreadID tid, Addr instPC, void *&bp_history) override { return false; }
 
-    void checkHistory(const boost::dynamic_bitset<> &history);
+    void checkHistory(const PackedHist &history);
 
     bool useStreamRAS(FetchStreamId sid);
 
     Addr getPreservedReturnAddr(const DynInstPtr &dynInst);
 
+    Addr getPreservedReturnAddr(FetchStreamId fsqid);
+
     std::string buf1, buf2;
 
     std::stack<Addr> streamRAS;
     
     bool debugFlagOn{false};
 
-    std::map<Addr, int> takenBranches;
-    std::map<Addr, int> currentPhaseTakenBranches;
-    std::map<Addr, int> currentSubPhaseTakenBranches;
+    /** Branch profiles, only with enableProfiling */
+    std::unique_ptr<BPProfiler> profiler;
 
-    enum MispredType {
-        DIR_WRONG,
-        TARGET_WRONG,
-        NO_PRED,
-        FAKE_LAST
-    };
-    using MispredReasonMap = std::map<MispredType, int>;
-    //                         mispred cnt
-    using MispredDesc = std::pair<int, MispredReasonMap>;
-    //                                    ((mispredict, reason_map),        total)
-    using MispredData = std::pair<MispredDesc, int>;
-    //                             (pc, type) 
-    using MispredIndex = std::pair<Addr, int>;
-    using MispredRecord = std::pair<MispredIndex, MispredData>;
-    using MispredMap = std::map<MispredIndex, MispredData>;
-    // int getMispredCount(MispredData &data) { return data.first.first; }
-    int getMispredCount(const MispredRecord &data) { return data.second.first.first; }
-    
-    std::map<std::pair<Addr, Addr>, int> topMispredicts;
-    MispredMap topMispredictsByBranch;
-    std::map<uint64_t, uint64_t> topMispredHist;
-    std::map<int, int> misPredTripCount;
-
-    MispredMap lastPhaseTopMispredictsByBranch;
-    std::vector<MispredMap> topMispredictsByBranchByPhase;
-    std::vector<std::map<Addr, int>> takenBranchesByPhase;
-
-    //      startPC          entry    visited
-    std::map<Addr, std::pair<FTBEntry, int>> lastPhaseFTBEntries;
-    std::map<Addr, std::pair<FTBEntry, int>> totalFTBEntries;
-    std::vector<std::map<Addr, std::pair<FTBEntry, int>>> FTBEntriesByPhase;
-
-    int phaseIdToDump{1};
-    int numInstCommitted{0};
-    int phaseSizeByInst{100000};
-    int subPhaseIdToDump{1};
-    int subPhaseRatio{10};
-    int subPhaseSizeByInst() { return phaseSizeByInst/subPhaseRatio; }
-
-    std::vector<int> lastPhaseFsqEntryNumCommittedInstDist;
-    std::vector<int> commitFsqEntryHasInstsVector;
-    std::vector<std::vector<int>> fsqEntryNumCommittedInstDistByPhase;
-    std::vector<int> lastPhaseFsqEntryNumFetchedInstDist;
-    std::vector<int> commitFsqEntryFetchedInstsVector;
-    std::vector<std::vector<int>> fsqEntryNumFetchedInstDistByPhase;
-    unsigned int missCount{0};
-
-    MispredMap lastSubPhaseTopMispredictsByBranch;
-    std::vector<MispredMap> topMispredictsByBranchBySubPhase;
-    std::vector<std::map<Addr, int>> takenBranchesBySubPhase;
-    
+    /** Static branches and FTB entries seen, for their stats */
+    std::unordered_set<std::pair<Addr, int>, PairHash> staticBranches;
+    std::unordered_set<Addr> everTakenBranches;
+    std::unordered_set<Addr> ftbEntryStarts;
 
     void setTakenEntryWithStream(const FetchStream &stream_entry, FtqEntry &ftq_entry);
 
@@ -727,6 +704,18 @@ class DecoupledBPUWithFTB : public BPredUnit
 
     void resetPC(Addr new_pc);
 
+    /**
+     * Save or load the trained state of every predictor and the committed
+     * global history, see BPStateOut. Nothing speculative is saved (FSQ,
+     * FTQ, inflight RAS entries): a loaded BPU has nothing in flight.
+     */
+    void saveState(const std::string &path) const;
+    void loadState(const std::string &path);
+
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+    void startup() override;
+
     enum CfiType {
         COND,
         UNCOND,
@@ -764,11 +753,15 @@ class DecoupledBPUWithFTB : public BPredUnit
         dbpFtbStats.ftqNotValid++;
     }
 
+    static CommittedInst committedInst(const DynInstPtr &inst);
+
     void commitBranch(const DynInstPtr &inst, bool miss);
 
+    void commitBranch(const CommittedInst &inst, bool miss);
+
     void notifyInstCommit(const DynInstPtr &inst);
 
-    std::map<Addr, unsigned> topMispredIndirect;
+    void notifyInstCommit(const CommittedInst &inst);
 
     int currentFtqEntryInstNum{0};
 
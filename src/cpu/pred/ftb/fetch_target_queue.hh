@@ -2,6 +2,7 @@
 #define __CPU_PRED_FTB_FETCH_TARGET_QUEUE_HH__
 
 #include "cpu/pred/ftb/stream_struct.hh"
+#include "cpu/pred/id_queue.hh"
 #include "sim/sim_object.hh"
 
 namespace gem5
@@ -34,7 +35,7 @@ class FetchTargetQueue
     // 1. enqueue from fetch stream buffer
     // 2. supply fetch with fetch target head
     // 3. redirect fetch target head after squash
-    using FTQ = std::map<FetchTargetId, FtqEntry>;
+    using FTQ = IdQueue<FetchTargetId, FtqEntry>;
     using FTQIt = FTQ::iterator;
     FTQ ftq;
     unsigned ftqSize;
@@ -106,7 +107,7 @@ class FetchTargetQueue
 
     bool validSupplyFetchTargetState() const;
 
-    FtqEntry &getLastInsertedEntry() { return ftq.rbegin()->second; }
+    FtqEntry &getLastInsertedEntry() { return ftq.back().second; }
 
     int getCurrentLoopIter() { return currentLoopIter; }
 
@@ -0,0 +1,127 @@
+#ifndef __CPU_PRED_FTB_FLAT_TABLES_HH__
+#define __CPU_PRED_FTB_FLAT_TABLES_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/types.hh"
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/** Allocates on cache line boundaries */
+template <typename T>
+struct CacheLineAllocator
+{
+    using value_type = T;
+    static constexpr std::size_t lineSize = 64;
+
+    CacheLineAllocator() = default;
+    template <typename U>
+    CacheLineAllocator(const CacheLineAllocator<U> &) {}
+
+    T *
+    allocate(std::size_t n)
+    {
+        return static_cast<T *>(
+            ::operator new(n * sizeof(T), std::align_val_t(lineSize)));
+    }
+
+    void
+    deallocate(T *p, std::size_t)
+    {
+        ::operator delete(p, std::align_val_t(lineSize));
+    }
+
+    template <typename U>
+    bool operator==(const CacheLineAllocator<U> &) const { return true; }
+    template <typename U>
+    bool operator!=(const CacheLineAllocator<U> &) const { return false; }
+};
+
+/**
+ * The tagged tables of a TAGE-like predictor in one allocation, instead of
+ * a vector per table (and per set). Table t has sizes[t] sets of ways
+ * entries, the ways of a set are adjacent and every table starts on a
+ * cache line, so a lookup touches one line per table.
+ */
+template <typename Entry>
+class FlatTables
+{
+  public:
+    void
+    init(const std::vector<unsigned> &table_sizes, unsigned num_ways)
+    {
+        static_assert(CacheLineAllocator<Entry>::lineSize % sizeof(Entry) == 0,
+                      "entries have to pack cache lines");
+        constexpr size_t line_entries =
+            CacheLineAllocator<Entry>::lineSize / sizeof(Entry);
+
+        sizes = table_sizes;
+        ways = num_ways;
+        offsets.clear();
+        size_t total = 0;
+        for (auto size : sizes) {
+            offsets.push_back(total);
+            total += roundUp((size_t)size * ways, line_entries);
+        }
+        entries.assign(total, Entry());
+    }
+
+    Entry &
+    at(unsigned t, Addr index, unsigned way)
+    {
+        assert(index < sizes[t] && way < ways);
+        return entries[offsets[t] + index * ways + way];
+    }
+
+    const Entry &
+    at(unsigned t, Addr index, unsigned way) const
+    {
+        assert(index < sizes[t] && way < ways);
+        return entries[offsets[t] + index * ways + way];
+    }
+
+    /** Visit every entry, table by table, set by set, way by way */
+    template <typename F>
+    void
+    forEach(F f)
+    {
+        for (unsigned t = 0; t < sizes.size(); t++) {
+            for (size_t i = 0; i < (size_t)sizes[t] * ways; i++) {
+                f(entries[offsets[t] + i]);
+            }
+        }
+    }
+
+    template <typename F>
+    void
+    forEach(F f) const
+    {
+        for (unsigned t = 0; t < sizes.size(); t++) {
+            for (size_t i = 0; i < (size_t)sizes[t] * ways; i++) {
+                f(entries[offsets[t] + i]);
+            }
+        }
+    }
+
+  private:
+    std::vector<Entry, CacheLineAllocator<Entry>> entries;
+    std::vector<size_t> offsets;
+    std::vector<unsigned> sizes;
+    unsigned ways{1};
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_FLAT_TABLES_HH__
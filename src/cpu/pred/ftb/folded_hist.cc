@@ -1,5 +1,7 @@
 #include "cpu/pred/ftb/folded_hist.hh"
 
+#include <algorithm>
+
 namespace gem5 {
 
 namespace branch_prediction {
@@ -7,27 +9,26 @@ namespace branch_prediction {
 namespace ftb_pred {
 
 void
-FoldedHist::update(const boost::dynamic_bitset<> &ghr, int shamt, bool taken)
+FoldedHist::update(const PackedHist &ghr, int shamt, bool taken)
 {
     // Update the folded history
-    boost::dynamic_bitset<> temp(folded);
+    assert(shamt <= maxShamt);
+    uint64_t temp = folded;
     if (foldedLen >= histLen) {
         temp <<= shamt;
-        for (int i = histLen; i < foldedLen; i++) {
-            temp[i] = 0;
-        }
-        temp[0] = taken;
+        temp &= foldedMask >> (foldedLen - histLen);
+        temp = (temp & ~1ULL) | taken;
     } else {
-        temp.resize(foldedLen + shamt);
+        // the bits leaving the window cancel out of the fold
+        uint64_t leaving = ghr.bits(histLen - shamt, shamt);
         for (int i = 0; i < shamt; i++) {
-            temp[posHighestBitsInOldFoldedHist[i]] ^= ghr[posHighestBitsInGhr[i]];
+            uint64_t bit = (leaving >> (shamt - 1 - i)) & 1;
+            temp ^= bit << posHighestBitsInOldFoldedHist[i];
         }
         temp <<= shamt;
-        for (int i = 0; i < shamt; i ++) {
-            temp[i] = temp[foldedLen + i];
-        }
-        temp[0] ^= taken;
-        temp.resize(foldedLen);
+        // a shamt above foldedLen carries more than foldedLen bits
+        temp = ((temp & foldedMask) | (temp >> foldedLen)) & foldedMask;
+        temp ^= taken;
     }
     folded = temp;
 }
@@ -41,19 +42,29 @@ FoldedHist::recover(FoldedHist &other)
     folded = other.folded;
 }
 
+uint64_t
+FoldedHist::fold(const PackedHist &ghr) const
+{
+    uint64_t ideal_folded = 0;
+    for (int i = 0; foldedLen && i < histLen; i += foldedLen) {
+        int n = std::min(foldedLen, histLen - i);
+        ideal_folded ^= ghr.bits(i, n);
+    }
+    return ideal_folded;
+}
+
+void
+FoldedHist::reset(const PackedHist &ghr)
+{
+    folded = fold(ghr);
+}
+
 void
-FoldedHist::check(const boost::dynamic_bitset<> &ghr)
+FoldedHist::check(const PackedHist &ghr)
 {
 #ifdef DEBUG
     // Check the folded history now, derive from ghr
-    boost::dynamic_bitset<> ideal(ghr);
-    boost::dynamic_bitset<> idealFolded;
-    ideal.resize(histLen);
-    idealFolded.resize(foldedLen);
-    for (int i = 0; i < histLen; i++) {
-        idealFolded[i % foldedLen] ^= ideal[i];
-    }
-    assert(idealFolded == folded);
+    assert(fold(ghr) == folded);
 #endif
 }
 
@@ -61,4 +72,4 @@ FoldedHist::check(const boost::dynamic_bitset<> &ghr)
 
 }  // namespace branch_prediction
 
-}  // namespace gem5
\ No newline at end of file
+}  // namespace gem5
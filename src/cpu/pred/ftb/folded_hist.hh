@@ -1,10 +1,13 @@
 #ifndef __CPU_PRED_FTB_FOLDED_HIST_HH__
 #define __CPU_PRED_FTB_FOLDED_HIST_HH__
 
-#include <boost/dynamic_bitset.hpp>
+#include <cstdint>
+#include <vector>
 
+#include "base/logging.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
+#include "cpu/pred/ftb/packed_hist.hh"
 #include "debug/FTBFoldedHist.hh"
 
 namespace gem5 {
@@ -13,31 +16,44 @@ namespace branch_prediction {
 
 namespace ftb_pred {
 
+/**
+ * The first histLen bits of the global history xor-folded into foldedLen
+ * bits, kept in one word. foldedLen + maxShamt must fit into 64 bits,
+ * which covers every tag and index width of the FTB predictors.
+ */
 class FoldedHist {
     private:
         int histLen;
         int foldedLen;
         int maxShamt;
-        boost::dynamic_bitset<> folded;
-        std::vector<int> posHighestBitsInGhr;
+        uint64_t folded{0};
+        uint64_t foldedMask;
+        /** Where the i-th oldest bit of the window lands in folded */
         std::vector<int> posHighestBitsInOldFoldedHist;
 
+        /** Fold of the newest histLen bits of ghr, computed from scratch */
+        uint64_t fold(const PackedHist &ghr) const;
+
     public:
         FoldedHist(int histLen, int foldedLen, int maxShamt) :
             histLen(histLen), foldedLen(foldedLen), maxShamt(maxShamt)
             {
-                folded.resize(foldedLen);
+                fatal_if(foldedLen + maxShamt > 64,
+                         "Folded history of %d bits shifted by up to %d "
+                         "does not fit in 64 bits\n", foldedLen, maxShamt);
+                foldedMask = foldedLen ? (~0ULL >> (64 - foldedLen)) : 0;
                 for (int i = 0; i < maxShamt; i++) {
-                    posHighestBitsInGhr.push_back(histLen - 1 - i);
                     posHighestBitsInOldFoldedHist.push_back((histLen - 1 - i) % foldedLen);
                 }
             }
     
     public:
-        boost::dynamic_bitset<> &get() { return folded; }
-        void update(const boost::dynamic_bitset<> &ghr, int shamt, bool taken);
+        uint64_t get() const { return folded; }
+        void update(const PackedHist &ghr, int shamt, bool taken);
         void recover(FoldedHist &other);
-        void check(const boost::dynamic_bitset<> &ghr);
+        /** Rebuild from a whole history, e.g. one restored from a file */
+        void reset(const PackedHist &ghr);
+        void check(const PackedHist &ghr);
     
 };
 
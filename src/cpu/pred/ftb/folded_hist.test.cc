@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2026 Institute of Computing Technology, Chinese Academy of Sciences
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <boost/dynamic_bitset.hpp>
+#include <random>
+#include <tuple>
+#include <vector>
+
+#include "cpu/pred/ftb/folded_hist.hh"
+#include "cpu/pred/ftb/packed_hist.hh"
+
+using namespace gem5::branch_prediction::ftb_pred;
+
+namespace
+{
+
+/** The dynamic_bitset update FoldedHist replaced, kept as the reference */
+class BitsetFoldedHist
+{
+  public:
+    BitsetFoldedHist(int hist_len, int folded_len)
+        : histLen(hist_len), foldedLen(folded_len), folded(folded_len)
+    {}
+
+    void
+    update(const boost::dynamic_bitset<> &ghr, int shamt, bool taken)
+    {
+        boost::dynamic_bitset<> temp(folded);
+        if (foldedLen >= histLen) {
+            temp <<= shamt;
+            for (int i = histLen; i < foldedLen; i++) {
+                temp[i] = 0;
+            }
+            temp[0] = taken;
+        } else {
+            temp.resize(foldedLen + shamt);
+            for (int i = 0; i < shamt; i++) {
+                temp[(histLen - 1 - i) % foldedLen] ^= ghr[histLen - 1 - i];
+            }
+            temp <<= shamt;
+            for (int i = 0; i < shamt; i++) {
+                temp[i] = temp[foldedLen + i];
+            }
+            temp[0] ^= taken;
+            temp.resize(foldedLen);
+        }
+        folded = temp;
+    }
+
+    uint64_t get() const { return folded.to_ulong(); }
+
+  private:
+    int histLen;
+    int foldedLen;
+    boost::dynamic_bitset<> folded;
+};
+
+/**
+ * Drive both implementations with the same random block outcomes and
+ * check they agree after every update. When no block is wider than the
+ * fold, the result must also match a fold of the whole history.
+ */
+void
+compareUpdates(int hist_len, int folded_len, int max_shamt, unsigned seed)
+{
+    SCOPED_TRACE(testing::Message() << "histLen " << hist_len
+                 << " foldedLen " << folded_len << " maxShamt " << max_shamt);
+    const unsigned ghr_len = 970;
+    std::mt19937 rng(seed);
+
+    PackedHist ghr(ghr_len);
+    boost::dynamic_bitset<> ref_ghr(ghr_len);
+    FoldedHist folded(hist_len, folded_len, max_shamt);
+    BitsetFoldedHist ref(hist_len, folded_len);
+    FoldedHist rebuilt(hist_len, folded_len, max_shamt);
+
+    for (int step = 0; step < 2000; step++) {
+        // the predictors skip updates of blocks with no branch
+        int shamt = 1 + rng() % max_shamt;
+        bool taken = rng() & 1;
+
+        folded.update(ghr, shamt, taken);
+        ref.update(ref_ghr, shamt, taken);
+        ghr.shiftIn(shamt, taken);
+        ref_ghr <<= shamt;
+        ref_ghr[0] = taken;
+        ASSERT_EQ(folded.get(), ref.get()) << "step " << step;
+        ASSERT_EQ(folded.get() >> folded_len, 0) << "step " << step;
+
+        if (max_shamt <= folded_len) {
+            rebuilt.reset(ghr);
+            ASSERT_EQ(folded.get(), rebuilt.get()) << "step " << step;
+        }
+    }
+}
+
+} // anonymous namespace
+
+/** Every TAGE and ITTAGE table geometry of the default configs */
+TEST(FoldedHistTest, ConfigGeometries)
+{
+    std::vector<std::tuple<int, int>> geometries;
+    for (int hist_len : {8, 13, 32, 119}) {
+        // index bits of a 2048-entry table, tag bits and the alt tag
+        for (int folded_len : {11, 8, 7}) {
+            geometries.emplace_back(hist_len, folded_len);
+        }
+    }
+    for (int hist_len : {4, 8, 13, 16, 32}) {
+        for (int folded_len : {8, 9, 7}) {
+            geometries.emplace_back(hist_len, folded_len);
+        }
+    }
+
+    unsigned seed = 1;
+    for (auto [hist_len, folded_len] : geometries) {
+        compareUpdates(hist_len, folded_len, 2, seed++);
+    }
+}
+
+/** Blocks wider than the fold wrap more than foldedLen bits */
+TEST(FoldedHistTest, WideBlocks)
+{
+    compareUpdates(32, 3, 8, 100);
+    compareUpdates(119, 5, 16, 101);
+    compareUpdates(64, 7, 32, 102);
+    compareUpdates(6, 16, 12, 103);
+}
+
+/** The fold of the whole history and the incremental one agree */
+TEST(FoldedHistTest, Reset)
+{
+    std::mt19937 rng(7);
+    PackedHist ghr(970);
+    FoldedHist folded(119, 11, 2);
+    for (int step = 0; step < 300; step++) {
+        int shamt = 1 + rng() % 2;
+        bool taken = rng() & 1;
+        folded.update(ghr, shamt, taken);
+        ghr.shiftIn(shamt, taken);
+    }
+
+    FoldedHist restored(119, 11, 2);
+    restored.reset(ghr);
+    ASSERT_EQ(restored.get(), folded.get());
+}
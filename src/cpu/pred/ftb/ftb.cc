@@ -60,18 +60,16 @@ DefaultFTB::DefaultFTB(const Params &p)
         fatal("FTB entries is not a power of 2!");
     }
 
-    ftb.resize(numSets);
-    mruList.resize(numSets);
+    ftb.resize(numEntries);
+    tags.resize(numEntries);
+    mruList.resize(numEntries);
     for (unsigned i = 0; i < numSets; ++i) {
         for (unsigned j = 0; j < numWays; ++j) {
-            ftb[i][0xfffffff-j]; // dummy initialization
+            // dummy tags, out of the way of real ones
+            tags[i * numWays + j] = 0xfffffff - (numWays - 1 - j);
+            mruList[i * numWays + j] = j;
         }
-        auto &set = ftb[i];
-        for (auto it = set.begin(); it != set.end(); it++) {
-            it->second.valid = false;
-            mruList[i].push_back(it);
-        }
-        std::make_heap(mruList[i].begin(), mruList[i].end(), older());
+        touchSet(i);
     }
 
 
@@ -95,7 +93,7 @@ DefaultFTB::tick() {}
 
 void
 DefaultFTB::putPCHistory(Addr startAddr,
-                         const boost::dynamic_bitset<> &history,
+                         const PackedHist &history,
                          std::vector<FullFTBPrediction> &stagePreds)
 {
     TickedFTBEntry find_entry = lookup(startAddr);
@@ -159,16 +157,104 @@ DefaultFTB::getPredictionMeta()
 }
 
 void
-DefaultFTB::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) {}
+DefaultFTB::specUpdateHist(const PackedHist &history, FullFTBPrediction &pred) {}
 
 void
 DefaultFTB::reset()
 {
-    for (unsigned i = 0; i < numSets; ++i) {
-        for (unsigned j = 0; j < numWays; ++j) {
-            ftb[i][j].valid = false;
+    for (auto &entry : ftb) {
+        entry.valid = false;
+    }
+}
+
+void
+DefaultFTB::saveState(BPStateOut &out) const
+{
+    out.section(stateName(), {numSets, numWays, tagBits});
+    out.put(tags);
+    for (unsigned set = 0; set < numSets; set++) {
+        const TickedFTBEntry *entries = &ftb[set * numWays];
+        for (unsigned way = 0; way < numWays; way++) {
+            const auto &entry = entries[way];
+            out.put(entry.valid);
+            out.put(entry.tag);
+            out.put(entry.fallThruAddr);
+            out.put(entry.tid);
+            // ticks mean nothing to the run that loads them, only the
+            // order of use within the set is kept
+            unsigned age = 0;
+            for (unsigned w = 0; w < numWays; w++) {
+                age += entries[w].tick < entry.tick;
+            }
+            out.put(age);
+            out.put((uint32_t)entry.slots.size());
+            for (const auto &slot : entry.slots) {
+                out.put(slot.pc);
+                out.put(slot.target);
+                out.put(slot.isCond);
+                out.put(slot.isIndirect);
+                out.put(slot.isCall);
+                out.put(slot.isReturn);
+                out.put(slot.size);
+                out.put(slot.valid);
+                out.put(slot.alwaysTaken);
+                out.put(slot.ctr);
+            }
+        }
+    }
+}
+
+void
+DefaultFTB::loadState(BPStateIn &in)
+{
+    in.section(stateName(), {numSets, numWays, tagBits});
+    in.get(tags);
+    for (auto &entry : ftb) {
+        in.get(entry.valid);
+        in.get(entry.tag);
+        in.get(entry.fallThruAddr);
+        in.get(entry.tid);
+        unsigned age;
+        in.get(age);
+        entry.tick = age;
+        uint32_t num_slots;
+        in.get(num_slots);
+        entry.slots.resize(num_slots);
+        for (auto &slot : entry.slots) {
+            in.get(slot.pc);
+            in.get(slot.target);
+            in.get(slot.isCond);
+            in.get(slot.isIndirect);
+            in.get(slot.isCall);
+            in.get(slot.isReturn);
+            in.get(slot.size);
+            in.get(slot.valid);
+            in.get(slot.alwaysTaken);
+            in.get(slot.ctr);
         }
     }
+    for (unsigned set = 0; set < numSets; set++) {
+        touchSet(set);
+    }
+}
+
+unsigned
+DefaultFTB::findWay(Addr ftb_idx, Addr ftb_tag) const
+{
+    const Addr *set_tags = &tags[ftb_idx * numWays];
+    unsigned way = numWays;
+    // no early exit, so the compare vectorizes
+    for (unsigned w = 0; w < numWays; w++) {
+        way = set_tags[w] == ftb_tag ? w : way;
+    }
+    return way;
+}
+
+void
+DefaultFTB::touchSet(Addr ftb_idx)
+{
+    unsigned *heap = &mruList[ftb_idx * numWays];
+    std::make_heap(heap, heap + numWays, older{&ftb[ftb_idx * numWays]});
 }
 
 inline
@@ -198,13 +284,8 @@ DefaultFTB::valid(Addr instPC)
 
     assert(ftb_idx < numEntries);
 
-    for (int w = 0; w < numWays; w++) {
-        if (ftb[ftb_idx][w].valid
-            && inst_tag == ftb[ftb_idx][w].tag) {
-            return true;
-        }
-    }
-    return false;
+    unsigned way = findWay(ftb_idx, inst_tag);
+    return way < numWays && ftb[ftb_idx * numWays + way].valid;
 }
 
 // @todo Create some sort of return struct that has both whether or not the
@@ -223,12 +304,13 @@ DefaultFTB::lookup(Addr inst_pc)
 
     assert(ftb_idx < numSets);
     // ignore false hit when lowest bit is 1
-    const auto &it = ftb[ftb_idx].find(ftb_tag);
-    if (it != ftb[ftb_idx].end()) {
-        if (it->second.valid) {
-            it->second.tick = curTick();
-            std::make_heap(mruList[ftb_idx].begin(), mruList[ftb_idx].end(), older());
-            return it->second;
+    unsigned way = findWay(ftb_idx, ftb_tag);
+    if (way < numWays) {
+        auto &entry = ftb[ftb_idx * numWays + way];
+        if (entry.valid) {
+            entry.tick = curTick();
+            touchSet(ftb_idx);
+            return entry;
         }
     }
     return TickedFTBEntry();
@@ -383,20 +465,22 @@ DefaultFTB::update(const FetchStream &stream)
 
     DPRINTF(FTB, "FTB: Updating FTB entry index %#lx tag %#lx\n", ftb_idx, ftb_tag);
 
-    auto it = ftb[ftb_idx].find(ftb_tag);
-    // if the tag is not found and the table is full
-    bool not_found = it == ftb[ftb_idx].end();
+    TickedFTBEntry *set = &ftb[ftb_idx * numWays];
+    unsigned *heap = &mruList[ftb_idx * numWays];
+    unsigned way = findWay(ftb_idx, ftb_tag);
+    // if the tag is not found, the set is always full
+    bool not_found = way == numWays;
 
     if (not_found) {
-        std::pop_heap(mruList[ftb_idx].begin(), mruList[ftb_idx].end(), older());
-        const auto& old_entry = mruList[ftb_idx].back();
-        DPRINTF(FTB, "FTB: Replacing entry with tag %#lx in set %#lx\n", old_entry->first, ftb_idx);
-        ftb[ftb_idx].erase(old_entry->first);
+        std::pop_heap(heap, heap + numWays, older{set});
+        way = heap[numWays - 1];
+        DPRINTF(FTB, "FTB: Replacing entry with tag %#lx in set %#lx\n",
+                tags[ftb_idx * numWays + way], ftb_idx);
     }
 
     auto updatedEntry = stream.updateFTBEntry;
     bool updatedIsOldEntry = stream.updateIsOldEntry;
-    auto entryInFtbNow = ftb[ftb_idx][ftb_tag];
+    auto entryInFtbNow = not_found ? TickedFTBEntry() : set[way];
     // if this entry is old entry, use entry now in ftb to avoid overwriting entry with more branche info
     auto entry_to_write = (updatedIsOldEntry && !not_found) ? FTBEntry(entryInFtbNow) : updatedEntry;
     // train L0 FTB ctrs
@@ -437,7 +521,7 @@ DefaultFTB::update(const FetchStream &stream)
             bool this_cond_actually_taken = stream.exeTaken && stream.exeBranchInfo == ftb_entry.slots[b];
             int ctr_to_be_updated;
             // read newest ctr if hit
-            if (!not_found && it->second.slots.size() > b) {
+            if (!not_found && entryInFtbNow.slots.size() > b) {
                 ctr_to_be_updated = entryInFtbNow.slots[b].ctr;
             } else {
                 ctr_to_be_updated = updatedEntry.slots[b].ctr;
@@ -447,21 +531,17 @@ DefaultFTB::update(const FetchStream &stream)
         }
     }
 
-    ftb[ftb_idx][ftb_tag] = TickedFTBEntry(entry_to_write, curTick());
-    ftb[ftb_idx][ftb_tag].tag = ftb_tag; // in case different ftb has different tags
-
+    set[way] = TickedFTBEntry(entry_to_write, curTick());
+    set[way].tag = ftb_tag; // in case different ftb has different tags
+    tags[ftb_idx * numWays + way] = ftb_tag;
 
     if (not_found) {
-        auto it = ftb[ftb_idx].find(ftb_tag);
-        assert(it != ftb[ftb_idx].end());
-        mruList[ftb_idx].back() = it;
-        std::push_heap(mruList[ftb_idx].begin(), mruList[ftb_idx].end(), older());
+        // the victim is still the last heap element, now with the new tick
+        std::push_heap(heap, heap + numWays, older{set});
     } else {
-        std::make_heap(mruList[ftb_idx].begin(), mruList[ftb_idx].end(), older());
+        touchSet(ftb_idx);
     }
     assert(ftb_idx < numSets);
-    assert(ftb[ftb_idx].size() <= numWays);
-    assert(mruList[ftb_idx].size() <= numWays);
 
     // ftb[ftb_idx].valid = true;
     // set(ftb[ftb_idx].target, target);
@@ -469,16 +549,16 @@ DefaultFTB::update(const FetchStream &stream)
 }
 
 void
-DefaultFTB::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
+DefaultFTB::commitBranch(const FetchStream &stream, const CommittedInst &inst)
 {
     auto meta = std::static_pointer_cast<FTBMeta>(stream.predMetas[getComponentIdx()]);
     auto &entry = meta->entry;
-    auto pc = inst->getPC();
-    auto npc = inst->getNPC();
-    // auto &static_inst = inst->staticInst();
+    auto pc = inst.pc;
+    auto npc = inst.npc;
+    const auto &static_inst = inst.staticInst;
     bool this_branch_hit = meta->hit && branchIsInEntry(entry, pc);
     // bool this_branch_miss = !this_branch_hit;
-    bool cond_not_taken = inst->isCondCtrl() && !inst->branching();
+    bool cond_not_taken = static_inst->isCondCtrl() && !inst.branching;
     bool this_branch_taken = !cond_not_taken; // all uncond should be taken
     Addr this_branch_target = npc;
     const auto &slot = entry.getSlot(pc);
@@ -489,7 +569,7 @@ DefaultFTB::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
         } else {
             ftbStats.allBranchHitNotTakens++;
         }
-        if (inst->isCondCtrl()) {
+        if (static_inst->isCondCtrl()) {
             ftbStats.condHits++;
             if (this_branch_taken) {
                 ftbStats.condHitTakens++;
@@ -505,12 +585,12 @@ DefaultFTB::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
                 }
             }
         }
-        if (inst->isUncondCtrl()) {
+        if (static_inst->isUncondCtrl()) {
             ftbStats.uncondHits++;
         }
         // ignore non-speculative branches (e.g. syscall)
-        if (!inst->isNonSpeculative()) {
-            if (inst->isIndirectCtrl()) {
+        if (!static_inst->isNonSpeculative()) {
+            if (static_inst->isIndirectCtrl()) {
                 ftbStats.indirectHits++;
                 Addr pred_target = slot.target;
                 if (pred_target == this_branch_target) {
@@ -519,10 +599,10 @@ DefaultFTB::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
                     ftbStats.indirectPredWrong++;
                 }
             }
-            if (inst->isCall()) {
+            if (static_inst->isCall()) {
                 ftbStats.callHits++;
             }
-            if (inst->isReturn()) {
+            if (static_inst->isReturn()) {
                 ftbStats.returnHits++;
             }
         }
@@ -533,7 +613,7 @@ DefaultFTB::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
         } else {
             ftbStats.allBranchMissNotTakens++;
         }
-        if (inst->isCondCtrl()) {
+        if (static_inst->isCondCtrl()) {
             ftbStats.condMisses++;
             if (this_branch_taken) {
                 ftbStats.condMissTakens++;
@@ -551,19 +631,19 @@ DefaultFTB::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
                 }
             }
         }
-        if (inst->isUncondCtrl()) {
+        if (static_inst->isUncondCtrl()) {
             ftbStats.uncondMisses++;
         }
         // ignore non-speculative branches (e.g. syscall)
-        if (!inst->isNonSpeculative()) {
-            if (inst->isIndirectCtrl()) {
+        if (!static_inst->isNonSpeculative()) {
+            if (static_inst->isIndirectCtrl()) {
                 ftbStats.indirectMisses++;
                 ftbStats.indirectPredWrong++;
             }
-            if (inst->isCall()) {
+            if (static_inst->isCall()) {
                 ftbStats.callMisses++;
             }
-            if (inst->isReturn()) {
+            if (static_inst->isReturn()) {
                 ftbStats.returnMisses++;
             }
         }
@@ -67,16 +67,16 @@ class DefaultFTB : public TimedBaseFTBPredictor
         TickedFTBEntry() : tick(0) {}
     }TickedFTBEntry;
 
-    using FTBMap = std::map<Addr, TickedFTBEntry>;
-    using FTBMapIter = typename FTBMap::iterator;
-    using FTBHeap = std::vector<FTBMapIter>;
-
-
+    /**
+     * Heap order of the replacement state: the way used least recently is
+     * on top. Ways are indices into the entries of one set.
+     */
     struct older
     {
-        bool operator()(const FTBMapIter &a, const FTBMapIter &b) const
+        const TickedFTBEntry *set;
+        bool operator()(unsigned a, unsigned b) const
         {
-            return a->second.tick > b->second.tick;
+            return set[a].tick > set[b].tick;
         }
     };
 
@@ -84,12 +84,12 @@ class DefaultFTB : public TimedBaseFTBPredictor
     
     void tick() override;
 
-    void putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+    void putPCHistory(Addr startAddr, const PackedHist &history,
                       std::vector<FullFTBPrediction> &stagePreds) override;
 
     std::shared_ptr<void> getPredictionMeta() override;
 
-    void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+    void specUpdateHist(const PackedHist &history, FullFTBPrediction &pred) override;
 
     /** Creates a FTB with the given number of entries, number of bits per
      *  tag, and instruction offset amount.
@@ -118,7 +118,11 @@ class DefaultFTB : public TimedBaseFTBPredictor
      */
     void update(const FetchStream &stream) override;
 
-    void commitBranch(const FetchStream &stream, const DynInstPtr &inst) override;
+    void saveState(BPStateOut &out) const override;
+
+    void loadState(BPStateIn &in) override;
+
+    void commitBranch(const FetchStream &stream, const CommittedInst &inst) override;
 
     /**
      * @brief derive new ftb entry from old ones and set updateFTBEntry field in stream
@@ -219,11 +223,27 @@ class DefaultFTB : public TimedBaseFTBPredictor
         if (!taken && ctr > -2) {ctr--;}
     }
 
-    /** The actual FTB. */
+    /** Way in set ftb_idx holding ftb_tag, numWays if there is none. */
+    unsigned findWay(Addr ftb_idx, Addr ftb_tag) const;
 
-    std::vector<FTBMap> ftb;
+    /** Rebuild the replacement heap of a set after a tick changed. */
+    void touchSet(Addr ftb_idx);
 
-    std::vector<FTBHeap> mruList;
+    /**
+     * The actual FTB, numWays entries per set, set after set. tags holds
+     * the tag of every way in the same layout, so a lookup only scans
+     * numWays contiguous words. Tags are unique in a set; never written
+     * ways carry dummy tags that no valid entry uses.
+     */
+    std::vector<TickedFTBEntry> ftb;
+
+    std::vector<Addr> tags;
+
+    /**
+     * Per set binary heap of way indices, least recently used on top.
+     * Ways with equal ticks are ordered by their place in the heap.
+     */
+    std::vector<unsigned> mruList;
 
 
     /** The number of entries in the FTB. */
@@ -5,6 +5,7 @@
 #include <ctime>
 
 #include "base/debug_helper.hh"
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/trace.hh"
 #include "cpu/o3/dyn_inst.hh"
@@ -32,23 +33,25 @@ FTBITTAGE::FTBITTAGE(const Params& p)
       numBr(p.numBr)
 {
     DPRINTF(FTBITTAGE || debugFlag, "FTBITTAGE constructor numBr=%d\n", numBr);
-    tageTable.resize(numPredictors);
+    assert(tableSizes.size() >= numPredictors);
+    tableSizes.resize(numPredictors);
+    tageTable.init(tableSizes, 1);
+    tageIndex.resize(numPredictors);
+    tageTag.resize(numPredictors);
     tableIndexBits.resize(numPredictors);
     tableIndexMasks.resize(numPredictors);
     tableTagBits.resize(numPredictors);
     tableTagMasks.resize(numPredictors);
     for (unsigned int i = 0; i < p.numPredictors; ++i) {
-        //initialize ittage predictor
-        assert(tableSizes.size() >= numPredictors);
-        tageTable[i].resize(tableSizes[i]);
-
         tableIndexBits[i] = ceilLog2(tableSizes[i]);
-        tableIndexMasks[i].resize(tableIndexBits[i], true);
+        tableIndexMasks[i] = mask(tableIndexBits[i]);
 
         assert(histLengths.size() >= numPredictors);
 
         assert(tableTagBits.size() >= numPredictors);
-        tableTagMasks[i].resize(tableTagBits[i], true);
+        fatal_if(tableTagBits[i] > 32, "%s: tags of table %u are wider "
+                 "than 32 bits\n", name(), i);
+        tableTagMasks[i] = mask(tableTagBits[i]);
 
         assert(tablePcShifts.size() >= numPredictors);
 
@@ -82,14 +85,22 @@ FTBITTAGE::lookupHelper(Addr startAddr, TageEntry &main_entry, int &main_table,
     main_table_index = -1;
     alt_table_index = -1;
 
+    // index and tag of every table in one pass
+    for (int i = 0; i < numPredictors; i++) {
+        Addr pc = startAddr >> tablePcShifts[i];
+        tageIndex[i] = (pc ^ indexFoldedHist[i].get()) & tableIndexMasks[i];
+        tageTag[i] = (pc ^ tagFoldedHist[i].get() ^
+                      (altTagFoldedHist[i].get() << 1)) & tableTagMasks[i];
+    }
+
     bool provided = false;
     bool alt_provided = false;
     // make main prediction
     int provider_counts = 0;
     for (int i = numPredictors - 1; i >= 0; --i) {
-        Addr tmp_index = getTageIndex(startAddr, i);
-        Addr tmp_tag = getTageTag(startAddr, i);
-        auto &way = tageTable[i][tmp_index];
+        Addr tmp_index = tageIndex[i];
+        Addr tmp_tag = tageTag[i];
+        auto &way = tageTable.at(i, tmp_index, 0);
         bool match = way.valid && matchTag(tmp_tag, way.tag);
         if (match) {
             ++provider_counts;
@@ -136,7 +147,7 @@ FTBITTAGE::lookupHelper(Addr startAddr, TageEntry &main_entry, int &main_table,
 }
 
 void
-FTBITTAGE::putPCHistory(Addr stream_start, const bitset &history, std::vector<FullFTBPrediction> &stagePreds) {
+FTBITTAGE::putPCHistory(Addr stream_start, const PackedHist &history, std::vector<FullFTBPrediction> &stagePreds) {
     // if (debugPC == stream_start) {
     //     debugFlag = true;
     // }
@@ -240,7 +251,7 @@ FTBITTAGE::update(const FetchStream &entry)
             DPRINTF(FTBITTAGE || debugFlag, "prediction provided by table %d, idx %d, updating corresponding entry\n",
                 pred.main_table, pred.main_index);
             assert(pred.main_table < numPredictors && pred.main_index < tableSizes[pred.main_table]);
-            auto &way = tageTable[pred.main_table][pred.main_index];
+            auto &way = tageTable.at(pred.main_table, pred.main_index, 0);
 
             // if (mainTarget != altTarget) { // updateAltDiffers
             //     way.useful = entry.exeBranchInfo.target == mainTarget; // updateProviderCorrect
@@ -261,7 +272,7 @@ FTBITTAGE::update(const FetchStream &entry)
                 DPRINTF(FTBITTAGE, "prediction provided by alt table %d, idx %d, updating corresponding entry\n",
                     pred.alt_table, pred.alt_index);
                 assert(pred.alt_table < numPredictors && pred.alt_index < tableSizes[pred.alt_table]);
-                auto &alt_way = tageTable[pred.alt_table][pred.alt_index];
+                auto &alt_way = tageTable.at(pred.alt_table, pred.alt_index, 0);
                 updateCounter(false, 2, alt_way.counter);
                 if (alt_way.counter == 0) {
                     alt_way.target = entry.exeBranchInfo.target;
@@ -334,11 +345,7 @@ FTBITTAGE::update(const FetchStream &entry)
             }
             if (usefulResetCnt == 256) {
                 DPRINTF(FTBITTAGE || debugFlag, "reset useful bit of all entries\n");
-                for (auto &table : tageTable) {
-                    for (auto &entry : table) {
-                        entry.useful = 0;
-                    }
-                }
+                tageTable.forEach([](TageEntry &entry) { entry.useful = 0; });
                 usefulResetCnt = 0;
             }
         }
@@ -366,8 +373,7 @@ FTBITTAGE::update(const FetchStream &entry)
                 for (int ti = startTable; ti < numPredictors; ti++) {
                     Addr newIndex = getTageIndex(startAddr, ti, updateIndexFoldedHist[ti].get());
                     Addr newTag = getTageTag(startAddr, ti, updateTagFoldedHist[ti].get(), updateAltTagFoldedHist[ti].get());
-                    assert(newIndex < tageTable[ti].size());
-                    auto &newEntry = tageTable[ti][newIndex];
+                    auto &newEntry = tageTable.at(ti, newIndex, 0);
 
                     if (allocate[ti - startTable]) {
                         DPRINTF(FTBITTAGE || debugFlag, "found allocatable entry, table %d, index %d, tag %d, counter %d\n",
@@ -395,15 +401,10 @@ FTBITTAGE::updateCounter(bool taken, unsigned width, short &counter) {
 }
 
 Addr
-FTBITTAGE::getTageTag(Addr pc, int t, bitset &foldedHist, bitset &altFoldedHist)
+FTBITTAGE::getTageTag(Addr pc, int t, uint64_t foldedHist, uint64_t altFoldedHist)
 {
-    bitset buf(tableTagBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    bitset altTagBuf(altFoldedHist);
-    altTagBuf.resize(tableTagBits[t]);
-    altTagBuf <<= 1;
-    buf ^= foldedHist;
-    buf ^= altTagBuf;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist ^ (altFoldedHist << 1)) & tableTagMasks[t];
 }
 
 Addr
@@ -413,11 +414,10 @@ FTBITTAGE::getTageTag(Addr pc, int t)
 }
 
 Addr
-FTBITTAGE::getTageIndex(Addr pc, int t, bitset &foldedHist)
+FTBITTAGE::getTageIndex(Addr pc, int t, uint64_t foldedHist)
 {
-    bitset buf(tableIndexBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    buf ^= foldedHist;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist) & tableIndexMasks[t];
 }
 
 Addr
@@ -451,7 +451,7 @@ FTBITTAGE::satDecrement(int min, short &counter)
 }
 
 void
-FTBITTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool taken)
+FTBITTAGE::doUpdateHist(const PackedHist &history, int shamt, bool taken)
 {
     DPRINTF(FTBITTAGE || debugFlag, "in doUpdateHist, shamt %d, taken %d, history %s\n", shamt, taken, history);
     if (shamt == 0) {
@@ -470,7 +470,7 @@ FTBITTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool
 }
 
 void
-FTBITTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+FTBITTAGE::specUpdateHist(const PackedHist &history, FullFTBPrediction &pred)
 {
     int shamt;
     bool cond_taken;
@@ -479,7 +479,7 @@ FTBITTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPredict
 }
 
 void
-FTBITTAGE::recoverHist(const boost::dynamic_bitset<> &history,
+FTBITTAGE::recoverHist(const PackedHist &history,
     const FetchStream &entry, int shamt, bool cond_taken)
 {
     // TODO: need to get idx
@@ -493,7 +493,67 @@ FTBITTAGE::recoverHist(const boost::dynamic_bitset<> &history,
 }
 
 void
-FTBITTAGE::checkFoldedHist(const boost::dynamic_bitset<> &hist, const char * when)
+FTBITTAGE::recoverFoldedHist(const PackedHist &history)
+{
+    for (int t = 0; t < numPredictors; t++) {
+        indexFoldedHist[t].reset(history);
+        tagFoldedHist[t].reset(history);
+        altTagFoldedHist[t].reset(history);
+    }
+}
+
+void
+FTBITTAGE::resetHist(const PackedHist &history)
+{
+    recoverFoldedHist(history);
+}
+
+std::vector<uint64_t>
+FTBITTAGE::stateGeometry() const
+{
+    std::vector<uint64_t> geometry{numPredictors};
+    for (int t = 0; t < numPredictors; t++) {
+        geometry.insert(geometry.end(),
+                        {tableSizes[t], tableTagBits[t], histLengths[t]});
+    }
+    return geometry;
+}
+
+void
+FTBITTAGE::saveState(BPStateOut &out) const
+{
+    out.section(stateName(), stateGeometry());
+    tageTable.forEach([&](const TageEntry &entry) {
+        out.put(entry.valid);
+        out.put((Addr)entry.tag);
+        out.put(entry.target);
+        out.put(entry.counter);
+        out.put(entry.useful);
+    });
+    out.put(usefulResetCnt);
+    out.put(allocLFSR.lfsr);
+}
+
+void
+FTBITTAGE::loadState(BPStateIn &in)
+{
+    in.section(stateName(), stateGeometry());
+    tageTable.forEach([&](TageEntry &entry) {
+        // tags were saved as Addr
+        Addr tag;
+        in.get(entry.valid);
+        in.get(tag);
+        in.get(entry.target);
+        in.get(entry.counter);
+        in.get(entry.useful);
+        entry.tag = tag;
+    });
+    in.get(usefulResetCnt);
+    in.get(allocLFSR.lfsr);
+}
+
+void
+FTBITTAGE::checkFoldedHist(const PackedHist &hist, const char * when)
 {
     DPRINTF(FTBITTAGE || debugFlag, "checking folded history when %s\n", when);
     DPRINTF(FTBITTAGE || debugFlag, "history:\t%s\n", hist);
@@ -508,7 +568,7 @@ FTBITTAGE::checkFoldedHist(const boost::dynamic_bitset<> &hist, const char * whe
 }
 
 void
-FTBITTAGE::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
+FTBITTAGE::commitBranch(const FetchStream &stream, const CommittedInst &inst)
 {
 }
 
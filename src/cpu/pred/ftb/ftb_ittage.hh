@@ -1,6 +1,8 @@
 #ifndef __CPU_PRED_FTB_ITTAGE_HH__
 #define __CPU_PRED_FTB_ITTAGE_HH__
 
+#include <boost/dynamic_bitset.hpp>
+
 #include <deque>
 #include <map>
 #include <vector>
@@ -10,6 +12,7 @@
 #include "base/types.hh"
 #include "base/sat_counter.hh"
 #include "cpu/inst_seq.hh"
+#include "cpu/pred/ftb/flat_tables.hh"
 #include "cpu/pred/ftb/folded_hist.hh"
 #include "cpu/pred/ftb/stream_struct.hh"
 #include "cpu/pred/ftb/timed_base_pred.hh"
@@ -33,19 +36,20 @@ class FTBITTAGE : public TimedBaseFTBPredictor
   public:
     typedef FTBITTAGEParams Params;
 
+    // 16 bytes, 4 entries to a cache line
     struct TageEntry
     {
         public:
-            bool valid;
-            Addr tag;
             Addr target;
+            uint32_t tag;
             short counter;
+            bool valid;
             bool useful;
 
-            TageEntry() : valid(false), tag(0), target(0), counter(0), useful(false) {}
+            TageEntry() : target(0), tag(0), counter(0), valid(false), useful(false) {}
 
             TageEntry(Addr tag, Addr target, short counter) :
-                        valid(true), tag(tag), target(target), counter(counter), useful(false) {}
+                        target(target), tag(tag), counter(counter), valid(true), useful(false) {}
 
     };
 
@@ -84,21 +88,27 @@ class FTBITTAGE : public TimedBaseFTBPredictor
     void tick() override;
     // make predictions, record in stage preds
     void putPCHistory(Addr startAddr,
-                      const boost::dynamic_bitset<> &history,
+                      const PackedHist &history,
                       std::vector<FullFTBPrediction> &stagePreds) override;
 
     std::shared_ptr<void> getPredictionMeta() override;
 
-    void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+    void specUpdateHist(const PackedHist &history, FullFTBPrediction &pred) override;
 
-    void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+    void recoverHist(const PackedHist &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
     void update(const FetchStream &entry) override;
 
-    void commitBranch(const FetchStream &stream, const DynInstPtr &inst) override;
+    void commitBranch(const FetchStream &stream, const CommittedInst &inst) override;
+
+    void saveState(BPStateOut &out) const override;
+
+    void loadState(BPStateIn &in) override;
+
+    void resetHist(const PackedHist &history) override;
 
     // check folded hists after speculative update and recover
-    void checkFoldedHist(const bitset &history, const char *when);
+    void checkFoldedHist(const PackedHist &history, const char *when);
 
   private:
 
@@ -111,22 +121,25 @@ class FTBITTAGE : public TimedBaseFTBPredictor
 
     Addr getTageIndex(Addr pc, int table);
 
-    Addr getTageIndex(Addr pc, int table, bitset &foldedHist);
+    Addr getTageIndex(Addr pc, int table, uint64_t foldedHist);
 
     Addr getTageTag(Addr pc, int table);
 
-    Addr getTageTag(Addr pc, int table, bitset &foldedHist, bitset &altFoldedHist);
+    Addr getTageTag(Addr pc, int table, uint64_t foldedHist, uint64_t altFoldedHist);
+
+    void doUpdateHist(const PackedHist &history, int shamt, bool taken);
 
-    void doUpdateHist(const bitset &history, int shamt, bool taken);
+    /** Table shapes a saved state has to match */
+    std::vector<uint64_t> stateGeometry() const;
 
     const unsigned numPredictors;
 
     std::vector<unsigned> tableSizes;
     std::vector<unsigned> tableIndexBits;
-    std::vector<bitset> tableIndexMasks;
+    std::vector<Addr> tableIndexMasks;
     // std::vector<uint64_t> tablePcMasks;
     std::vector<unsigned> tableTagBits;
-    std::vector<bitset> tableTagMasks;
+    std::vector<Addr> tableTagMasks;
     std::vector<unsigned> tablePcShifts;
     std::vector<unsigned> histLengths;
     std::vector<FoldedHist> tagFoldedHist;
@@ -137,7 +150,12 @@ class FTBITTAGE : public TimedBaseFTBPredictor
 
     unsigned maxHistLen;
 
-    std::vector<std::vector<TageEntry>> tageTable;
+    FlatTables<TageEntry> tageTable;
+
+    // of every table for the lookup in flight
+    std::vector<Addr> tageIndex;
+
+    std::vector<Addr> tageTag;
 
     bool matchTag(Addr expected, Addr found);
 
@@ -184,7 +202,7 @@ public:
     Addr debugPC2 = 0;
     bool debugFlag = false;
 
-    void recoverFoldedHist(const bitset& history);
+    void recoverFoldedHist(const PackedHist &history);
 
     // void checkFoldedHist(const bitset& history);
 };
@@ -5,6 +5,7 @@
 #include <ctime>
 
 #include "base/debug_helper.hh"
+#include "base/bitfield.hh"
 #include "base/intmath.hh"
 #include "base/trace.hh"
 #include "cpu/o3/dyn_inst.hh"
@@ -39,28 +40,29 @@ FTBTAGE::FTBTAGE(const Params& p)
     }
 
     DPRINTF(FTBTAGE, "FTBTAGE constructor\n");
-    tageTable.resize(numPredictors);
+    fatal_if(numPredictors > 64, "%s: the useful bits of %u tables do not "
+             "fit a 64-bit mask\n", name(), numPredictors);
+    assert(tableSizes.size() >= numPredictors);
+    tableSizes.resize(numPredictors);
+    tageTable.init(tableSizes, numBr);
+    tageIndex.resize(numPredictors);
+    tageTag.resize(numPredictors);
+    tageTakens.resize(numBr);
     tableIndexBits.resize(numPredictors);
     tableIndexMasks.resize(numPredictors);
     tableTagBits.resize(numPredictors);
     tableTagMasks.resize(numPredictors);
     baseTable.resize(baseTableSize);
     for (unsigned int i = 0; i < p.numPredictors; ++i) {
-        //initialize ittage predictor
-        assert(tableSizes.size() >= numPredictors);
-        tageTable[i].resize(tableSizes[i]);
-        for (int j = 0; j < tableSizes[i]; ++j) {
-            tageTable[i][j].resize(numBr);
-        }
-
-
         tableIndexBits[i] = ceilLog2(tableSizes[i]);
-        tableIndexMasks[i].resize(tableIndexBits[i], true);
+        tableIndexMasks[i] = mask(tableIndexBits[i]);
 
         assert(histLengths.size() >= numPredictors);
 
         assert(tableTagBits.size() >= numPredictors);
-        tableTagMasks[i].resize(tableTagBits[i], true);
+        fatal_if(tableTagBits[i] > 32, "%s: tags of table %u are wider "
+                 "than 32 bits\n", name(), i);
+        tableTagMasks[i] = mask(tableTagBits[i]);
 
         assert(tablePcShifts.size() >= numPredictors);
 
@@ -133,101 +135,69 @@ FTBTAGE::tick() {}
 void
 FTBTAGE::tickStart() {}
 
-std::vector<bool>
-FTBTAGE::lookupHelper(Addr startAddr,
-                      std::vector<TageEntry> &main_entries,
-                      std::vector<int> &main_tables,
-                      std::vector<int> &main_table_indices,
-                      std::vector<bool> &use_alt_preds, std::vector<bitset> &usefulMasks)
+void
+FTBTAGE::lookupHelper(Addr startAddr, std::vector<TagePrediction> &preds)
 {
     // DPRINTF(FTBTAGE, "lookupHelper startAddr: %#lx\n", startAddr);
-    for (auto &t : main_tables) { t = -1; }
-    for (auto &t : main_table_indices) { t = -1; }
-
-    std::vector<bool> provided;
-    provided.resize(numBr, false);
+    // index and tag of every table in one pass
+    for (int i = 0; i < numPredictors; i++) {
+        Addr pc = startAddr >> tablePcShifts[i];
+        tageIndex[i] = (pc ^ indexFoldedHist[i].get()) & tableIndexMasks[i];
+        tageTag[i] = (pc ^ tagFoldedHist[i].get() ^
+                      (altTagFoldedHist[i].get() << 1)) & tableTagMasks[i];
+    }
 
+    const auto &altRes = baseTable[getBaseTableIndex(startAddr)];
     for (int b = 0; b < numBr; b++) {
+        auto &pred = preds[b];
+        // no provider reads as table and index -1
+        pred = TagePrediction();
+        pred.table = -1;
+        pred.index = -1;
+
         // make main prediction
         int phyBrIdx = getShuffledBrIndex(startAddr, b);
-        int provider_counts = 0;
         for (int i = numPredictors - 1; i >= 0; --i) {
-            Addr tmp_index = getTageIndex(startAddr, i);
-            Addr tmp_tag = getTageTag(startAddr, i);
-            auto &way = tageTable[i][tmp_index][phyBrIdx];
-            bool match = way.valid && matchTag(tmp_tag, way.tag);
+            const auto &way = tageTable.at(i, tageIndex[i], phyBrIdx);
+            bool match = way.valid && matchTag(tageTag[i], way.tag);
 
             if (match) {
-                main_entries[b] = way;
-                main_tables[b] = i;
-                main_table_indices[b] = tmp_index;
-                ++provider_counts;
+                pred.mainFound = true;
+                pred.mainCounter = way.counter;
+                pred.mainUseful = way.useful;
+                pred.table = i;
+                pred.index = tageIndex[i];
+                pred.tag = way.tag;
                 break;
             }
 
-            usefulMasks[b].resize(numPredictors-i);
-            usefulMasks[b] <<= 1;
-            usefulMasks[b][0] = way.useful;
+            pred.usefulMask = (pred.usefulMask << 1) | way.useful;
             DPRINTF(FTBTAGE, "table %d, index %d, lookup tag %d, tag %d, useful %d\n",
-                i, tmp_index, tmp_tag, way.tag, way.useful);
+                i, tageIndex[i], tageTag[i], way.tag, way.useful);
         }
 
-
-        if (provider_counts > 0) {
-            auto main_entry = main_entries[b];
-            // in RTL, we do not shuffle on useAltCtrs
-            if (useAlt[getUseAltIdx(startAddr)][b] > 0 &&
-                (main_entry.counter == -1 || main_entry.counter == 0)) {
-                use_alt_preds[b] = true;
-            } else {
-                use_alt_preds[b] = false;
-            }
-            provided[b] = true;
-        } else {
-            use_alt_preds[b] = true;
-            provided[b] = false;
-        }
-        DPRINTF(FTBTAGE, "lookup startAddr %#lx cond %d, provider_counts %d, main_table %d, main_table_index %d, use_alt %d\n",
-                    startAddr, b, provider_counts, main_tables[b], main_table_indices[b], use_alt_preds[b]);
+        // in RTL, we do not shuffle on useAltCtrs
+        pred.useAlt = !pred.mainFound ||
+            (useAlt[getUseAltIdx(startAddr)][b] > 0 &&
+             (pred.mainCounter == -1 || pred.mainCounter == 0));
+        pred.altCounter = altRes[phyBrIdx];
+        pred.taken = pred.useAlt ? pred.altCounter >= 0 : pred.mainCounter >= 0;
+        DPRINTF(FTBTAGE, "lookup startAddr %#lx cond %d, provided %d, main_table %d, main_table_index %d, use_alt %d\n",
+                    startAddr, b, pred.mainFound, (int)pred.table, (int)pred.index, pred.useAlt);
     }
-    return provided;
 }
 
 void
-FTBTAGE::putPCHistory(Addr stream_start, const bitset &history, std::vector<FullFTBPrediction> &stagePreds) {
+FTBTAGE::putPCHistory(Addr stream_start, const PackedHist &history, std::vector<FullFTBPrediction> &stagePreds) {
     // DPRINTF(FTBTAGE, "putPCHistory startAddr: %#lx\n", stream_start);
-    std::vector<TageEntry> entries;
-    entries.resize(numBr);
-
-    for (int i = 0; i < numBr; ++i) {
-        entries[i].valid = false;
-    }
-    std::vector<int> main_tables;
-    std::vector<int> main_table_indices;
-    std::vector<bool> use_alt_preds;
-    std::vector<bitset> usefulMasks;
-    std::vector<bool> takens;
-    main_tables.resize(numBr, -1);
-    main_table_indices.resize(numBr, -1);
-    use_alt_preds.resize(numBr, false);
-    usefulMasks.resize(numBr);
-    takens.resize(numBr, false);
-
     // get prediction and save it
-    std::vector<bool> found = lookupHelper(stream_start, entries, main_tables,
-                                    main_table_indices, use_alt_preds, usefulMasks);
-
-
-    std::vector<short> altRes = baseTable.at(getBaseTableIndex(stream_start));
-
-    std::vector<TagePrediction> preds;
+    auto &preds = meta.preds;
     preds.resize(numBr);
+    lookupHelper(stream_start, preds);
+
+    auto &takens = tageTakens;
     for (int b = 0; b < numBr; ++b) {
-        int phyBrIdx = getShuffledBrIndex(stream_start, b);
-        takens[b] = use_alt_preds[b] ? altRes[phyBrIdx] >= 0 : entries[b].counter >= 0;
-        preds[b] = TagePrediction(found[b], entries[b].counter, entries[b].useful, altRes[phyBrIdx],
-            main_tables[b], main_table_indices[b], entries[b].tag, use_alt_preds[b],
-            usefulMasks[b], takens[b]);
+        takens[b] = preds[b].taken;
         tageBankStats[b]->updateStatsWithTagePrediction(preds[b], true);
     }
 
@@ -255,7 +225,6 @@ FTBTAGE::putPCHistory(Addr stream_start, const bitset &history, std::vector<Full
         }
     }
 
-    meta.preds = preds;
     meta.tagFoldedHist = tagFoldedHist;
     meta.altTagFoldedHist = altTagFoldedHist;
     meta.indexFoldedHist = indexFoldedHist;
@@ -343,7 +312,7 @@ FTBTAGE::update(const FetchStream &entry)
         if (mainFound) { // updateProvided
             DPRINTF(FTBTAGE, "prediction provided by table %d, idx %d, updating corresponding entry\n",
                 pred.table, pred.index);
-            auto &way = tageTable[pred.table][pred.index][phyBrIdx];
+            auto &way = tageTable.at(pred.table, pred.index, phyBrIdx);
 
             if (mainTaken != altTaken) { // updateAltDiffers
                 way.useful = this_cond_actually_taken == mainTaken; // updateProviderCorrect
@@ -425,8 +394,11 @@ FTBTAGE::update(const FetchStream &entry)
         DPRINTF(FTBTAGE, "this_cond_mispred %d, use_alt_on_main_found_correct %d, needToAllocate %d\n",
             this_cond_mispred, use_alt_on_main_found_correct, needToAllocate);
 
-        int num_tables_can_allocate = (~pred.usefulMask).count();
-        int total_tables_to_allocate = pred.usefulMask.size();
+        // the tables above the provider, all if there is none
+        unsigned startTable = pred.table + 1;
+        int total_tables_to_allocate = numPredictors - startTable;
+        uint64_t not_useful = ~pred.usefulMask & mask(total_tables_to_allocate);
+        int num_tables_can_allocate = popCount(not_useful);
         bool incUsefulResetCounter = num_tables_can_allocate < (total_tables_to_allocate - num_tables_can_allocate);
         bool decUsefulResetCounter = num_tables_can_allocate > (total_tables_to_allocate - num_tables_can_allocate);
         int changeVal = std::abs(num_tables_can_allocate - (total_tables_to_allocate - num_tables_can_allocate));
@@ -451,13 +423,7 @@ FTBTAGE::update(const FetchStream &entry)
             if (usefulResetCnt[b] == 128) {
                 stat->updateResetU++;
                 DPRINTF(FTBTAGEUseful, "reset useful bit of all entries\n");
-                for (auto &table : tageTable) {
-                    for (auto &entries : table) {
-                        for (auto &entry : entries) {
-                            entry.useful = 0;
-                        }
-                    }
-                }
+                tageTable.forEach([](TageEntry &entry) { entry.useful = 0; });
                 usefulResetCnt[b] = 0;
             }
         }
@@ -465,28 +431,23 @@ FTBTAGE::update(const FetchStream &entry)
         bool allocSuccess, allocFailure;
         if (needToAllocate) {
             // allocate new entry
-            unsigned maskMaxNum = std::pow(2, (numPredictors - (pred.table + 1)));
-            unsigned mask = allocLFSR.get() % maskMaxNum;
-            bitset allocateLFSR(numPredictors - (pred.table + 1), mask);
-            std::string buf;
-            auto flipped_usefulMask = ~pred.usefulMask;
-            bitset masked = allocateLFSR & flipped_usefulMask;
-            bitset allocate = masked.any() ? masked : flipped_usefulMask;
+            uint64_t allocateLFSR = allocLFSR.get() & mask(total_tables_to_allocate);
+            uint64_t masked = allocateLFSR & not_useful;
+            uint64_t allocate = masked ? masked : not_useful;
             short newCounter = this_cond_actually_taken ? 0 : -1;
 
-            bool allocateValid = flipped_usefulMask.any();
+            bool allocateValid = not_useful != 0;
             if (allocateValid) {
                 DPRINTF(FTBTAGE, "allocate new entry\n");
                 stat->updateAllocSuccess++;
                 allocSuccess = true;
-                unsigned startTable = pred.table + 1;
 
                 for (int ti = startTable; ti < numPredictors; ti++) {
                     Addr newIndex = getTageIndex(startAddr, ti, updateIndexFoldedHist[ti].get());
                     Addr newTag = getTageTag(startAddr, ti, updateTagFoldedHist[ti].get(), updateAltTagFoldedHist[ti].get());
-                    auto &entry = tageTable[ti][newIndex][phyBrIdx];
+                    auto &entry = tageTable.at(ti, newIndex, phyBrIdx);
 
-                    if (allocate[ti - startTable]) {
+                    if (bits(allocate, ti - startTable)) {
                         DPRINTF(FTBTAGE, "found allocatable entry, table %d, index %d, tag %d, counter %d\n",
                             ti, newIndex, newTag, newCounter);
                         entry = TageEntry(newTag, newCounter);
@@ -535,15 +496,10 @@ FTBTAGE::updateCounter(bool taken, unsigned width, short &counter) {
 }
 
 Addr
-FTBTAGE::getTageTag(Addr pc, int t, bitset &foldedHist, bitset &altFoldedHist)
+FTBTAGE::getTageTag(Addr pc, int t, uint64_t foldedHist, uint64_t altFoldedHist)
 {
-    bitset buf(tableTagBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    bitset altTagBuf(altFoldedHist);
-    altTagBuf.resize(tableTagBits[t]);
-    altTagBuf <<= 1;
-    buf ^= foldedHist;
-    buf ^= altTagBuf;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist ^ (altFoldedHist << 1)) & tableTagMasks[t];
 }
 
 Addr
@@ -553,11 +509,10 @@ FTBTAGE::getTageTag(Addr pc, int t)
 }
 
 Addr
-FTBTAGE::getTageIndex(Addr pc, int t, bitset &foldedHist)
+FTBTAGE::getTageIndex(Addr pc, int t, uint64_t foldedHist)
 {
-    bitset buf(tableIndexBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    buf ^= foldedHist;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist) & tableIndexMasks[t];
 }
 
 Addr
@@ -614,7 +569,7 @@ FTBTAGE::getUseAltIdx(Addr pc) {
 }
 
 void
-FTBTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool taken)
+FTBTAGE::doUpdateHist(const PackedHist &history, int shamt, bool taken)
 {
     DPRINTF(FTBTAGE, "in doUpdateHist, shamt %d, taken %d, history %s\n", shamt, taken, history);
     if (shamt == 0) {
@@ -633,7 +588,7 @@ FTBTAGE::doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool ta
 }
 
 void
-FTBTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+FTBTAGE::specUpdateHist(const PackedHist &history, FullFTBPrediction &pred)
 {
     int shamt;
     bool cond_taken;
@@ -645,7 +600,7 @@ FTBTAGE::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPredictio
 }
 
 void
-FTBTAGE::recoverHist(const boost::dynamic_bitset<> &history,
+FTBTAGE::recoverHist(const PackedHist &history,
     const FetchStream &entry, int shamt, bool cond_taken)
 {
     std::shared_ptr<TageMeta> predMeta = std::static_pointer_cast<TageMeta>(entry.predMetas[getComponentIdx()]);
@@ -662,7 +617,74 @@ FTBTAGE::recoverHist(const boost::dynamic_bitset<> &history,
 }
 
 void
-FTBTAGE::checkFoldedHist(const boost::dynamic_bitset<> &hist, const char * when)
+FTBTAGE::recoverFoldedHist(const PackedHist &history)
+{
+    for (int t = 0; t < numPredictors; t++) {
+        indexFoldedHist[t].reset(history);
+        tagFoldedHist[t].reset(history);
+        altTagFoldedHist[t].reset(history);
+    }
+}
+
+void
+FTBTAGE::resetHist(const PackedHist &history)
+{
+    recoverFoldedHist(history);
+    sc.resetHist(history);
+}
+
+std::vector<uint64_t>
+FTBTAGE::stateGeometry() const
+{
+    std::vector<uint64_t> geometry{numPredictors, baseTableSize, numBr};
+    for (int t = 0; t < numPredictors; t++) {
+        geometry.insert(geometry.end(),
+                        {tableSizes[t], tableTagBits[t], histLengths[t]});
+    }
+    return geometry;
+}
+
+void
+FTBTAGE::saveState(BPStateOut &out) const
+{
+    out.section(stateName(), stateGeometry());
+
+    tageTable.forEach([&](const TageEntry &entry) {
+        out.put(entry.valid);
+        out.put((Addr)entry.tag);
+        out.put(entry.counter);
+        out.put(entry.useful);
+    });
+    out.put(baseTable);
+    out.put(useAlt);
+    out.put(usefulResetCnt);
+    out.put(allocLFSR.lfsr);
+    sc.saveState(out);
+}
+
+void
+FTBTAGE::loadState(BPStateIn &in)
+{
+    in.section(stateName(), stateGeometry());
+
+    tageTable.forEach([&](TageEntry &entry) {
+        // tags were saved as Addr
+        Addr tag;
+        in.get(entry.valid);
+        in.get(tag);
+        in.get(entry.counter);
+        in.get(entry.useful);
+        entry.tag = tag;
+    });
+    in.get(baseTable);
+    in.get(useAlt);
+    in.get(usefulResetCnt);
+    in.get(allocLFSR.lfsr);
+    sc.loadState(in);
+}
+
+void
+FTBTAGE::checkFoldedHist(const PackedHist &hist, const char * when)
 {
     for (int t = 0; t < numPredictors; t++) {
         for (int type = 0; type < 3; type++) {
@@ -747,11 +769,10 @@ FTBTAGE::StatisticalCorrector::getIndex(Addr pc, int t)
 }
 
 Addr
-FTBTAGE::StatisticalCorrector::getIndex(Addr pc, int t, bitset &foldedHist)
+FTBTAGE::StatisticalCorrector::getIndex(Addr pc, int t, uint64_t foldedHist)
 {
-    bitset buf(tableIndexBits[t], pc >> tablePcShifts[t]);  // lower bits of PC
-    buf ^= foldedHist;
-    return buf.to_ulong();
+    // lower bits of PC
+    return ((pc >> tablePcShifts[t]) ^ foldedHist) & mask(tableIndexBits[t]);
 }
 
 void
@@ -847,7 +868,7 @@ FTBTAGE::StatisticalCorrector::recoverHist(std::vector<FoldedHist> &fh)
 }
 
 void
-FTBTAGE::StatisticalCorrector::doUpdateHist(const boost::dynamic_bitset<> &history,
+FTBTAGE::StatisticalCorrector::doUpdateHist(const PackedHist &history,
     int shamt, bool cond_taken)
 {
     if (shamt == 0) {
@@ -858,6 +879,30 @@ FTBTAGE::StatisticalCorrector::doUpdateHist(const boost::dynamic_bitset<> &histo
     }
 }
 
+void
+FTBTAGE::StatisticalCorrector::saveState(BPStateOut &out) const
+{
+    out.put(scCntTable);
+    out.put(thresholds);
+    out.put(TCs);
+}
+
+void
+FTBTAGE::StatisticalCorrector::loadState(BPStateIn &in)
+{
+    in.get(scCntTable);
+    in.get(thresholds);
+    in.get(TCs);
+}
+
+void
+FTBTAGE::StatisticalCorrector::resetHist(const PackedHist &history)
+{
+    for (int t = 0; t < numPredictors; t++) {
+        foldedHist[t].reset(history);
+    }
+}
+
 FTBTAGE::TageBankStats::TageBankStats(statistics::Group* parent, const char *name, int numPredictors):
     statistics::Group(parent, name),
     ADD_STAT(predTableHits, statistics::units::Count::get(), "hit of each tage table on prediction"),
@@ -935,7 +980,7 @@ FTBTAGE::TageBankStats::updateStatsWithTagePrediction(const TagePrediction &pred
 }
 
 void
-FTBTAGE::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
+FTBTAGE::commitBranch(const FetchStream &stream, const CommittedInst &inst)
 {
 }
 
@@ -1,6 +1,8 @@
 #ifndef __CPU_PRED_FTB_TAGE_HH__
 #define __CPU_PRED_FTB_TAGE_HH__
 
+#include <boost/dynamic_bitset.hpp>
+
 #include <deque>
 #include <map>
 #include <vector>
@@ -9,6 +11,7 @@
 #include "base/sat_counter.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
+#include "cpu/pred/ftb/flat_tables.hh"
 #include "cpu/pred/ftb/folded_hist.hh"
 #include "cpu/pred/ftb/stream_struct.hh"
 #include "cpu/pred/ftb/timed_base_pred.hh"
@@ -33,18 +36,19 @@ class FTBTAGE : public TimedBaseFTBPredictor
   public:
     typedef FTBTAGEParams Params;
 
+    // 8 bytes, 8 entries to a cache line
     struct TageEntry
     {
         public:
-            bool valid;
-            Addr tag;
+            uint32_t tag;
             short counter;
+            bool valid;
             bool useful;
 
-            TageEntry() : valid(false), tag(0), counter(0), useful(false) {}
+            TageEntry() : tag(0), counter(0), valid(false), useful(false) {}
 
             TageEntry(Addr tag, short counter) :
-                      valid(true), tag(tag), counter(counter), useful(false) {}
+                      tag(tag), counter(counter), valid(true), useful(false) {}
 
     };
 
@@ -59,17 +63,13 @@ class FTBTAGE : public TimedBaseFTBPredictor
             Addr index;
             Addr tag;
             bool useAlt;
-            bitset usefulMask;
+            // useful bits of the tables above the provider, bit 0 for the
+            // one right above
+            uint64_t usefulMask;
             bool taken;
 
             TagePrediction() : mainFound(false), mainCounter(0), mainUseful(false), altCounter(0),
-                                table(0), index(0), tag(0), useAlt(false), taken(false) {}
-
-            TagePrediction(bool mainFound, short mainCounter, bool mainUseful, short altCounter, unsigned table,
-                            Addr index, Addr tag, bool useAlt, bitset usefulMask, bool taken) :
-                            mainFound(mainFound), mainCounter(mainCounter), mainUseful(mainUseful), altCounter(altCounter),
-                            table(table), index(index), tag(tag), useAlt(useAlt), usefulMask(usefulMask),
-                            taken(taken) {}
+                                table(0), index(0), tag(0), useAlt(false), usefulMask(0), taken(false) {}
 
 
     };
@@ -83,23 +83,29 @@ class FTBTAGE : public TimedBaseFTBPredictor
     void tick() override;
     // make predictions, record in stage preds
     void putPCHistory(Addr startAddr,
-                      const boost::dynamic_bitset<> &history,
+                      const PackedHist &history,
                       std::vector<FullFTBPrediction> &stagePreds) override;
 
     std::shared_ptr<void> getPredictionMeta() override;
 
-    void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+    void specUpdateHist(const PackedHist &history, FullFTBPrediction &pred) override;
 
-    void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+    void recoverHist(const PackedHist &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
     void update(const FetchStream &entry) override;
 
-    void commitBranch(const FetchStream &stream, const DynInstPtr &inst) override;
+    void commitBranch(const FetchStream &stream, const CommittedInst &inst) override;
+
+    void saveState(BPStateOut &out) const override;
+
+    void loadState(BPStateIn &in) override;
+
+    void resetHist(const PackedHist &history) override;
 
     void setTrace() override;
 
     // check folded hists after speculative update and recover
-    void checkFoldedHist(const bitset &history, const char *when);
+    void checkFoldedHist(const PackedHist &history, const char *when);
 
     // we hash between numBr br slots, depending on lower bits of pc
     // br slot 0 may be tage entry 0 or 1
@@ -111,23 +117,22 @@ class FTBTAGE : public TimedBaseFTBPredictor
 
 
     
-    // return provided
-    std::vector<bool> lookupHelper(Addr stream_start,
-                        std::vector<TageEntry> &main_entries,
-                        std::vector<int> &main_tables, std::vector<int> &main_table_indices,
-                        std::vector<bool> &use_alt_preds, std::vector<bitset> &usefulMasks);
+    void lookupHelper(Addr stream_start, std::vector<TagePrediction> &preds);
 
     Addr getTageIndex(Addr pc, int table);
 
-    Addr getTageIndex(Addr pc, int table, bitset &foldedHist);
+    Addr getTageIndex(Addr pc, int table, uint64_t foldedHist);
 
     Addr getTageTag(Addr pc, int table);
 
-    Addr getTageTag(Addr pc, int table, bitset &foldedHist, bitset &altFoldedHist);
+    Addr getTageTag(Addr pc, int table, uint64_t foldedHist, uint64_t altFoldedHist);
 
     unsigned getBaseTableIndex(Addr pc);
 
-    void doUpdateHist(const bitset &history, int shamt, bool taken);
+    void doUpdateHist(const PackedHist &history, int shamt, bool taken);
+
+    /** Table shapes a saved state has to match */
+    std::vector<uint64_t> stateGeometry() const;
 
     const unsigned numPredictors;
 
@@ -135,10 +140,10 @@ class FTBTAGE : public TimedBaseFTBPredictor
 
     std::vector<unsigned> tableSizes;
     std::vector<unsigned> tableIndexBits;
-    std::vector<bitset> tableIndexMasks;
+    std::vector<Addr> tableIndexMasks;
     // std::vector<uint64_t> tablePcMasks;
     std::vector<unsigned> tableTagBits;
-    std::vector<bitset> tableTagMasks;
+    std::vector<Addr> tableTagMasks;
     std::vector<unsigned> tablePcShifts;
     std::vector<unsigned> histLengths;
     std::vector<FoldedHist> tagFoldedHist;
@@ -149,7 +154,8 @@ class FTBTAGE : public TimedBaseFTBPredictor
 
     unsigned maxHistLen;
 
-    std::vector<std::vector<std::vector<TageEntry>>> tageTable;
+    // table - index - br slot
+    FlatTables<TageEntry> tageTable;
 
     std::vector<std::vector<short>> baseTable;
 
@@ -179,10 +185,13 @@ class FTBTAGE : public TimedBaseFTBPredictor
 
 
 
+    // of every table for the lookup in flight
     std::vector<Addr> tageIndex;
 
     std::vector<Addr> tageTag;
 
+    std::vector<bool> tageTakens;
+
     bool enableSC;
 
     struct TageBankStats : public statistics::Group {
@@ -242,7 +251,7 @@ class FTBTAGE : public TimedBaseFTBPredictor
 
 public:
 
-    void recoverFoldedHist(const bitset& history);
+    void recoverFoldedHist(const PackedHist &history);
 
     // void checkFoldedHist(const bitset& history);
 
@@ -315,7 +324,7 @@ public:
       public:
         Addr getIndex(Addr pc, int t);
 
-        Addr getIndex(Addr pc, int t, bitset &foldedHist);
+        Addr getIndex(Addr pc, int t, uint64_t foldedHist);
 
         std::vector<FoldedHist> getFoldedHist();
 
@@ -325,7 +334,13 @@ public:
 
         void recoverHist(std::vector<FoldedHist> &fh);
 
-        void doUpdateHist(const boost::dynamic_bitset<> &history, int shamt, bool cond_taken);
+        void doUpdateHist(const PackedHist &history, int shamt, bool cond_taken);
+
+        void saveState(BPStateOut &out) const;
+
+        void loadState(BPStateIn &in);
+
+        void resetHist(const PackedHist &history);
 
         void setStats(std::vector<TageBankStats *> stats) {
           this->stats = stats;
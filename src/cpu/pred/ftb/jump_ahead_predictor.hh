@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/ftb/bp_state.hh"
 #include "cpu/pred/ftb/stream_struct.hh"
 #include "debug/JumpAheadPredictor.hh"
 
@@ -148,6 +149,35 @@ class JumpAheadPredictor
       }
     }
 
+    void saveState(BPStateOut &out, const std::string &name) const {
+      out.section(name, {numSets, numWays});
+      for (const auto &set : jaStorage) {
+        out.put((uint64_t)set.size());
+        for (const auto &way : set) {
+          out.put(way.first);
+          out.put(way.second.jumpAheadBlockNum);
+          out.put(way.second.conf);
+        }
+      }
+    }
+
+    void loadState(BPStateIn &in, const std::string &name) {
+      in.section(name, {numSets, numWays});
+      for (auto &set : jaStorage) {
+        uint64_t size;
+        in.get(size);
+        set.clear();
+        for (uint64_t i = 0; i < size; i++) {
+          Addr tag;
+          JAEntry entry;
+          in.get(tag);
+          in.get(entry.jumpAheadBlockNum);
+          in.get(entry.conf);
+          set[tag] = entry;
+        }
+      }
+    }
+
     JumpAheadPredictor(unsigned sets, unsigned ways) {
       numSets = sets;
       numWays = ways;
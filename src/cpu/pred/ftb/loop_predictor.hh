@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/ftb/bp_state.hh"
 #include "cpu/pred/ftb/stream_struct.hh"
 #include "debug/LoopPredictor.hh"
 #include "debug/LoopPredictorVerbose.hh"
@@ -336,6 +337,47 @@ training_entry: %d, tripCnt %d, specCnt %d, conf %d; in_main: %d, tripCnt %d, co
 
     bool tripCntTooSmall(const LoopEntry &entry) { return entry.tripCnt <= minTripCntWhenNotConf; }
 
+    void saveState(BPStateOut &out, const std::string &name) const {
+      out.section(name, {numSets, numWays});
+      auto put_set = [&out](const std::map<Addr, LoopEntry> &set) {
+        out.put((uint64_t)set.size());
+        for (const auto &way : set) {
+          out.put(way.first);
+          out.put(way.second.valid);
+          out.put(way.second.tripCnt);
+          out.put(way.second.specCnt);
+          out.put(way.second.conf);
+        }
+      };
+      for (const auto &set : loopStorage) {
+        put_set(set);
+      }
+      put_set(commitLoopStorage);
+    }
+
+    void loadState(BPStateIn &in, const std::string &name) {
+      in.section(name, {numSets, numWays});
+      auto get_set = [&in](std::map<Addr, LoopEntry> &set) {
+        uint64_t size;
+        in.get(size);
+        set.clear();
+        for (uint64_t i = 0; i < size; i++) {
+          Addr tag;
+          LoopEntry entry;
+          in.get(tag);
+          in.get(entry.valid);
+          in.get(entry.tripCnt);
+          in.get(entry.specCnt);
+          in.get(entry.conf);
+          set[tag] = entry;
+        }
+      };
+      for (auto &set : loopStorage) {
+        get_set(set);
+      }
+      get_set(commitLoopStorage);
+    }
+
     LoopPredictor(unsigned sets, unsigned ways, bool e) {
       numSets = sets;
       numWays = ways;
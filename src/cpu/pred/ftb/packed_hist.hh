@@ -0,0 +1,166 @@
+#ifndef __CPU_PRED_FTB_PACKED_HIST_HH__
+#define __CPU_PRED_FTB_PACKED_HIST_HH__
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <ostream>
+
+namespace gem5 {
+
+namespace branch_prediction {
+
+namespace ftb_pred {
+
+/**
+ * Global branch history packed into 64-bit words, bit 0 being the newest.
+ *
+ * Storage is a fixed array of maxBits, so copying a history into every
+ * fetch stream or squash checkpoint never allocates, and shifting in a
+ * block only touches the words covering size() bits.
+ */
+class PackedHist
+{
+  public:
+    static constexpr unsigned maxBits = 1024;
+    static constexpr unsigned wordBits = 64;
+    static constexpr unsigned maxWords = maxBits / wordBits;
+
+    PackedHist() = default;
+
+    explicit PackedHist(unsigned size) : len(size)
+    {
+        assert(size <= maxBits);
+    }
+
+    unsigned size() const { return len; }
+
+    /** Bits past the new size are dropped, new bits are zero */
+    void
+    resize(unsigned size)
+    {
+        assert(size <= maxBits);
+        if (size < len) {
+            for (unsigned w = size / wordBits; w < numWords(); w++) {
+                words[w] &= w == size / wordBits ? lowMask(size % wordBits) : 0;
+            }
+        }
+        len = size;
+    }
+
+    bool
+    operator[](unsigned i) const
+    {
+        assert(i < len);
+        return (words[i / wordBits] >> (i % wordBits)) & 1;
+    }
+
+    void
+    set(unsigned i, bool val)
+    {
+        assert(i < len);
+        uint64_t bit = 1ULL << (i % wordBits);
+        words[i / wordBits] = val ? words[i / wordBits] | bit
+                                  : words[i / wordBits] & ~bit;
+    }
+
+    /**
+     * n bits starting at lo, lo in bit 0 of the result. Bits at or above
+     * size() read as zero.
+     */
+    uint64_t
+    bits(unsigned lo, unsigned n) const
+    {
+        assert(n <= wordBits);
+        if (n == 0 || lo >= len) {
+            return 0;
+        }
+        unsigned w = lo / wordBits, off = lo % wordBits;
+        uint64_t val = words[w] >> off;
+        if (off && w + 1 < maxWords) {
+            val |= words[w + 1] << (wordBits - off);
+        }
+        return val & lowMask(n);
+    }
+
+    /**
+     * Shift in a block of shamt branches, the last of which resolved to
+     * taken, the others not taken.
+     */
+    void
+    shiftIn(unsigned shamt, bool taken)
+    {
+        if (shamt == 0) {
+            return;
+        }
+        *this <<= shamt;
+        words[0] |= taken;
+    }
+
+    PackedHist &
+    operator<<=(unsigned shamt)
+    {
+        unsigned nw = numWords();
+        unsigned ws = shamt / wordBits, bs = shamt % wordBits;
+        for (int w = nw - 1; w >= 0; w--) {
+            uint64_t val = 0;
+            if (w >= (int)ws) {
+                val = words[w - ws] << bs;
+                if (bs && w > (int)ws) {
+                    val |= words[w - ws - 1] >> (wordBits - bs);
+                }
+            }
+            words[w] = val;
+        }
+        if (len % wordBits) {
+            words[nw - 1] &= lowMask(len % wordBits);
+        }
+        return *this;
+    }
+
+    bool
+    operator==(const PackedHist &other) const
+    {
+        if (len != other.len) {
+            return false;
+        }
+        for (unsigned w = 0; w < numWords(); w++) {
+            if (words[w] != other.words[w]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    bool operator!=(const PackedHist &other) const { return !(*this == other); }
+
+    /** Oldest bit first, like boost::dynamic_bitset */
+    friend std::ostream &
+    operator<<(std::ostream &os, const PackedHist &hist)
+    {
+        for (unsigned i = hist.len; i > 0; i--) {
+            os << (hist[i - 1] ? '1' : '0');
+        }
+        return os;
+    }
+
+  private:
+    static uint64_t
+    lowMask(unsigned n)
+    {
+        return n >= wordBits ? ~0ULL : (1ULL << n) - 1;
+    }
+
+    unsigned numWords() const { return (len + wordBits - 1) / wordBits; }
+
+    unsigned len{0};
+    std::array<uint64_t, maxWords> words{};
+};
+
+}  // namespace ftb_pred
+
+}  // namespace branch_prediction
+
+}  // namespace gem5
+
+#endif  // __CPU_PRED_FTB_PACKED_HIST_HH__
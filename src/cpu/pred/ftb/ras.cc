@@ -35,6 +35,37 @@ RAS::RAS(const Params &p)
     //ndepth = 0;
 }
 
+void
+RAS::saveState(BPStateOut &out) const
+{
+    // only the committed stack, nothing is in flight after a load
+    out.section(stateName(), {numEntries, ctrWidth});
+    for (const auto &entry : stack) {
+        out.put(entry.data.retAddr);
+        out.put(entry.data.ctr);
+    }
+    out.put(nsp);
+}
+
+void
+RAS::loadState(BPStateIn &in)
+{
+    in.section(stateName(), {numEntries, ctrWidth});
+    for (auto &entry : stack) {
+        in.get(entry.data.retAddr);
+        in.get(entry.data.ctr);
+    }
+    in.get(nsp);
+    fatal_if(nsp < 0 || nsp >= numEntries, "%s: bad stack pointer %d\n",
+             in.name(), nsp);
+    ssp = nsp;
+    sctr = stack[nsp].data.ctr;
+    TOSW = 0;
+    TOSR = 0;
+    inflightPtrDec(TOSR);
+    BOS = 0;
+}
+
 void
 RAS::checkCorrectness() {
     /*
@@ -55,7 +86,7 @@ RAS::checkCorrectness() {
 }
 
 void
-RAS::putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+RAS::putPCHistory(Addr startAddr, const PackedHist &history,
                   std::vector<FullFTBPrediction> &stagePreds)
 {
     assert(getDelay() < stagePreds.size());
@@ -79,7 +110,7 @@ RAS::getPredictionMeta()
 }
 
 void
-RAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+RAS::specUpdateHist(const PackedHist &history, FullFTBPrediction &pred)
 {
     // do push & pops on prediction
     // pred.returnTarget = stack[sp].retAddr;
@@ -107,7 +138,7 @@ RAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &p
 }
 
 void
-RAS::recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken)
+RAS::recoverHist(const PackedHist &history, const FetchStream &entry, int shamt, bool cond_taken)
 {
     auto takenSlot = entry.exeBranchInfo;
     /*
@@ -377,7 +408,7 @@ RAS::getTop_meta() {
 }
 
 void
-RAS::commitBranch(const FetchStream &stream, const DynInstPtr &inst)
+RAS::commitBranch(const FetchStream &stream, const CommittedInst &inst)
 {
 }
 
@@ -64,21 +64,25 @@ class RAS : public TimedBaseFTBPredictor
             // RASInflightEntry inflight; // inflight top of stack
         }RASMeta;
 
-        void putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+        void putPCHistory(Addr startAddr, const PackedHist &history,
                           std::vector<FullFTBPrediction> &stagePreds) override;
         
         std::shared_ptr<void> getPredictionMeta() override;
 
-        void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+        void specUpdateHist(const PackedHist &history, FullFTBPrediction &pred) override;
 
-        void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+        void recoverHist(const PackedHist &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
         void update(const FetchStream &entry) override;
 
-        void commitBranch(const FetchStream &stream, const DynInstPtr &inst) override;
+        void commitBranch(const FetchStream &stream, const CommittedInst &inst) override;
 
         Addr getTopAddrFromMetas(const FetchStream &stream);
 
+        void saveState(BPStateOut &out) const override;
+
+        void loadState(BPStateIn &in) override;
+
     private:
 
         void push(Addr retAddr);
@@ -1,12 +1,11 @@
 #ifndef __CPU_PRED_FTB_STREAM_STRUCT_HH__
 #define __CPU_PRED_FTB_STREAM_STRUCT_HH__
 
-#include <boost/dynamic_bitset.hpp>
-
 #include "arch/generic/pcstate.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/pred/general_arch_db.hh"
+#include "cpu/pred/ftb/packed_hist.hh"
 #include "cpu/pred/ftb/stream_common.hh"
 #include "cpu/static_inst.hh"
 #include "debug/DecoupleBP.hh"
@@ -238,6 +237,21 @@ using FetchStreamId = uint64_t;
 using FetchTargetId = uint64_t;
 using PredictionID = uint64_t;
 
+/**
+ * A committed instruction, as far as the predictors care. Commit builds
+ * it from the DynInst, BPReplay from a control flow trace.
+ */
+struct CommittedInst
+{
+    Addr pc;
+    /** Where control actually went after this instruction */
+    Addr npc;
+    Addr fallThruPC;
+    bool branching;
+    StaticInstPtr staticInst;
+    FetchStreamId fsqId;
+};
+
 typedef struct LoopEntry {
     bool valid;
     int tripCnt;
@@ -318,7 +332,7 @@ struct FetchStream
 
     Tick predTick{};
     Cycles predCycle{};
-    boost::dynamic_bitset<> history;
+    PackedHist history;
 
     // for profiling
     int fetchInstNum;
@@ -423,7 +437,7 @@ typedef struct FullFTBPrediction
     unsigned predSource;
     Tick predTick;
     Cycles predCycle;
-    boost::dynamic_bitset<> history;
+    PackedHist history;
 
     bool isTaken() {
         auto &ftbEntry = this->ftbEntry;
@@ -546,9 +560,6 @@ typedef struct FullFTBPrediction
         }
     }
 
-    std::vector<boost::dynamic_bitset<>> indexFoldedHist;
-    std::vector<boost::dynamic_bitset<>> tagFoldedHist;
-
     std::pair<int, bool> getHistInfo()
     {
         int shamt = 0;
@@ -15,6 +15,14 @@ TimedBaseFTBPredictor::TimedBaseFTBPredictor(const Params &p)
 {
 }
 
+std::string
+TimedBaseFTBPredictor::stateName() const
+{
+    // the full name depends on where the BPU sits in the system
+    auto dot = name().rfind('.');
+    return dot == std::string::npos ? name() : name().substr(dot + 1);
+}
+
 } // namespace ftb_pred
 
 } // namespace branch_prediction
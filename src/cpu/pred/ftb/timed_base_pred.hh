@@ -1,13 +1,11 @@
 #ifndef __CPU_PRED_FTB_TIMED_BASE_PRED_HH__
 #define __CPU_PRED_FTB_TIMED_BASE_PRED_HH__
 
-
-#include <boost/dynamic_bitset.hpp>
-
 #include "base/statistics.hh"
 #include "base/types.hh"
 #include "cpu/inst_seq.hh"
 #include "cpu/o3/dyn_inst_ptr.hh"
+#include "cpu/pred/ftb/bp_state.hh"
 #include "cpu/pred/ftb/stream_struct.hh"
 #include "sim/sim_object.hh"
 #include "params/TimedBaseFTBPredictor.hh"
@@ -35,17 +33,25 @@ class TimedBaseFTBPredictor: public SimObject
     virtual void tick() {}
     // make predictions, record in stage preds
     virtual void putPCHistory(Addr startAddr,
-                              const boost::dynamic_bitset<> &history,
+                              const PackedHist &history,
                               std::vector<FullFTBPrediction> &stagePreds) {}
 
     virtual std::shared_ptr<void> getPredictionMeta() { return nullptr; }
 
-    virtual void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) {}
-    virtual void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) {}
+    virtual void specUpdateHist(const PackedHist &history, FullFTBPrediction &pred) {}
+    virtual void recoverHist(const PackedHist &history, const FetchStream &entry, int shamt, bool cond_taken) {}
     virtual void update(const FetchStream &entry) {}
     unsigned getDelay() { return numDelay; }
     // do some statistics on a per-branch and per-predictor basis
-    virtual void commitBranch(const FetchStream &entry, const DynInstPtr &inst) {}
+    virtual void commitBranch(const FetchStream &entry, const CommittedInst &inst) {}
+
+    // trained state, saved and loaded to start from a warm predictor
+    virtual void saveState(BPStateOut &out) const {}
+    virtual void loadState(BPStateIn &in) {}
+    // rebuild whatever is derived from the committed global history
+    virtual void resetHist(const PackedHist &history) {}
+    /** Section of the state file, the predictor's name in the BPU */
+    std::string stateName() const;
 
     int componentIdx;
     int getComponentIdx() { return componentIdx; }
@@ -72,7 +72,7 @@ uRAS::setTrace()
 }
 
 void
-uRAS::putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+uRAS::putPCHistory(Addr startAddr, const PackedHist &history,
                   std::vector<FullFTBPrediction> &stagePreds)
 {
     auto &stack = specStack;
@@ -94,7 +94,7 @@ uRAS::getPredictionMeta()
 }
 
 void
-uRAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred)
+uRAS::specUpdateHist(const PackedHist &history, FullFTBPrediction &pred)
 {
     auto &stack = specStack;
     auto &sp = specSp;
@@ -126,7 +126,7 @@ uRAS::specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &
 }
 
 void
-uRAS::recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken)
+uRAS::recoverHist(const PackedHist &history, const FetchStream &entry, int shamt, bool cond_taken)
 {
     auto &stack = specStack;
     auto &sp = specSp;
@@ -197,6 +197,33 @@ uRAS::update(const FetchStream &entry)
     printStack("after update", stack, sp);
 }
 
+void
+uRAS::saveState(BPStateOut &out) const
+{
+    out.section(stateName(), {numEntries, ctrWidth});
+    for (const auto &entry : nonSpecStack) {
+        out.put(entry.retAddr);
+        out.put(entry.ctr);
+    }
+    out.put(nonSpecSp);
+}
+
+void
+uRAS::loadState(BPStateIn &in)
+{
+    in.section(stateName(), {numEntries, ctrWidth});
+    for (auto &entry : nonSpecStack) {
+        in.get(entry.retAddr);
+        in.get(entry.ctr);
+    }
+    in.get(nonSpecSp);
+    fatal_if(nonSpecSp < 0 || nonSpecSp >= numEntries,
+             "%s: bad stack pointer %d\n", in.name(), nonSpecSp);
+    // nothing is in flight, the speculative stack is the committed one
+    specStack = nonSpecStack;
+    specSp = nonSpecSp;
+}
+
 void
 uRAS::push(Addr retAddr, std::vector<uRASEntry> &stack, int &sp)
 {
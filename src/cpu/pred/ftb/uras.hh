@@ -35,17 +35,21 @@ class uRAS : public TimedBaseFTBPredictor
             uRASEntry tos; // top of stack
         }uRASMeta;
 
-        void putPCHistory(Addr startAddr, const boost::dynamic_bitset<> &history,
+        void putPCHistory(Addr startAddr, const PackedHist &history,
                           std::vector<FullFTBPrediction> &stagePreds) override;
         
         std::shared_ptr<void> getPredictionMeta() override;
 
-        void specUpdateHist(const boost::dynamic_bitset<> &history, FullFTBPrediction &pred) override;
+        void specUpdateHist(const PackedHist &history, FullFTBPrediction &pred) override;
 
-        void recoverHist(const boost::dynamic_bitset<> &history, const FetchStream &entry, int shamt, bool cond_taken) override;
+        void recoverHist(const PackedHist &history, const FetchStream &entry, int shamt, bool cond_taken) override;
 
         void update(const FetchStream &entry) override;
 
+        void saveState(BPStateOut &out) const override;
+
+        void loadState(BPStateIn &in) override;
+
         int getSp() {return specSp;}
 
         int getNumEntries() {return numEntries;}
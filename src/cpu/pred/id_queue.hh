@@ -0,0 +1,220 @@
+#ifndef __CPU_PRED_ID_QUEUE_HH__
+#define __CPU_PRED_ID_QUEUE_HH__
+
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace branch_prediction
+{
+
+/**
+ * A queue of entries with consecutive ids, as the fetch stream and fetch
+ * target queues of the decoupled frontends are. Entries live in a ring
+ * indexed by id modulo the capacity, so looking an id up is O(1) and no
+ * entry is allocated on its own.
+ *
+ * The interface is that of the std::map it replaces where it can be:
+ * iterators point to (id, entry) pairs and walk the ids in order. Entries
+ * are appended with the id following the last one, dropped from the front
+ * on commit and from the back on squash. Pointers to an entry stay valid
+ * until it is dropped, a dropped entry is only overwritten once its slot
+ * is reused.
+ */
+template <typename Id, typename T>
+class IdQueue
+{
+  public:
+    using value_type = std::pair<Id, T>;
+
+    template <bool Const>
+    class Iter
+    {
+        using Queue = std::conditional_t<Const, const IdQueue, IdQueue>;
+        using Entry = std::pair<Id, T>;
+        using Value = std::conditional_t<Const, const Entry, Entry>;
+
+        Queue *queue;
+        Id id;
+
+        friend class IdQueue;
+        template <bool> friend class Iter;
+
+      public:
+        using iterator_category = std::bidirectional_iterator_tag;
+        using value_type = Entry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = Value *;
+        using reference = Value &;
+
+        Iter() : queue(nullptr), id(0) {}
+        Iter(Queue *queue, Id id) : queue(queue), id(id) {}
+
+        /** Iterators convert to const iterators */
+        template <bool C, typename = std::enable_if_t<Const && !C>>
+        Iter(const Iter<C> &other) : queue(other.queue), id(other.id) {}
+
+        reference operator*() const { return queue->slot(id); }
+        pointer operator->() const { return &queue->slot(id); }
+
+        Iter &operator++() { ++id; return *this; }
+        Iter operator++(int) { Iter it = *this; ++id; return it; }
+        Iter &operator--() { --id; return *this; }
+        Iter operator--(int) { Iter it = *this; --id; return it; }
+
+        bool operator==(const Iter &other) const { return id == other.id; }
+        bool operator!=(const Iter &other) const { return id != other.id; }
+    };
+
+    using iterator = Iter<false>;
+    using const_iterator = Iter<true>;
+
+    explicit IdQueue(size_t capacity = 0) { setCapacity(capacity); }
+
+    /** Round capacity up to a power of two, only while empty */
+    void
+    setCapacity(size_t capacity)
+    {
+        assert(empty());
+        size_t slots = capacity ? (size_t)1 << ceilLog2(capacity) : 0;
+        entries.assign(slots, value_type());
+        mask = slots ? slots - 1 : 0;
+    }
+
+    size_t capacity() const { return entries.size(); }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+    iterator begin() { return iterator(this, headId); }
+    iterator end() { return iterator(this, headId + count); }
+    const_iterator begin() const { return const_iterator(this, headId); }
+    const_iterator end() const { return const_iterator(this, headId + count); }
+
+    value_type &front() { assert(!empty()); return slot(headId); }
+    value_type &back() { assert(!empty()); return slot(headId + count - 1); }
+    const value_type &
+    front() const
+    {
+        assert(!empty());
+        return slot(headId);
+    }
+    const value_type &
+    back() const
+    {
+        assert(!empty());
+        return slot(headId + count - 1);
+    }
+
+    bool
+    contains(Id id) const
+    {
+        return id - headId < count;
+    }
+
+    iterator find(Id id) { return contains(id) ? iterator(this, id) : end(); }
+
+    const_iterator
+    find(Id id) const
+    {
+        return contains(id) ? const_iterator(this, id) : end();
+    }
+
+    /** The first entry with an id larger than id */
+    iterator
+    upper_bound(Id id)
+    {
+        if (empty() || id < headId) {
+            return begin();
+        }
+        return contains(id) ? iterator(this, id + 1) : end();
+    }
+
+    /**
+     * Append an entry. The id has to follow the last one, any id starts
+     * an empty queue.
+     */
+    std::pair<iterator, bool>
+    emplace(Id id, const T &entry)
+    {
+        panic_if(!empty() && id != headId + count,
+                 "Id %lu does not follow the last one %lu\n", id,
+                 headId + count - 1);
+        panic_if(count == capacity(), "Queue of %lu entries is full\n",
+                 capacity());
+        if (empty()) {
+            headId = id;
+        }
+        auto &s = slot(id);
+        s.first = id;
+        s.second = entry;
+        count++;
+        return std::make_pair(iterator(this, id), true);
+    }
+
+    /** Drop the first entry */
+    void
+    pop_front()
+    {
+        assert(!empty());
+        headId++;
+        count--;
+    }
+
+    /**
+     * Drop the entry at it, which has to be the first one. Returns an
+     * iterator to the next entry.
+     */
+    iterator
+    erase(iterator it)
+    {
+        assert(it == begin());
+        pop_front();
+        return begin();
+    }
+
+    /** Drop every entry up to and including id */
+    void
+    eraseThrough(Id id)
+    {
+        while (!empty() && headId <= id) {
+            pop_front();
+        }
+    }
+
+    /** Drop every entry after id */
+    void
+    eraseAfter(Id id)
+    {
+        if (empty() || id < headId) {
+            count = 0;
+        } else if (contains(id)) {
+            count = id - headId + 1;
+        }
+    }
+
+    void clear() { count = 0; }
+
+  private:
+    value_type &slot(Id id) { return entries[id & mask]; }
+    const value_type &slot(Id id) const { return entries[id & mask]; }
+
+    std::vector<value_type> entries;
+    size_t mask{0};
+    Id headId{0};
+    size_t count{0};
+};
+
+} // namespace branch_prediction
+
+} // namespace gem5
+
+#endif // __CPU_PRED_ID_QUEUE_HH__
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 Institute of Computing Technology, Chinese Academy of Sciences
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "cpu/pred/id_queue.hh"
+
+using namespace gem5::branch_prediction;
+
+namespace
+{
+
+using Queue = IdQueue<uint64_t, int>;
+
+/** The ids in the queue, walked from begin() to end() */
+std::vector<uint64_t>
+ids(const Queue &queue)
+{
+    std::vector<uint64_t> walked;
+    for (auto &entry : queue)
+        walked.push_back(entry.first);
+    return walked;
+}
+
+/** Append the entries start..start + n - 1, each holding 10 times its id */
+void
+fill(Queue &queue, uint64_t start, int n)
+{
+    for (uint64_t id = start; id < start + n; id++)
+        queue.emplace(id, id * 10);
+}
+
+} // anonymous namespace
+
+TEST(IdQueueTest, Emplace)
+{
+    Queue queue(5);
+    ASSERT_EQ(queue.capacity(), 8);
+    ASSERT_TRUE(queue.empty());
+
+    fill(queue, 3, 4);
+    ASSERT_EQ(queue.size(), 4);
+    ASSERT_EQ(queue.front().first, 3);
+    ASSERT_EQ(queue.back().first, 6);
+    ASSERT_EQ(ids(queue), std::vector<uint64_t>({3, 4, 5, 6}));
+
+    ASSERT_TRUE(queue.contains(5));
+    ASSERT_FALSE(queue.contains(2));
+    ASSERT_FALSE(queue.contains(7));
+    ASSERT_EQ(queue.find(5)->second, 50);
+    ASSERT_EQ(queue.find(7), queue.end());
+}
+
+/** Only the id following the last one, or any id when empty, is taken */
+TEST(IdQueueTest, EmplaceOutOfOrder)
+{
+    Queue queue(4);
+    fill(queue, 1, 2);
+    ASSERT_ANY_THROW(queue.emplace(4, 0));
+    ASSERT_ANY_THROW(queue.emplace(2, 0));
+    fill(queue, 3, 2);
+    ASSERT_ANY_THROW(queue.emplace(5, 0));
+    ASSERT_EQ(queue.size(), 4);
+}
+
+TEST(IdQueueTest, UpperBound)
+{
+    Queue queue(8);
+    ASSERT_EQ(queue.upper_bound(0), queue.end());
+
+    fill(queue, 10, 4);
+    ASSERT_EQ(queue.upper_bound(0), queue.begin());
+    ASSERT_EQ(queue.upper_bound(9), queue.begin());
+    ASSERT_EQ(queue.upper_bound(10)->first, 11);
+    ASSERT_EQ(queue.upper_bound(12)->first, 13);
+    ASSERT_EQ(queue.upper_bound(13), queue.end());
+    ASSERT_EQ(queue.upper_bound(100), queue.end());
+
+    // a walk from upper_bound covers the entries after the id
+    std::vector<uint64_t> after;
+    for (auto it = queue.upper_bound(11); it != queue.end(); ++it)
+        after.push_back(it->first);
+    ASSERT_EQ(after, std::vector<uint64_t>({12, 13}));
+}
+
+/** Squashing drops the entries younger than the id */
+TEST(IdQueueTest, EraseAfter)
+{
+    Queue queue(8);
+    queue.eraseAfter(3);
+    ASSERT_TRUE(queue.empty());
+
+    fill(queue, 4, 5);
+    queue.eraseAfter(20);
+    ASSERT_EQ(queue.size(), 5);
+
+    queue.eraseAfter(6);
+    ASSERT_EQ(ids(queue), std::vector<uint64_t>({4, 5, 6}));
+    ASSERT_EQ(queue.back().first, 6);
+    ASSERT_FALSE(queue.contains(7));
+
+    // squashed ids are handed out again
+    fill(queue, 7, 2);
+    ASSERT_EQ(queue.find(8)->second, 80);
+
+    queue.eraseAfter(8);
+    ASSERT_EQ(queue.size(), 5);
+    queue.eraseAfter(3);
+    ASSERT_TRUE(queue.empty());
+}
+
+/** Committing drops the entries up to and including the id */
+TEST(IdQueueTest, EraseThrough)
+{
+    Queue queue(8);
+    fill(queue, 4, 5);
+    queue.eraseThrough(2);
+    ASSERT_EQ(queue.size(), 5);
+
+    queue.eraseThrough(5);
+    ASSERT_EQ(ids(queue), std::vector<uint64_t>({6, 7, 8}));
+    ASSERT_EQ(queue.begin()->first, 6);
+
+    auto next = queue.erase(queue.begin());
+    ASSERT_EQ(next->first, 7);
+    ASSERT_EQ(next, queue.begin());
+
+    queue.eraseThrough(20);
+    ASSERT_TRUE(queue.empty());
+    ASSERT_EQ(queue.begin(), queue.end());
+}
+
+/** Ids past the capacity reuse the slots of dropped entries */
+TEST(IdQueueTest, WrapAround)
+{
+    Queue queue(4);
+    fill(queue, 0, 4);
+    const int *third = &queue.find(2)->second;
+
+    for (uint64_t id = 4; id < 23; id++) {
+        queue.pop_front();
+        queue.emplace(id, id * 10);
+        ASSERT_EQ(queue.front().first, id - 3);
+        ASSERT_EQ(queue.back().second, id * 10);
+        if (id == 5) {
+            // entry 2 is still queued, so its slot is untouched
+            ASSERT_EQ(*third, 20);
+        }
+    }
+    ASSERT_EQ(ids(queue), std::vector<uint64_t>({19, 20, 21, 22}));
+    for (uint64_t id = 19; id < 23; id++)
+        ASSERT_EQ(queue.find(id)->second, id * 10);
+
+    // squash and commit across the end of the slots
+    queue.eraseAfter(20);
+    fill(queue, 21, 2);
+    queue.eraseThrough(19);
+    ASSERT_EQ(ids(queue), std::vector<uint64_t>({20, 21, 22}));
+    ASSERT_EQ(queue.upper_bound(20)->second, 210);
+}
+
+/** An emptied queue restarts at the id of the next entry */
+TEST(IdQueueTest, EmplaceAfterClear)
+{
+    Queue queue(4);
+    fill(queue, 5, 3);
+    queue.clear();
+    ASSERT_TRUE(queue.empty());
+    ASSERT_FALSE(queue.contains(5));
+
+    fill(queue, 100, 4);
+    ASSERT_EQ(ids(queue), std::vector<uint64_t>({100, 101, 102, 103}));
+    ASSERT_EQ(queue.find(101)->second, 1010);
+    ASSERT_EQ(queue.find(6), queue.end());
+
+    // restarting below the old head works as well
+    queue.clear();
+    fill(queue, 1, 2);
+    ASSERT_EQ(queue.front().first, 1);
+    ASSERT_EQ(queue.upper_bound(0)->first, 1);
+    ASSERT_EQ(queue.upper_bound(1)->first, 2);
+}
@@ -35,6 +35,7 @@ DecoupledStreamBPU::DecoupledStreamBPU(const DecoupledStreamBPUParams &p)
 
     // TODO: remove this
     fetchStreamQueueSize = 64;
+    fetchStreamQueue.setCapacity(fetchStreamQueueSize);
     s0PC = 0x80000000;
     s0StreamStartPC = s0PC;
 
@@ -327,7 +328,7 @@ DecoupledStreamBPU::controlSquash(unsigned target_id, unsigned stream_id,
 
     if (squashing_stream_it == fetchStreamQueue.end()) {
         assert(!fetchStreamQueue.empty());
-        assert(fetchStreamQueue.rbegin()->second.getNextStreamStart() == MaxAddr);
+        assert(fetchStreamQueue.back().second.getNextStreamStart() == MaxAddr);
         DPRINTF(
             DecoupleBP || debugFlagOn,
             "The squashing stream is insane, ignore squash on it");
@@ -818,14 +819,14 @@ void DecoupledStreamBPU::update(unsigned stream_id, ThreadID tid)
 void
 DecoupledStreamBPU::squashStreamAfter(unsigned squash_stream_id)
 {
-    auto erase_it = fetchStreamQueue.upper_bound(squash_stream_id);
-    while (erase_it != fetchStreamQueue.end()) {
+    for (auto erase_it = fetchStreamQueue.upper_bound(squash_stream_id);
+         erase_it != fetchStreamQueue.end(); ++erase_it) {
         DPRINTF(DecoupleBP || debugFlagOn || erase_it->second.streamStart == ObservingPC,
                 "Erasing stream %lu when squashing %lu\n", erase_it->first,
                 squash_stream_id);
         printStream(erase_it->second);
-        fetchStreamQueue.erase(erase_it++);
     }
+    fetchStreamQueue.eraseAfter(squash_stream_id);
 }
 
 void
@@ -867,7 +868,7 @@ DecoupledStreamBPU::tryEnqFetchStream()
         bool should_create_new_stream = false;
         if (!fetchStreamQueue.empty()) {
             // check last entry state
-            auto &back = fetchStreamQueue.rbegin()->second;
+            auto &back = fetchStreamQueue.back().second;
             if (back.getEnded()) {
                 should_create_new_stream = true;
                 DPRINTF(DecoupleBP || debugFlagOn,
@@ -891,14 +892,14 @@ DecoupledStreamBPU::tryEnqFetchStream()
         }
         makeNewPrediction(should_create_new_stream);
 
-        const auto &back = fetchStreamQueue.rbegin()->second;
+        const auto &back = fetchStreamQueue.back().second;
         if (!back.getEnded()) {
             // streamMiss = true;
             DPRINTF(DecoupleBP || debugFlagOn, "s0PC update to %#lx\n", s0PC);
         } else {
             DPRINTF(DecoupleBP || debugFlagOn,
                     "stream %lu has ended, s0PC update to %#lx\n",
-                    fetchStreamQueue.rend()->first, s0PC);
+                    fetchStreamQueue.back().first, s0PC);
         }
 
     } else {
@@ -1114,8 +1115,7 @@ DecoupledStreamBPU::makeNewPrediction(bool create_new_stream)
     FetchStream entry_new;
     // TODO: this may be wrong, need to check if we should use the last
     // s0PC
-    auto back = fetchStreamQueue.rbegin();
-    auto &entry = create_new_stream ? entry_new : back->second;
+    auto &entry = create_new_stream ? entry_new : fetchStreamQueue.back().second;
     entry.streamStart = s0StreamStartPC;
     defer _(nullptr, std::bind([this]{ debugFlagOn = false; }));
     if (s0StreamStartPC == ObservingPC) {
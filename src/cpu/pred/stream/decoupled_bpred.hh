@@ -8,6 +8,7 @@
 #include <vector>
 
 #include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/id_queue.hh"
 #include "cpu/pred/stream/fetch_target_queue.hh"
 #include "cpu/pred/stream/stream_struct.hh"
 #include "cpu/pred/stream/ubtb.hh"
@@ -185,7 +186,7 @@ class DecoupledStreamBPU : public BPredUnit
 
     FetchTargetQueue fetchTargetQueue;
 
-    std::map<FetchStreamId, FetchStream> fetchStreamQueue;
+    IdQueue<FetchStreamId, FetchStream> fetchStreamQueue;
     unsigned fetchStreamQueueSize;
     FetchStreamId fsqId{1};
 
@@ -13,7 +13,7 @@ namespace stream_pred
 {
 
 FetchTargetQueue::FetchTargetQueue(unsigned size) :
- ftqSize(size)
+ ftq(size), ftqSize(size)
 {
     fetchTargetEnqState.pc = 0x80000000;
     fetchDemandTargetId = 0;
@@ -60,7 +60,8 @@ FetchTargetQueue::finishCurrentFetchTarget()
 {
 
     ++fetchDemandTargetId;
-    ftq.erase(supplyFetchTargetState.targetId);
+    // entries before it can no longer be demanded either
+    ftq.eraseThrough(supplyFetchTargetState.targetId);
     supplyFetchTargetState.valid = false;
     supplyFetchTargetState.entry = nullptr;
     DPRINTF(DecoupleBP,
@@ -85,7 +86,8 @@ FetchTargetQueue::trySupplyFetchWithTarget(Addr fetch_demand_pc)
                         it->second.startPC, it->second.endPC);
 
                 ++fetchDemandTargetId;
-                it = ftq.erase(it);
+                ftq.eraseThrough(it->first);
+                it = ftq.begin();
                 if (it == ftq.end()) {
                     return false;
                 }
@@ -138,7 +140,7 @@ FetchTargetQueue::enqueue(FtqEntry entry)
 {
     DPRINTF(DecoupleBP, "Enqueueing target %lu with pc %#x and stream %lu\n",
             fetchTargetEnqState.nextEnqTargetId, entry.startPC, entry.fsqID);
-    ftq[fetchTargetEnqState.nextEnqTargetId] = entry;
+    ftq.emplace(fetchTargetEnqState.nextEnqTargetId, entry);
     ++fetchTargetEnqState.nextEnqTargetId;
 }
 
@@ -1,6 +1,7 @@
 #ifndef __CPU_PRED_STREAM_FETCH_TARGET_QUEUE_HH__
 #define __CPU_PRED_STREAM_FETCH_TARGET_QUEUE_HH__
 
+#include "cpu/pred/id_queue.hh"
 #include "cpu/pred/stream/stream_struct.hh"
 #include "sim/sim_object.hh"
 
@@ -34,7 +35,7 @@ class FetchTargetQueue
     // 1. enqueue from fetch stream buffer
     // 2. supply fetch with fetch target head
     // 3. redirect fetch target head after squash
-    using FTQ = std::map<FetchTargetId, FtqEntry>;
+    using FTQ = IdQueue<FetchTargetId, FtqEntry>;
     using FTQIt = FTQ::iterator;
     FTQ ftq;
     unsigned ftqSize;
@@ -104,13 +105,13 @@ class FetchTargetQueue
 
     bool validSupplyFetchTargetState() const;
 
-    FtqEntry &getLastInsertedEntry() { return ftq.rbegin()->second; }
+    FtqEntry &getLastInsertedEntry() { return ftq.back().second; }
 
     bool lastEntryIncomplete() const
     {
         if (ftq.empty())
             return false;
-        const auto &last_entry = ftq.rbegin()->second;
+        const auto &last_entry = ftq.back().second;
         return last_entry.miss() && !last_entry.filledUp();
     }
 
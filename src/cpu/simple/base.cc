@@ -57,6 +57,7 @@
 #include "cpu/exetrace.hh"
 #include "cpu/null_static_inst.hh"
 #include "cpu/pred/bpred_unit.hh"
+#include "cpu/pred/ftb/bp_warmer.hh"
 #include "cpu/simple/exec_context.hh"
 #include "cpu/simple_thread.hh"
 #include "cpu/smt.hh"
@@ -125,6 +126,14 @@ BaseSimpleCPU::BaseSimpleCPU(const BaseSimpleCPUParams &p)
     } else {
         checker = NULL;
     }
+
+    auto ftb_bpu = dynamic_cast<branch_prediction::ftb_pred::
+                                DecoupledBPUWithFTB *>(branchPred);
+    if (ftb_bpu) {
+        fatal_if(numThreads != 1,
+                 "The decoupled FTB predictor does not support SMT");
+        bpWarmer.reset(new branch_prediction::ftb_pred::BPWarmer(ftb_bpu));
+    }
 }
 
 void
@@ -194,6 +203,16 @@ BaseSimpleCPU::~BaseSimpleCPU()
 {
 }
 
+void
+BaseSimpleCPU::switchOut()
+{
+    BaseCPU::switchOut();
+
+    if (bpWarmer) {
+        bpWarmer->switchOut();
+    }
+}
+
 void
 BaseSimpleCPU::haltContext(ThreadID thread_num)
 {
@@ -371,8 +390,15 @@ BaseSimpleCPU::preExecute()
 #endif // TRACING_ON
     }
 
-    if (branchPred && curStaticInst &&
-        curStaticInst->isControl()) {
+    if (bpWarmer) {
+        // a whole macroop is one instruction to the predictor
+        if (curStaticInst && (!curStaticInst->isMicroop() ||
+                              curStaticInst->isFirstMicroop())) {
+            bpWarmer->fetch(curMacroStaticInst ? curMacroStaticInst :
+                            curStaticInst, thread->pcState());
+        }
+    } else if (branchPred && curStaticInst &&
+               curStaticInst->isControl()) {
         // Use a fake sequence number since we only have one
         // instruction in flight at the same time.
         const InstSeqNum cur_sn(0);
@@ -489,7 +515,12 @@ BaseSimpleCPU::advancePC(const Fault &fault)
         }
     }
 
-    if (branchPred && curStaticInst && curStaticInst->isControl()) {
+    if (bpWarmer) {
+        if (fault != NoFault || !curStaticInst ||
+            !curStaticInst->isMicroop() || curStaticInst->isLastMicroop()) {
+            bpWarmer->commit(thread->pcState(), fault != NoFault);
+        }
+    } else if (branchPred && curStaticInst && curStaticInst->isControl()) {
         // Use a fake sequence number since we only have one
         // instruction in flight at the same time.
         const InstSeqNum cur_sn(0);
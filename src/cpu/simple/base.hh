@@ -78,6 +78,10 @@ struct BaseSimpleCPUParams;
 namespace branch_prediction
 {
     class BPredUnit;
+namespace ftb_pred
+{
+    class BPWarmer;
+} // namespace ftb_pred
 } // namespace branch_prediction
 class SimpleExecContext;
 
@@ -87,6 +91,12 @@ class BaseSimpleCPU : public BaseCPU
     ThreadID curThread;
     branch_prediction::BPredUnit *branchPred;
 
+    /**
+     * Drives branchPred when it is a decoupled FTB predictor, which only
+     * works behind a decoupled frontend, e.g. to warm it up for O3.
+     */
+    std::unique_ptr<branch_prediction::ftb_pred::BPWarmer> bpWarmer;
+
     void checkPcEventQueue();
     void swapActiveThread();
 
@@ -94,6 +104,7 @@ class BaseSimpleCPU : public BaseCPU
     BaseSimpleCPU(const BaseSimpleCPUParams &params);
     virtual ~BaseSimpleCPU();
     void wakeup(ThreadID tid) override;
+    void switchOut() override;
   public:
     Trace::InstRecord *traceData;
     CheckerCPU *checker;
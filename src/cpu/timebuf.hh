@@ -31,11 +31,24 @@
 
 #include <cassert>
 #include <cstring>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace gem5
 {
 
+/**
+ * Whether T clears itself in place with reset(), which TimeBuffer then uses
+ * to recycle a slot instead of destroying and constructing it again.
+ */
+template <class T, class = void>
+struct HasReset : std::false_type {};
+
+template <class T>
+struct HasReset<T, std::void_t<decltype(std::declval<T &>().reset())>>
+    : std::true_type {};
+
 template <class T>
 class TimeBuffer
 {
@@ -184,9 +197,15 @@ class TimeBuffer
         int ptr = base + future;
         if (ptr >= (int)size)
             ptr -= size;
-        (reinterpret_cast<T *>(index[ptr]))->~T();
-        std::memset(index[ptr], 0, sizeof(T));
-        new (index[ptr]) T;
+        if constexpr (HasReset<T>::value) {
+            // Has to leave the slot as a new one would be, but keeps
+            // whatever storage it has
+            (reinterpret_cast<T *>(index[ptr]))->reset();
+        } else {
+            (reinterpret_cast<T *>(index[ptr]))->~T();
+            std::memset(index[ptr], 0, sizeof(T));
+            new (index[ptr]) T;
+        }
     }
 
   protected:
@@ -168,7 +168,8 @@ BaseCache::BaseCache(const BaseCacheParams &p, unsigned blk_size)
       system(p.system),
       stats(*this),
       cacheLevel(p.cache_level),
-      forceHit(p.force_hit)
+      forceHit(p.force_hit),
+      prefetchTrainAtomic(p.prefetch_train_atomic)
 {
     // the MSHR queue has no reserve entries as we check the MSHR
     // queue on every single allocation, whereas the write queue has
@@ -994,6 +995,17 @@ BaseCache::recvAtomic(PacketPtr pkt)
     // for an example (though we'd want to issue the prefetch(es)
     // immediately rather than calling requestMemSideBus() as we do
     // there).
+    //
+    // Functional warmup may still let the prefetcher see the accesses,
+    // so that its tables are trained when timing mode starts. Whatever
+    // it queues is only sent from then on.
+    if (prefetchTrainAtomic) {
+        if (satisfied) {
+            ppHit->notify(pkt);
+        } else {
+            ppMiss->notify(pkt);
+        }
+    }
 
     // do any writebacks resulting from the response handling
     doWritebacksAtomic(writebacks);
@@ -1548,6 +1548,9 @@ class BaseCache : public ClockedObject, CacheAccessor
 
     const bool forceHit;
 
+    /** Let atomic accesses train the prefetcher, without prefetching */
+    const bool prefetchTrainAtomic;
+
 public:
     // CacheAccessor overrided function
 
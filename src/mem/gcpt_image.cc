@@ -0,0 +1,489 @@
+#include "mem/gcpt_image.hh"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <future>
+#include <thread>
+
+#include "base/cprintf.hh"
+#include "base/logging.hh"
+#include "mem/mem_util.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace
+{
+
+/** Decode granularity, a multiple of the zero page check */
+constexpr size_t ChunkSize = 1 << 20;
+
+uint16_t
+le16(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8);
+}
+
+uint32_t
+le32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+void
+makeDir(const std::string &path)
+{
+    fatal_if(mkdir(path.c_str(), 0755) != 0 && errno != EEXIST,
+             "Can't create gcpt cache directory %s: %s\n", path, strerror(errno));
+}
+
+std::string
+readSmallFile(const std::string &path)
+{
+    std::string str;
+    FILE *fp = fopen(path.c_str(), "r");
+    if (!fp)
+        return str;
+    char buf[PATH_MAX + 256];
+    size_t n = fread(buf, 1, sizeof(buf), fp);
+    fclose(fp);
+    return std::string(buf, n);
+}
+
+/** Write a file under a temporary name and rename it, so readers never see half of it */
+void
+writeSmallFile(const std::string &path, const std::string &str)
+{
+    std::string tmp = csprintf("%s.%d.tmp", path, getpid());
+    FILE *fp = fopen(tmp.c_str(), "w");
+    if (!fp)
+        return;
+    bool ok = fwrite(str.data(), 1, str.size(), fp) == str.size();
+    ok = fclose(fp) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), path.c_str()) != 0)
+        unlink(tmp.c_str());
+}
+
+} // anonymous namespace
+
+GCptImage::GCptImage(const std::string &path, uint8_t *pmem, uint64_t size,
+                     unsigned threads)
+    : path(path), pmem(pmem), size(size),
+      threads(threads ? threads : std::max(1u, std::thread::hardware_concurrency()))
+{
+    fd = open(path.c_str(), O_RDONLY);
+    fatal_if(fd < 0, "Cannot open compressed file %s: %s\n", path, strerror(errno));
+
+    off_t file_size = lseek(fd, 0, SEEK_END);
+    fatal_if(file_size <= 0, "File size of %s is zero\n", path);
+    dataSize = file_size;
+
+    void *m = mmap(nullptr, dataSize, PROT_READ, MAP_PRIVATE, fd, 0);
+    fatal_if(m == MAP_FAILED, "Cannot map compressed file %s: %s\n", path, strerror(errno));
+    data = (const uint8_t *)m;
+}
+
+GCptImage::~GCptImage()
+{
+    if (data)
+        munmap((void *)data, dataSize);
+    if (fd >= 0)
+        close(fd);
+}
+
+void
+GCptImage::restoreBlocks(BlockDecoder decode)
+{
+    unsigned nthreads = std::min<uint64_t>(threads, blocks.size());
+    inform("Restoring %s: %lu blocks, %lu bytes, %u threads\n", path,
+           blocks.size(), totalBytes, nthreads);
+
+    // madvise is only a hint, the workers touch the input out of order
+    madvise((void *)data, dataSize, MADV_WILLNEED);
+
+    std::vector<Worker> workers(nthreads);
+    std::vector<std::thread> pool;
+    std::atomic<size_t> next{0};
+    std::atomic<bool> failed{false};
+
+    auto run = [&](Worker &w) {
+        w.buf.resize(ChunkSize);
+        size_t i;
+        while (!failed.load(std::memory_order_relaxed) &&
+               (i = next.fetch_add(1, std::memory_order_relaxed)) < blocks.size()) {
+            if (!(this->*decode)(w, blocks[i])) {
+                failed = true;
+                return;
+            }
+        }
+    };
+    for (unsigned t = 1; t < nthreads; t++)
+        pool.emplace_back(run, std::ref(workers[t]));
+    run(workers[0]);
+    for (auto &t : pool)
+        t.join();
+
+    for (auto &w : workers) {
+        fatal_if(!w.err.empty(), "Decompress of %s failed: %s\n", path, w.err);
+        writtenBytes += w.written;
+    }
+}
+
+template <typename Fill>
+void
+GCptImage::restoreStream(Fill fill)
+{
+    inform("Restoring %s as one stream\n", path);
+
+    std::vector<uint8_t> bufs[2] = {std::vector<uint8_t>(ChunkSize),
+                                    std::vector<uint8_t>(ChunkSize)};
+    std::future<uint64_t> copying;
+    unsigned cur = 0;
+    while (totalBytes < size) {
+        size_t want = std::min<uint64_t>(ChunkSize, size - totalBytes);
+        size_t got = fill(bufs[cur].data(), want);
+        if (got == 0)
+            break;
+
+        // The previous chunk has to be in pmem before its buffer is reused
+        if (copying.valid())
+            writtenBytes += copying.get();
+        uint8_t *dst = pmem + totalBytes;
+        const uint8_t *src = bufs[cur].data();
+        if (threads > 1) {
+            copying = std::async(std::launch::async, mem_util::copyNonZeroPages,
+                                 dst, src, got);
+        } else {
+            writtenBytes += mem_util::copyNonZeroPages(dst, src, got);
+        }
+        totalBytes += got;
+        cur ^= 1;
+    }
+    if (copying.valid())
+        writtenBytes += copying.get();
+}
+
+bool
+GCptImage::decodeZstdBlock(Worker &w, const Block &blk)
+{
+    ZSTD_DCtx *dctx = ZSTD_createDCtx();
+    if (!dctx) {
+        w.err = "cannot create zstd context";
+        return false;
+    }
+    ZSTD_inBuffer input = {data + blk.src, blk.srcSize, 0};
+    uint64_t done = 0;
+    while (done < blk.dstSize) {
+        ZSTD_outBuffer output = {w.buf.data(),
+                                 std::min<uint64_t>(w.buf.size(), blk.dstSize - done), 0};
+        size_t ret = ZSTD_decompressStream(dctx, &output, &input);
+        if (ZSTD_isError(ret)) {
+            w.err = ZSTD_getErrorName(ret);
+            break;
+        }
+        if (output.pos == 0) {
+            w.err = csprintf("frame at %#lx is shorter than its content size", blk.src);
+            break;
+        }
+        w.written += mem_util::copyNonZeroPages(pmem + blk.dst + done, w.buf.data(), output.pos);
+        done += output.pos;
+    }
+    ZSTD_freeDCtx(dctx);
+    return w.err.empty();
+}
+
+void
+GCptImage::restoreZstd()
+{
+    // Split the image into frames. All of them must carry their content
+    // size to be placed without decoding the ones before.
+    bool sized = true;
+    for (uint64_t pos = 0; pos < dataSize;) {
+        const uint8_t *frame = data + pos;
+        size_t left = dataSize - pos;
+        size_t csize = ZSTD_findFrameCompressedSize(frame, left);
+        fatal_if(ZSTD_isError(csize), "Corrupted zstd frame at %#lx of %s: %s\n",
+                 pos, path, ZSTD_getErrorName(csize));
+        // Skippable frames, e.g. a seek table, carry no memory content
+        bool skippable = left >= 4 &&
+            (le32(frame) & ZSTD_MAGIC_SKIPPABLE_MASK) == ZSTD_MAGIC_SKIPPABLE_START;
+        if (!skippable) {
+            unsigned long long dsize = ZSTD_getFrameContentSize(frame, left);
+            if (dsize == ZSTD_CONTENTSIZE_UNKNOWN || dsize == ZSTD_CONTENTSIZE_ERROR) {
+                sized = false;
+                break;
+            }
+            blocks.push_back({pos, csize, totalBytes, dsize});
+            totalBytes += dsize;
+        }
+        pos += csize;
+    }
+
+    if (sized && blocks.size() > 1 && threads > 1) {
+        fatal_if(totalBytes > size,
+                 "Decompress failed: binary size %lu is larger than memory %lu!\n",
+                 totalBytes, size);
+        restoreBlocks(&GCptImage::decodeZstdBlock);
+    } else {
+        blocks.clear();
+        totalBytes = 0;
+
+        ZSTD_DCtx *dctx = ZSTD_createDCtx();
+        fatal_if(!dctx, "Cannot create zstd dstream object\n");
+        ZSTD_inBuffer input = {data, dataSize, 0};
+        auto fill = [&](uint8_t *buf, size_t cap) -> size_t {
+            ZSTD_outBuffer output = {buf, cap, 0};
+            // A frame boundary can leave output short while input remains,
+            // keep going until the buffer is full or nothing moves
+            while (output.pos < cap) {
+                size_t out_pos = output.pos, in_pos = input.pos;
+                size_t ret = ZSTD_decompressStream(dctx, &output, &input);
+                fatal_if(ZSTD_isError(ret), "Decompress failed: %s\n",
+                         ZSTD_getErrorName(ret));
+                if (output.pos == out_pos && input.pos == in_pos)
+                    break;
+            }
+            return output.pos;
+        };
+        restoreStream(fill);
+
+        uint8_t extra;
+        fatal_if(totalBytes == size && fill(&extra, 1) != 0,
+                 "Decompress failed: binary size is larger than memory!\n");
+        ZSTD_freeDCtx(dctx);
+    }
+    warn("Total write non-zero bytes: %lu\n", writtenBytes);
+}
+
+bool
+GCptImage::decodeGzBlock(Worker &w, const Block &blk)
+{
+    z_stream zs = {};
+    if (inflateInit2(&zs, 15 + 16) != Z_OK) {
+        w.err = "cannot init zlib stream";
+        return false;
+    }
+    zs.next_in = (Bytef *)(data + blk.src);
+    zs.avail_in = blk.srcSize;
+    uint64_t done = 0;
+    int ret = Z_OK;
+    while (ret != Z_STREAM_END) {
+        zs.next_out = w.buf.data();
+        zs.avail_out = w.buf.size();
+        ret = inflate(&zs, Z_NO_FLUSH);
+        size_t got = zs.next_out - w.buf.data();
+        if (ret != Z_OK && ret != Z_STREAM_END) {
+            w.err = csprintf("bad gzip member at %#lx: %s", blk.src,
+                             zs.msg ? zs.msg : "truncated");
+            break;
+        }
+        if (done + got > blk.dstSize)
+            break;
+        // The last member may hang over the end of memory
+        uint64_t dst = blk.dst + done;
+        size_t fit = dst < size ? std::min<uint64_t>(got, size - dst) : 0;
+        w.written += mem_util::copyNonZeroPages(pmem + dst, w.buf.data(), fit);
+        done += got;
+    }
+    if (w.err.empty() && done != blk.dstSize)
+        w.err = csprintf("gzip member at %#lx has a wrong size", blk.src);
+    inflateEnd(&zs);
+    return w.err.empty();
+}
+
+bool
+GCptImage::findBgzfBlocks()
+{
+    // Every BGZF member is a gzip member with a 'BC' extra subfield
+    // holding its total size, and ends with the 32-bit input size.
+    for (uint64_t pos = 0; pos < dataSize;) {
+        const uint8_t *m = data + pos;
+        uint64_t left = dataSize - pos;
+        if (left < 18 || m[0] != 0x1f || m[1] != 0x8b || m[2] != 8 || !(m[3] & 4))
+            return false;
+        uint16_t xlen = le16(m + 10);
+        if (left < 12u + xlen)
+            return false;
+        uint64_t bsize = 0;
+        for (const uint8_t *sf = m + 12; sf + 4 <= m + 12 + xlen;
+             sf += 4 + le16(sf + 2)) {
+            if (sf[0] == 'B' && sf[1] == 'C' && le16(sf + 2) == 2) {
+                bsize = le16(sf + 4) + 1;
+                break;
+            }
+        }
+        if (bsize < 18u + xlen || bsize > left)
+            return false;
+        uint32_t isize = le32(m + bsize - 4);
+        // Skip the empty end-of-file marker
+        if (isize)
+            blocks.push_back({pos, bsize, totalBytes, isize});
+        totalBytes += isize;
+        pos += bsize;
+    }
+    return true;
+}
+
+void
+GCptImage::restoreGz()
+{
+    if (threads > 1 && findBgzfBlocks() && blocks.size() > 1) {
+        // Keep the old behaviour of ignoring what does not fit
+        while (!blocks.empty() && blocks.back().dst >= size)
+            blocks.pop_back();
+        totalBytes = std::min(totalBytes, size);
+        restoreBlocks(&GCptImage::decodeGzBlock);
+        return;
+    }
+    blocks.clear();
+    totalBytes = 0;
+
+    // Concatenated members are decoded one after the other, like gzread
+    z_stream zs = {};
+    fatal_if(inflateInit2(&zs, 15 + 16) != Z_OK, "Cannot init zlib stream\n");
+    zs.next_in = (Bytef *)data;
+    auto fill = [&](uint8_t *buf, size_t cap) -> size_t {
+        zs.next_out = buf;
+        zs.avail_out = cap;
+        while (zs.avail_out) {
+            // avail_in is 32-bit, feed huge images piecewise
+            uint64_t left = dataSize - (zs.next_in - data);
+            if (zs.avail_in == 0) {
+                if (left == 0)
+                    break;
+                zs.avail_in = std::min<uint64_t>(left, UINT_MAX);
+            }
+            int ret = inflate(&zs, Z_NO_FLUSH);
+            if (ret == Z_STREAM_END) {
+                left = dataSize - (zs.next_in - data);
+                if (left < 2 || zs.next_in[0] != 0x1f || zs.next_in[1] != 0x8b)
+                    break;
+                inflateReset(&zs);
+                zs.avail_in = std::min<uint64_t>(left, UINT_MAX);
+            } else if (ret != Z_OK) {
+                fatal("Decompress of %s failed: %s\n", path,
+                      zs.msg ? zs.msg : "truncated");
+            }
+        }
+        return cap - zs.avail_out;
+    };
+    restoreStream(fill);
+    inflateEnd(&zs);
+}
+
+GCptCache::GCptCache(const std::string &dir, const std::string &image,
+                     const std::string &restorer, unsigned restorer_limit,
+                     uint64_t size)
+    : dir(dir), size(size)
+{
+    makeDir(dir);
+    makeDir(dir + "/index");
+
+    std::string base = image.substr(image.rfind('/') + 1);
+    base = base.substr(0, base.find('.'));
+    std::string restorer_key = restorer.empty() || restorer == "None" ?
+        "none" : contentKey(restorer, restorer_limit);
+    cachePath = csprintf("%s/%s-%s-%s-%#lx.img", dir, base,
+                         contentKey(image, UINT64_MAX), restorer_key, size);
+}
+
+std::string
+GCptCache::contentKey(const std::string &file, uint64_t limit)
+{
+    struct stat st;
+    fatal_if(stat(file.c_str(), &st) != 0, "Can't stat %s: %s\n", file,
+             strerror(errno));
+
+    // The index remembers the hash of files that did not change since
+    uint64_t len = std::min<uint64_t>(st.st_size, limit);
+    char real[PATH_MAX];
+    std::string id = csprintf("%s:%lu:%lu:%ld.%09ld:%lu",
+                              realpath(file.c_str(), real) ? real : file.c_str(),
+                              st.st_dev, st.st_ino, st.st_mtim.tv_sec,
+                              st.st_mtim.tv_nsec, len);
+    std::string memo = csprintf("%s/index/%08x%08x", dir,
+                                crc32(0, (const Bytef *)id.data(), id.size()),
+                                adler32(1, (const Bytef *)id.data(), id.size()));
+    std::string line = readSmallFile(memo);
+    if (line.size() > id.size() + 1 && line.compare(0, id.size(), id) == 0 &&
+        line[id.size()] == '\n') {
+        return line.substr(id.size() + 1);
+    }
+
+    uLong crc = crc32(0, Z_NULL, 0);
+    uLong adler = adler32(0, Z_NULL, 0);
+    int fd = open(file.c_str(), O_RDONLY);
+    fatal_if(fd < 0, "Can't open %s: %s\n", file, strerror(errno));
+    if (len) {
+        void *m = mmap(nullptr, len, PROT_READ, MAP_PRIVATE, fd, 0);
+        fatal_if(m == MAP_FAILED, "Can't map %s: %s\n", file, strerror(errno));
+        madvise(m, len, MADV_SEQUENTIAL);
+        crc = crc32_z(crc, (const Bytef *)m, len);
+        adler = adler32_z(adler, (const Bytef *)m, len);
+        munmap(m, len);
+    }
+    close(fd);
+
+    std::string key = csprintf("%08lx%08lx%lx", crc, adler, len);
+    writeSmallFile(memo, id + "\n" + key);
+    return key;
+}
+
+bool
+GCptCache::map(uint8_t *pmem, bool no_reserve)
+{
+    int fd = open(cachePath.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (uint64_t)st.st_size != size) {
+        warn("Ignoring gcpt cache %s of a wrong size\n", cachePath);
+        close(fd);
+        return false;
+    }
+    // Replace the anonymous backing store in place, the memories keep
+    // pointing at the same address
+    int flags = MAP_PRIVATE | MAP_FIXED | (no_reserve ? MAP_NORESERVE : 0);
+    void *m = mmap(pmem, size, PROT_READ | PROT_WRITE, flags, fd, 0);
+    close(fd);
+    fatal_if(m == MAP_FAILED, "Can't map gcpt cache %s: %s\n", cachePath,
+             strerror(errno));
+    return true;
+}
+
+void
+GCptCache::store(const uint8_t *pmem)
+{
+    std::string tmp = csprintf("%s.%d.tmp", cachePath, getpid());
+    int fd = open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        warn("Can't create gcpt cache %s: %s\n", tmp, strerror(errno));
+        return;
+    }
+
+    bool ok = mem_util::writeNonZeroPages(fd, pmem, size);
+    ok = close(fd) == 0 && ok;
+    if (!ok || rename(tmp.c_str(), cachePath.c_str()) != 0) {
+        warn("Can't write gcpt cache %s: %s\n", cachePath, strerror(errno));
+        unlink(tmp.c_str());
+        return;
+    }
+    inform("Saved restored gcpt to %s\n", cachePath);
+}
+
+} // namespace memory
+} // namespace gem5
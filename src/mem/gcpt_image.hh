@@ -0,0 +1,158 @@
+#ifndef __MEM_GCPT_IMAGE_HH__
+#define __MEM_GCPT_IMAGE_HH__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace gem5
+{
+
+namespace memory
+{
+
+/**
+ * Decompress a gzip/zstd memory image straight into a backing store.
+ *
+ * Pages that are all zero in the image are only written where the backing
+ * store does not already read as zero, so in fresh anonymous memory they
+ * are never allocated, while a reused shared backing store is cleared.
+ *
+ * Images made of independently decodable blocks are restored by threads
+ * workers, each decoding whole blocks at their final offsets:
+ *  - zstd with more than one frame and known frame content sizes, which
+ *    is what `zstd --content-size -B<N>`, pzstd and the seekable format
+ *    produce (skippable frames such as the seek table are ignored);
+ *  - BGZF style gzip (bgzip), where every member records its size.
+ * Any other stream is decoded on one thread while the zero page check
+ * and copy of the previous chunk runs on another.
+ *
+ * threads == 0 means one per host thread.
+ */
+class GCptImage
+{
+  public:
+    GCptImage(const std::string &path, uint8_t *pmem, uint64_t size,
+              unsigned threads);
+    ~GCptImage();
+
+    GCptImage(const GCptImage &) = delete;
+    GCptImage &operator=(const GCptImage &) = delete;
+
+    /**
+     * Restore a zstd image. Fatal if the image does not fit into the
+     * backing store.
+     */
+    void restoreZstd();
+
+    /**
+     * Restore a gzip image. As before, data beyond the end of the backing
+     * store is ignored.
+     */
+    void restoreGz();
+
+    /** Decompressed size of the image */
+    uint64_t decompressed() const { return totalBytes; }
+
+    /** Bytes that were actually written or cleared */
+    uint64_t written() const { return writtenBytes; }
+
+  private:
+    /** One independently decodable piece of the image */
+    struct Block
+    {
+        uint64_t src;
+        uint64_t srcSize;
+        uint64_t dst;
+        uint64_t dstSize;
+    };
+
+    /**
+     * Per worker decoder state. Decoding a block goes through buf chunk by
+     * chunk, so that zero pages can be skipped on the way to pmem.
+     */
+    struct Worker
+    {
+        std::vector<uint8_t> buf;
+        uint64_t written{0};
+        std::string err;
+    };
+
+    using BlockDecoder = bool (GCptImage::*)(Worker &, const Block &);
+
+    bool decodeZstdBlock(Worker &w, const Block &blk);
+    bool decodeGzBlock(Worker &w, const Block &blk);
+
+    void restoreBlocks(BlockDecoder decode);
+
+    /**
+     * Pull chunks of at most the given size from fill (0 at the end of
+     * the stream) and copy them to pmem, overlapping the copy of one
+     * chunk with the decoding of the next when more than one thread is
+     * allowed. Stops at the end of the backing store.
+     */
+    template <typename Fill>
+    void restoreStream(Fill fill);
+
+    bool findBgzfBlocks();
+
+    const std::string path;
+    uint8_t *const pmem;
+    const uint64_t size;
+    unsigned threads;
+
+    int fd{-1};
+    const uint8_t *data{nullptr};
+    uint64_t dataSize{0};
+
+    std::vector<Block> blocks;
+
+    uint64_t totalBytes{0};
+    uint64_t writtenBytes{0};
+};
+
+/**
+ * On-disk cache of restored gcpt images.
+ *
+ * The cached image is the backing store right after restore, i.e. with
+ * the gcpt restorer already written over it. It is named after a content
+ * hash of the compressed image and of the restorer, plus the memory
+ * size, so a changed file never hits a stale entry. Hashing a large image
+ * still costs a read of it, so the content hash is also remembered per
+ * (path, inode, size, mtime) in an index directory.
+ *
+ * Cache files are sparse, zero pages are holes. A hit maps the file
+ * MAP_PRIVATE over the backing store, so pages are read in on demand and
+ * the ones a run never writes stay shared in the page cache between all
+ * the runs of the same checkpoint.
+ */
+class GCptCache
+{
+  public:
+    GCptCache(const std::string &dir, const std::string &image,
+              const std::string &restorer, unsigned restorer_limit,
+              uint64_t size);
+
+    /**
+     * Map the cached image over the backing store at pmem, which must be
+     * a private mapping of size bytes. Returns false on a miss.
+     */
+    bool map(uint8_t *pmem, bool no_reserve);
+
+    /** Save a freshly restored backing store to the cache */
+    void store(const uint8_t *pmem);
+
+    const std::string &path() const { return cachePath; }
+
+  private:
+    std::string contentKey(const std::string &file, uint64_t limit);
+
+    const std::string dir;
+    const uint64_t size;
+    std::string cachePath;
+};
+
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_GCPT_IMAGE_HH__
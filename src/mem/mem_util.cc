@@ -5,11 +5,18 @@
 #include <sys/mman.h>
 #include <unistd.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cerrno>
 #include <cstring>
 #include <string>
 
+#if defined(__AVX2__) || defined(__SSE2__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
 #include <boost/uuid/random_generator.hpp>
 #include <boost/uuid/uuid.hpp>            // uuid class
 #include <boost/uuid/uuid_generators.hpp> // generators
@@ -24,12 +31,98 @@ namespace gem5
 namespace mem_util
 {
 const unsigned pageSize = 4096;
-uint8_t zeroPage[pageSize] = {0};
 bool
 isPageZero(uint8_t *page, std::size_t size)
 {
     assert (size == pageSize);
-    return !memcmp(page, zeroPage, size);
+    return isZero(page, size);
+}
+
+bool
+isZero(const uint8_t *buf, std::size_t size)
+{
+    std::size_t i = 0;
+#if defined(__AVX2__)
+    for (; i + 128 <= size; i += 128) {
+        __m256i acc = _mm256_loadu_si256((const __m256i *)(buf + i));
+        acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i *)(buf + i + 32)));
+        acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i *)(buf + i + 64)));
+        acc = _mm256_or_si256(acc, _mm256_loadu_si256((const __m256i *)(buf + i + 96)));
+        if (!_mm256_testz_si256(acc, acc))
+            return false;
+    }
+#elif defined(__SSE2__)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 64 <= size; i += 64) {
+        __m128i acc = _mm_loadu_si128((const __m128i *)(buf + i));
+        acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i *)(buf + i + 16)));
+        acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i *)(buf + i + 32)));
+        acc = _mm_or_si128(acc, _mm_loadu_si128((const __m128i *)(buf + i + 48)));
+        if (_mm_movemask_epi8(_mm_cmpeq_epi8(acc, zero)) != 0xffff)
+            return false;
+    }
+#elif defined(__aarch64__)
+    for (; i + 64 <= size; i += 64) {
+        uint8x16_t acc = vld1q_u8(buf + i);
+        acc = vorrq_u8(acc, vld1q_u8(buf + i + 16));
+        acc = vorrq_u8(acc, vld1q_u8(buf + i + 32));
+        acc = vorrq_u8(acc, vld1q_u8(buf + i + 48));
+        if (vmaxvq_u8(acc))
+            return false;
+    }
+#endif
+    uint64_t acc = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, buf + i, sizeof(word));
+        acc |= word;
+    }
+    for (; i < size; i++) {
+        acc |= buf[i];
+    }
+    return acc == 0;
+}
+
+std::size_t
+copyNonZeroPages(uint8_t *dst, const uint8_t *src, std::size_t len)
+{
+    // Follow the pages of dst, src may start anywhere inside one
+    std::size_t written = 0;
+    std::size_t n = pageSize - ((uintptr_t)dst & (pageSize - 1));
+    for (std::size_t off = 0; off < len; off += n, n = pageSize) {
+        n = std::min<std::size_t>(n, len - off);
+        if (!isZero(src + off, n)) {
+            memcpy(dst + off, src + off, n);
+            written += n;
+        } else if (!isZero(dst + off, n)) {
+            memset(dst + off, 0, n);
+            written += n;
+        }
+    }
+    return written;
+}
+
+bool
+writeNonZeroPages(int fd, const uint8_t *buf, std::size_t len)
+{
+    if (ftruncate(fd, len) != 0)
+        return false;
+    // Skip the zero pages and write the others in runs
+    for (std::size_t off = 0; off < len;) {
+        while (off < len && isZero(buf + off, std::min<std::size_t>(pageSize, len - off)))
+            off += pageSize;
+        std::size_t end = off;
+        while (end < len && !isZero(buf + end, std::min<std::size_t>(pageSize, len - end)))
+            end += pageSize;
+        end = std::min(end, len);
+        for (; off < end;) {
+            ssize_t n = pwrite(fd, buf + off, end - off, off);
+            if (n <= 0)
+                return false;
+            off += n;
+        }
+    }
+    return true;
 }
 
 DedupMemory::DedupMemory()
@@ -14,6 +14,24 @@ namespace mem_util
     // a 4k zero page
     bool isPageZero(uint8_t *page, std::size_t size);
 
+    // true if all size bytes at buf are zero, vectorized where possible
+    bool isZero(const uint8_t *buf, std::size_t size);
+
+    /**
+     * Copy len bytes from src to dst page by page, skipping the 4k pages
+     * of dst whose data in src is all zero and that already read as zero.
+     * Fresh anonymous memory is only read there, so its zero pages are
+     * never allocated, while stale data of a reused backing store is
+     * cleared. Returns the number of bytes actually written.
+     */
+    std::size_t copyNonZeroPages(uint8_t *dst, const uint8_t *src, std::size_t len);
+
+    /**
+     * Write buf to fd at offset 0 as a sparse file of len bytes, leaving
+     * zero pages as holes. Returns false on an I/O error.
+     */
+    bool writeNonZeroPages(int fd, const uint8_t *buf, std::size_t len);
+
     class DedupMemory
     {
       public:
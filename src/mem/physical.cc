@@ -43,12 +43,13 @@
 #include <sys/user.h>
 #include <unistd.h>
 #include <zlib.h>
-#include <zstd.h>
 
 #include <cerrno>
 #include <climits>
 #include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <string>
 
 #include "base/intmath.hh"
@@ -57,6 +58,7 @@
 #include "debug/AddrRanges.hh"
 #include "debug/Checkpoint.hh"
 #include "mem/abstract_mem.hh"
+#include "mem/gcpt_image.hh"
 #include "mem/mem_util.hh"
 #include "mem/packet.hh"
 #include "sim/serialize.hh"
@@ -93,6 +95,8 @@ PhysicalMemory::PhysicalMemory(const std::string& _name,
                                bool map_to_raw_cpt,
                                bool auto_unlink_shared_backstore,
                                unsigned gcpt_restorer_size_limit,
+                               unsigned gcpt_restore_threads,
+                               const std::string& gcpt_cache_dir,
                                mem_util::DedupMemory *dedup_mem_manager,
                                bool enable_mem_dedup) :
     _name(_name), size(0), mmapUsingNoReserve(mmap_using_noreserve),
@@ -101,6 +105,8 @@ PhysicalMemory::PhysicalMemory(const std::string& _name,
     restoreFromXiangshanCpt(restore_from_gcpt),
     gCptRestorerPath(gcpt_restorer_path),
     xsCptPath(gcpt_path), mapToRawCpt(map_to_raw_cpt), gcptRestorerSizeLimit(gcpt_restorer_size_limit),
+    gcptRestoreThreads(gcpt_restore_threads),
+    gcptCacheDir(gcpt_cache_dir),
     enableDedup(enable_mem_dedup),
     dedupMemManager(dedup_mem_manager)
 {
@@ -317,6 +323,12 @@ PhysicalMemory::~PhysicalMemory()
             munmap((char*)s.pmem, s.range.size());
         }
     }
+    for (auto view : cowViews) {
+        munmap(view, backingStore[0].range.size());
+    }
+    if (imageFd >= 0) {
+        close(imageFd);
+    }
 }
 
 bool
@@ -599,6 +611,9 @@ PhysicalMemory::unserializeStoreFrom(std::string filepath,
             assert(backingStore[store_id].pmem != MAP_FAILED);
             inform("mmap %s to %#lx, setting backing store pointer to it",
                    filepath, (uint64_t)backingStore[store_id].pmem);
+            if (!enableDedup) {
+                imagePath = filepath;
+            }
         }
 
         // For Difftest copy memory
@@ -616,7 +631,26 @@ PhysicalMemory::unserializeStoreFrom(std::string filepath,
             m->setBackingStore(backingStore[store_id].pmem);
         }
         return;
-    } else if (is_gz) {
+    }
+
+    std::unique_ptr<GCptCache> cache;
+    if (!gcptCacheDir.empty()) {
+        if (enableDedup || !sharedBackstore.empty()) {
+            warn("gcpt cache works on a private backing store only, ignored\n");
+        } else {
+            cache = std::make_unique<GCptCache>(
+                gcptCacheDir, filepath,
+                restoreFromXiangshanCpt ? gCptRestorerPath : "",
+                gcptRestorerSizeLimit, backingStore[store_id].range.size());
+            if (cache->map(backingStore[store_id].pmem, mmapUsingNoReserve)) {
+                inform("Restored %s from gcpt cache %s\n", filepath, cache->path());
+                imagePath = cache->path();
+                return;
+            }
+        }
+    }
+
+    if (is_gz) {
         unserializeFromGz(filepath, store_id, range_size);
     } else {  // is zstd
         unserializeFromZstd(filepath, store_id, range_size);
@@ -624,6 +658,14 @@ PhysicalMemory::unserializeStoreFrom(std::string filepath,
 
     overrideGCptRestorer(store_id);
 
+    if (cache) {
+        cache->store(backingStore[store_id].pmem);
+        // Trade the anonymous pages for the page cache shared with later runs
+        if (cache->map(backingStore[store_id].pmem, mmapUsingNoReserve)) {
+            imagePath = cache->path();
+        }
+    }
+
     if (enableDedup) {
         // After restore and overriding, map pmem to one of a branch memory, whose update is not visable to other
         // branches (PRIVATE)
@@ -643,12 +685,6 @@ PhysicalMemory::unserializeStoreFrom(std::string filepath,
 void
 PhysicalMemory::unserializeFromGz(std::string filepath, unsigned store_id, long range_size)
 {
-
-    gzFile compressed_mem = gzopen(filepath.c_str(), "rb");
-
-    if (compressed_mem == nullptr)
-        fatal("Can't open checkpoint file '%s'", filepath.c_str());
-
     // we've already got the actual backing store mapped
     uint8_t* pmem = backingStore[store_id].pmem;
     AddrRange range = backingStore[store_id].range;
@@ -664,35 +700,8 @@ PhysicalMemory::unserializeFromGz(std::string filepath, unsigned store_id, long
         }
     }
 
-    uint64_t curr_size = 0;
-    const uint32_t chunk_size = 16384;
-    long* temp_page = new long[chunk_size];
-    assert(temp_page);
-    long* pmem_current;
-    uint32_t bytes_read;
-    while (curr_size < range.size()) {
-        bytes_read = gzread(compressed_mem, temp_page, chunk_size);
-        if (bytes_read == 0)
-            break;
-
-        assert(bytes_read % sizeof(long) == 0);
-
-        for (uint32_t x = 0; x < bytes_read / sizeof(long); x++) {
-            // Only copy bytes that are non-zero, so we don't give
-            // the VM system hell
-            if (*(temp_page + x) != 0) {
-                pmem_current = (long*)(pmem + curr_size + x * sizeof(long));
-                *pmem_current = *(temp_page + x);
-            }
-        }
-        curr_size += bytes_read;
-    }
-
-    delete[] temp_page;
-
-    if (gzclose(compressed_mem))
-        fatal("Close failed on physical memory checkpoint file '%s'\n",
-              filepath.c_str());
+    GCptImage image(filepath, pmem, range.size(), gcptRestoreThreads);
+    image.restoreGz();
 }
 
 void
@@ -739,114 +748,68 @@ PhysicalMemory::unserializeFromZstd(std::string filepath, unsigned store_id, lon
 {
     uint8_t* pmem = backingStore[store_id].pmem;
     AddrRange range = backingStore[store_id].range;
+    assert(pmem);
 
-    auto fd = open(filepath.c_str(), O_RDONLY);
-    if (fd < 0) {
-        fatal("Cannot open compressed file %s\n", filepath.c_str());
-    }
-
-    auto file_size = lseek(fd, 0, SEEK_END);
-    if (file_size == 0) {
-        fatal("File size is zero\n");
-    }
-    lseek(fd, 0, SEEK_SET);
-
-    auto compress_file_buffer = malloc(file_size);
-    if (!compress_file_buffer) {
-        close(fd);
-        fatal("Compress file buffer create failed\n");
-    }
+    GCptImage image(filepath, pmem, range.size(), gcptRestoreThreads);
+    image.restoreZstd();
+}
 
-    // read compressed file
-    ssize_t compressed_file_buffer_size = read(fd, compress_file_buffer, file_size);
-    warn("Read zstd file size %lu\n", compressed_file_buffer_size);
-    if (compressed_file_buffer_size != file_size) {
-        free(compress_file_buffer);
-        close(fd);
-        fatal("Compress file read failed\n");
+bool
+PhysicalMemory::tryRestoreFromXSCpt(const std::string &path)
+{
+    if (!restoreFromXiangshanCpt) {
+        return false;
     }
-    close(fd);
-
-    // create decompress input buffer
-    ZSTD_inBuffer input = {compress_file_buffer, (size_t)compressed_file_buffer_size, 0};
-
-    // alloc decompress buffer
-    const uint32_t decompress_file_buffer_size = 16384;
-    uint64_t* decompress_file_buffer = (uint64_t*)calloc(decompress_file_buffer_size, sizeof(long));
-    if (!decompress_file_buffer) {
-        free(compress_file_buffer);
-        fatal("Decompress file creating failed\n");
+    if (!path.empty()) {
+        xsCptPath = path;
     }
+    unserializeStoreFromFile(xsCptPath);
+    return true;
+}
 
-
-    // create and init decompress stream object
-    ZSTD_DStream* dstream = ZSTD_createDStream();
-    if (!dstream) {
-        free(compress_file_buffer);
-        free(decompress_file_buffer);
-        fatal("Cannot create zstd dstream object\n");
+void
+PhysicalMemory::shareRestoredImage()
+{
+    if (imageFd >= 0) {
+        return;
     }
-
-    size_t init_result = ZSTD_initDStream(dstream);
-    if (ZSTD_isError(init_result)) {
-        ZSTD_freeDStream(dstream);
-        free(compress_file_buffer);
-        free(decompress_file_buffer);
-        fatal("Cannot init dstream object: %s\n", ZSTD_getErrorName(init_result));
+    panic_if(enableDedup, "Dedup memory shares the image by itself\n");
+    BackingStoreEntry &store = backingStore[0];
+    uint64_t len = store.range.size();
+
+    if (!imagePath.empty()) {
+        imageFd = open(imagePath.c_str(), O_RDONLY);
+        fatal_if(imageFd < 0, "Can't reopen memory image %s: %s\n", imagePath,
+                 strerror(errno));
+        return;
     }
 
-    // decompress and write in memory
-    uint64_t* pmem_current;
-    uint64_t total_write_size = 0;
-    uint64_t non_zero_dword = 0;
-    while (total_write_size < range.size()) {
-        ZSTD_outBuffer output = {decompress_file_buffer, decompress_file_buffer_size * sizeof(long), 0};
-        size_t result = ZSTD_decompressStream(dstream, &output, &input);
-        if (ZSTD_isError(result)) {
-            ZSTD_freeDStream(dstream);
-            free(compress_file_buffer);
-            free(decompress_file_buffer);
-            fatal("Decompress failed: %s\n", ZSTD_getErrorName(result));
-        }
-
-        if (output.pos == 0) {
-            break;
-        }
+    imageFd = memfd_create("gem5-pmem-image", 0);
+    fatal_if(imageFd < 0, "Can't create memory image: %s\n", strerror(errno));
+    fatal_if(!mem_util::writeNonZeroPages(imageFd, store.pmem, len),
+             "Can't write memory image: %s\n", strerror(errno));
 
-        for (uint64_t x = 0; x < output.pos; x += sizeof(long)) {
-            pmem_current = (uint64_t*)(pmem + total_write_size + x);
-            uint64_t read_data = *(decompress_file_buffer + x / sizeof(long));
-            if (read_data != 0 || *pmem_current != 0) {
-                *pmem_current = read_data;
-                non_zero_dword++;
-            }
-        }
-        total_write_size += output.pos;
-    }
-    warn("Total write non-zero bytes: %lu\n", non_zero_dword * 8);
-
-    ZSTD_outBuffer output = {decompress_file_buffer, decompress_file_buffer_size * sizeof(long), 0};
-    size_t result = ZSTD_decompressStream(dstream, &output, &input);
-    if (ZSTD_isError(result) || output.pos != 0) {
-        ZSTD_freeDStream(dstream);
-        free(compress_file_buffer);
-        free(decompress_file_buffer);
-        fatal("Decompress failed: %s. Binary size is larger than memory!\n", ZSTD_getErrorName(result));
+    // A shared backstore has to stay shared, the others become one more view
+    if (sharedBackstore.empty()) {
+        int flags = MAP_PRIVATE | MAP_FIXED | (mmapUsingNoReserve ? MAP_NORESERVE : 0);
+        void *m = mmap(store.pmem, len, PROT_READ | PROT_WRITE, flags, imageFd, 0);
+        fatal_if(m == MAP_FAILED, "Can't remap memory onto its image: %s\n",
+                 strerror(errno));
     }
-
-    ZSTD_freeDStream(dstream);
-    free(compress_file_buffer);
-    free(decompress_file_buffer);
+    inform("Shared the restored memory image, %lu bytes\n", len);
 }
 
-bool
-PhysicalMemory::tryRestoreFromXSCpt()
+uint8_t *
+PhysicalMemory::createCopyOnWriteView()
 {
-    if (!restoreFromXiangshanCpt) {
-        return false;
-    }
-    unserializeStoreFromFile(xsCptPath);
-    return true;
+    shareRestoredImage();
+    uint64_t len = backingStore[0].range.size();
+    void *m = mmap(nullptr, len, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_NORESERVE,
+                   imageFd, 0);
+    fatal_if(m == MAP_FAILED, "Can't map a view of the memory image: %s\n",
+             strerror(errno));
+    cowViews.push_back((uint8_t *)m);
+    return (uint8_t *)m;
 }
 
 } // namespace memory
@@ -185,6 +185,21 @@ class PhysicalMemory : public Serializable
 
     unsigned gcptRestorerSizeLimit{false};
 
+    // Threads decompressing the gcpt image, 0 for all host threads
+    unsigned gcptRestoreThreads;
+
+    // Directory caching restored gcpt images, empty to disable
+    std::string gcptCacheDir;
+
+    // File holding the restored image when the backing store is a
+    // private mapping of it (raw cpt or gcpt cache)
+    std::string imagePath;
+
+    // Read-only restored image behind copy-on-write views, -1 until shared
+    int imageFd{-1};
+
+    std::vector<uint8_t *> cowViews;
+
     bool enableDedup;
 
     mem_util::DedupMemory *dedupMemManager;
@@ -224,6 +239,8 @@ class PhysicalMemory : public Serializable
                    bool map_to_raw_cpt,
                    bool auto_unlink_shared_backstore,
                    unsigned gcpt_restorer_size_limit,
+                   unsigned gcpt_restore_threads,
+                   const std::string& gcpt_cache_dir,
                    mem_util::DedupMemory *dedup_mem_manager,
                    bool enable_mem_dedup);
 
@@ -338,9 +355,24 @@ class PhysicalMemory : public Serializable
     void unserializeStoreFromFile(std::string filepath);
 
     /**
-     * Try to restore from xiangshan cpt file, return true if succeed
+     * Try to restore from xiangshan cpt file, return true if succeed.
+     * A non-empty path replaces the gcpt file given at construction.
+     */
+    bool tryRestoreFromXSCpt(const std::string &path = "");
+
+    /**
+     * Freeze the memory image as restored so far, so that copy-on-write
+     * views of it can be created later. Without a backing file the image
+     * is copied into a sparse memfd and the backing store is remapped onto
+     * it as well, so the simulated memory does not hold a copy of its own.
+     */
+    void shareRestoredImage();
+
+    /**
+     * Private mapping of the image frozen by shareRestoredImage. Pages are
+     * shared with every other view until written.
      */
-    bool tryRestoreFromXSCpt();
+    uint8_t *createCopyOnWriteView();
 
 };
 
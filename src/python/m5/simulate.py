@@ -340,7 +340,7 @@ def notifyFork(root):
         obj.notifyFork()
 
 fork_count = 0
-def fork(simout="%(parent)s.f%(fork_seq)i"):
+def fork(simout="%(parent)s.f%(fork_seq)i", drain_first=True):
     """Fork the simulator.
 
     This function forks the simulator. After forking the simulator,
@@ -357,6 +357,8 @@ def fork(simout="%(parent)s.f%(fork_seq)i"):
 
     Keyword Arguments:
       simout -- New simulation output directory.
+      drain_first -- Drain the system before forking. May be False
+        before the first simulate(), when nothing is in flight yet.
 
     Return Value:
       pid of the child process or 0 if running in the child.
@@ -367,7 +369,8 @@ def fork(simout="%(parent)s.f%(fork_seq)i"):
     if not _m5.core.listenersDisabled():
         raise RuntimeError("Can not fork a simulator with listeners enabled")
 
-    drain()
+    if drain_first:
+        drain()
 
     # Terminate helper threads that service parallel event queues.
     _m5.event.terminateEventQueueThreads()
@@ -37,6 +37,8 @@ from m5.params import *
 from m5.proxy import *
 from m5.SimObject import *
 
+class ArchDBBackend(Enum): vals = ['sqlite', 'columnar']
+
 class ArchDBer(SimObject):
     type = 'ArchDBer'
     cxx_header = "sim/arch_db.hh"
@@ -44,11 +46,22 @@ class ArchDBer(SimObject):
 
     cxx_exports = [
         PyBindMethod("start_recording"),
+        PyBindMethod("redirect_output"),
     ]
 
     arch_db_file = Param.String("", "Where to save arch db")
     dump_from_start = Param.Bool(True, "Dump arch db from start")
     enable_rolling = Param.Bool(False, "Dump rolling perfcnt")
+    rolling_stats = VectorParam.String([],
+        "Full names of scalar, vector or formula stats sampled into the "
+        "rolling_stats table when rolling is enabled")
+    rolling_base = Param.String("",
+        "Stat whose growth triggers a rolling sample, "
+        "e.g. system.cpu.committedInsts")
+    rolling_interval = Param.Counter(1000,
+        "Growth of rolling_base between two rolling samples")
+    rolling_check_period = Param.Latency('10ns',
+        "Shortest time between two checks of rolling_base")
 
     table_cmds = VectorParam.String([], "Tables to create")
     dump_mem_trace = Param.Bool(False, "Dump memory trace")
@@ -61,3 +74,25 @@ class ArchDBer(SimObject):
     dump_sms_train_trace = Param.Bool(False, "Dump sms train trace")
     dump_l1d_way_pre_trace = Param.Bool(False, "Dump l1d way predction trace")
     dump_lifetime = Param.Bool(False, "Dump inst lifetime")
+
+    writer_thread = Param.Bool(True,
+        "Write trace rows to the db on a background thread")
+    writer_queue_size = Param.Unsigned(65536,
+        "Trace rows buffered for the writer thread")
+    drop_when_full = Param.Bool(False,
+        "Drop trace rows instead of stalling simulation when the writer "
+        "queue is full")
+    transaction_rows = Param.Unsigned(100000,
+        "Trace rows committed per db transaction")
+
+    backend = Param.ArchDBBackend('sqlite',
+        "Storage of trace tables: 'sqlite' rows in arch_db_file or "
+        "'columnar' per-column files next to it")
+    columnar_dir = Param.String("",
+        "Directory of columnar tables, defaults to <arch_db_file>.cols")
+    columnar_chunk_rows = Param.Unsigned(65536,
+        "Rows buffered per column chunk before it is written")
+    columnar_compress = Param.Bool(False,
+        "Compress column chunks with zstd, uncompressed columns can be "
+        "mmapped directly")
+    columnar_zstd_level = Param.Int(3, "zstd level of compressed chunks")
@@ -58,6 +58,7 @@ class System(SimObject):
     cxx_exports = [
         PyBindMethod("getMemoryMode"),
         PyBindMethod("setMemoryMode"),
+        PyBindMethod("restoreGcpt"),
     ]
 
     memories = VectorParam.AbstractMemory(Self.all,
@@ -135,6 +136,12 @@ class System(SimObject):
     map_to_raw_cpt = Param.Bool(False, "Map physical memory to raw cpt with mmap")
     gcpt_restorer_file = Param.String("", "GCPT restorer image file")
     gcpt_restorer_size_limit = Param.Unsigned(0x700, "Enable riscv vector extension")
+    gcpt_restore_threads = Param.Unsigned(0, "Threads decompressing a gz/zstd "
+        "gcpt image, 0 to use all host threads")
+    gcpt_cache_dir = Param.String("", "Directory caching decompressed gcpt "
+        "images to be mapped by later runs, empty to disable")
+    defer_gcpt_restore = Param.Bool(False, "Skip the gcpt restore in "
+        "initState, restoreGcpt() is called later, e.g. by a batch worker")
 
     xiangshan_system = Param.Bool(False, "Simulate Xiangshan system")
     arch_db = Param.ArchDBer(NULL,"arch db for this system")
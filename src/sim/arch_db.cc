@@ -1,7 +1,11 @@
 
 #include "sim/arch_db.hh"
 
+#include <algorithm>
+#include <chrono>
+
 #include "params/ArchDBer.hh"
+#include "sim/rolling.hh"
 
 namespace gem5{
 
@@ -18,10 +22,23 @@ ArchDBer::ArchDBer(const Params &p)
     dumpSMSTrainTrace(p.dump_sms_train_trace),
     dumpL1WayPreTrace(p.dump_l1d_way_pre_trace),
     dumpLifetime(p.dump_lifetime),
-    mem_db(nullptr), zErrMsg(nullptr),rc(0),
-    db_path(p.arch_db_file)
+    mem_db(nullptr),
+    db_path(p.arch_db_file),
+    useColumnar(p.backend == enums::columnar),
+    columnarDir(p.columnar_dir),
+    columnarChunkRows(p.columnar_chunk_rows),
+    // Level 0 means no compression to ColumnarTable, zstd reads it as 3
+    columnarZstdLevel(!p.columnar_compress ? 0 : p.columnar_zstd_level ? p.columnar_zstd_level : 3),
+    useWriterThread(p.writer_thread),
+    dropWhenFull(p.drop_when_full),
+    txnRows(p.transaction_rows ? p.transaction_rows : 1),
+    rowQueue(p.writer_queue_size)
 {
-  int rc = sqlite3_open(":memory:", &mem_db);
+  std::fill(std::begin(builtinTables), std::end(builtinTables), -1);
+
+  // The writer thread and the simulation thread share the connection
+  int rc = sqlite3_open_v2(":memory:", &mem_db,
+                           SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE | SQLITE_OPEN_FULLMUTEX, nullptr);
   if (rc) {
     sqlite3_close(mem_db);
     fatal("Can't open database: %s\n", sqlite3_errmsg(mem_db));
@@ -29,21 +46,66 @@ ArchDBer::ArchDBer(const Params &p)
 
   fatal_if(db_path == "" || db_path == "None",
             "Arch db file path is not given!");
+  if (useColumnar && columnarDir.empty()) {
+    columnarDir = db_path + ".cols";
+  }
 
   for (const auto &s : p.table_cmds) {
     create_table(s);
   }
+  // The writer thread starts with the first row
   registerExitCallback([this](){ save_db(); });
 }
 
+ArchDBer::~ArchDBer()
+{
+  stopWriterThread();
+  for (auto &table : tables) {
+    sqlite3_finalize(table.insert);
+  }
+}
+
 static int callback(void *NotUsed, int argc, char **argv, char **azColName){
   return 0;
 }
 
+void
+ArchDBer::startup()
+{
+  const auto &p = params();
+  if (dumpRolling && !p.rolling_stats.empty()) {
+    rollingSampler.reset(new RollingSampler(this, p.rolling_base, p.rolling_stats, p.rolling_interval,
+                                            p.rolling_check_period));
+  }
+}
+
+void
+ArchDBer::notifyFork()
+{
+  // The writer does not exist in the child, and may have held mem_db
+  fatal_if(writer.joinable(), "%s: can't fork after the writer thread started\n", name());
+}
+
+void
+ArchDBer::redirect_output(const std::string &dir)
+{
+  for (const auto &table : tables) {
+    fatal_if(table.columnar, "Arch db table %s is already being written to %s\n", table.name, columnarDir);
+  }
+  auto base_name = [](const std::string &path) {
+    auto pos = path.find_last_of('/');
+    return pos == std::string::npos ? path : path.substr(pos + 1);
+  };
+  db_path = dir + "/" + base_name(db_path);
+  if (useColumnar) {
+    columnarDir = dir + "/" + base_name(columnarDir);
+  }
+}
+
 void ArchDBer::create_table(const std::string &sql) {
   // create table
-  rc = sqlite3_exec(mem_db, sql.c_str(), callback, 0, &zErrMsg);
-  fatal_if(rc != SQLITE_OK, "SQL error: %s\n", zErrMsg);
+  std::string error;
+  fatal_if(!execSql(sql.c_str(), error), "SQL error: %s\n", error);
   inform("Table created: %s\n", sql.c_str());
 }
 
@@ -52,6 +114,19 @@ void ArchDBer::start_recording() {
 }
 
 void ArchDBer::save_db() {
+  for (auto &hook : flushHooks) {
+    hook();
+  }
+  flush();
+  if (rowsDropped) {
+    warn("%lu arch db rows dropped because the writer queue was full\n", rowsDropped);
+  }
+  if (useColumnar) {
+    warn("saving columnar tables to %s ...\n", columnarDir.c_str());
+    for (auto &table : tables) {
+      columnarTable(table).flush();
+    }
+  }
   warn("saving memdb to %s ...\n", db_path.c_str());
   sqlite3 *disk_db;
   sqlite3_backup *pBackup;
@@ -70,19 +145,286 @@ void ArchDBer::save_db() {
 void
 ArchDBer::execmd(std::string cmd)
 {
-  rc = sqlite3_exec(mem_db, cmd.c_str(), callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  }
+  DBRow row;
+  row.text = std::move(cmd);
+  enqueue(row);
 }
 
 DBTraceManager *
 ArchDBer::addAndGetTrace(const char *name, std::vector<std::pair<std::string, DataType>> fields)
 {
-  _traces[name] = DBTraceManager(name, fields, mem_db);
+  _traces[name] = DBTraceManager(name, fields, this);
   return &_traces[name];
 }
 
+int
+ArchDBer::addTable(const std::string &name, const std::vector<std::string> &cols, uint32_t text_mask,
+                   bool create)
+{
+  fatal_if(cols.size() > (size_t)DBRow::MaxCols, "Too many fields in table %s\n", name);
+  // The writer thread must not look at tables while it grows
+  flush();
+
+  if (create) {
+    std::string sql = "CREATE TABLE " + name + "(ID INTEGER PRIMARY KEY AUTOINCREMENT";
+    for (size_t i = 0; i < cols.size(); i++) {
+      sql += "," + cols[i] + ((text_mask & (1u << i)) ? " TEXT" : " INT NOT NULL");
+    }
+    sql += ");";
+    create_table(sql);
+  }
+
+  DBTable table;
+  table.name = name;
+  if (useColumnar) {
+    table.cols = cols;
+    table.textMask = text_mask;
+  } else {
+    std::string sql = "INSERT INTO " + name + "(";
+    std::string values = ") VALUES(";
+    for (size_t i = 0; i < cols.size(); i++) {
+      sql += (i ? "," : "") + cols[i];
+      values += i ? ",?" : "?";
+    }
+    sql += values + ");";
+    int rc = sqlite3_prepare_v2(mem_db, sql.c_str(), -1, &table.insert, nullptr);
+    fatal_if(rc != SQLITE_OK, "SQL error: %s in %s\n", sqlite3_errmsg(mem_db), sql.c_str());
+  }
+  tables.push_back(std::move(table));
+  return tables.size() - 1;
+}
+
+ColumnarTable &
+ArchDBer::columnarTable(DBTable &table)
+{
+  // Opened on the first row rather than when registered, so that the files
+  // go where redirect_output() says
+  if (!table.columnar) {
+    table.columnar.reset(new ColumnarTable(columnarDir, table.name, table.cols, table.textMask,
+                                           columnarChunkRows, columnarZstdLevel));
+  }
+  return *table.columnar;
+}
+
+int
+ArchDBer::builtinInsert(BuiltinInsert id)
+{
+  // Every built-in trace ends with a SITE text column
+  static const struct
+  {
+    const char *name;
+    std::vector<std::string> cols;
+  } builtins[NumBuiltinInserts] = {
+    {"MemTrace", {"Tick", "IsLoad", "PC", "VADDR", "PADDR", "Issued", "Translated", "Completed", "Committed",
+                  "Writenback", "PFSrc", "SITE"}},
+    {"L1PFTrace", {"Tick", "TriggerPC", "TriggerVAddr", "PFVAddr", "PFSrc", "SITE"}},
+    {"BOPTrainTrace", {"Tick", "OldAddr", "CurAddr", "Offset", "Score", "Miss", "SITE"}},
+    {"SMSTrainTrace", {"Tick", "OldAddr", "CurAddr", "TriggerOffset", "Conf", "Miss", "SITE"}},
+    {"L1MissTrace", {"PC", "SOURCE", "PADDR", "VADDR", "STAMP", "SITE"}},
+    {"dcacheWayPreTrace", {"PC", "VADDR", "WAY", "Tick", "IsWrite", "SITE"}},
+    {"CacheEvictTrace", {"Tick", "PADDR", "STAMP", "Level", "SITE"}},
+  };
+  if (builtinTables[id] < 0) {
+    const auto &b = builtins[id];
+    builtinTables[id] = addTable(b.name, b.cols, 1u << (b.cols.size() - 1));
+  }
+  return builtinTables[id];
+}
+
+void
+ArchDBer::enqueue(DBRow &row)
+{
+  if (!useWriterThread) {
+    if ((!inTxn && !beginTxn()) || !writeRow(row) ||
+        ((rowsInTxn += row.numRows()) >= txnRows && !commitTxn())) {
+      fatal("SQL error: %s\n", writerError);
+    }
+    return;
+  }
+
+  if (writerFailed.load(std::memory_order_acquire)) {
+    fatal("SQL error: %s\n", writerError);
+  }
+  if (!writer.joinable()) [[unlikely]] {
+    writer = std::thread(&ArchDBer::writerLoop, this);
+  }
+  while (!rowQueue.tryPush(std::move(row))) {
+    if (dropWhenFull) {
+      rowsDropped++;
+      return;
+    }
+    if (writerFailed.load(std::memory_order_acquire)) {
+      fatal("SQL error: %s\n", writerError);
+    }
+    std::this_thread::yield();
+  }
+  rowsQueued++;
+}
+
+void
+ArchDBer::enqueueRows(int table, const int64_t *vals, size_t num_cols, size_t num_rows)
+{
+  if (!num_rows) {
+    return;
+  }
+  assert(num_cols <= (size_t)DBRow::MaxCols);
+  DBRow row(table);
+  row.numCols = num_cols;
+  row.block.assign(vals, vals + num_cols * num_rows);
+  enqueue(row);
+}
+
+void
+ArchDBer::flush()
+{
+  if (!useWriterThread) {
+    if (inTxn && !commitTxn()) {
+      fatal("SQL error: %s\n", writerError);
+    }
+    return;
+  }
+
+  flushRequested.store(true, std::memory_order_release);
+  while (rowsDone.load(std::memory_order_acquire) < rowsQueued) {
+    if (writerFailed.load(std::memory_order_acquire)) {
+      fatal("SQL error: %s\n", writerError);
+    }
+    std::this_thread::yield();
+  }
+  flushRequested.store(false, std::memory_order_release);
+}
+
+void
+ArchDBer::stopWriterThread()
+{
+  stopWriter.store(true, std::memory_order_release);
+  if (writer.joinable()) {
+    writer.join();
+  }
+}
+
+bool
+ArchDBer::execSql(const char *sql, std::string &error)
+{
+  char *err = nullptr;
+  if (sqlite3_exec(mem_db, sql, callback, 0, &err) != SQLITE_OK) {
+    error = err ? err : sqlite3_errmsg(mem_db);
+    sqlite3_free(err);
+    return false;
+  }
+  return true;
+}
+
+bool
+ArchDBer::beginTxn()
+{
+  if (!execSql("BEGIN TRANSACTION;", writerError)) {
+    return false;
+  }
+  inTxn = true;
+  rowsInTxn = 0;
+  return true;
+}
+
+bool
+ArchDBer::commitTxn()
+{
+  if (!execSql("COMMIT;", writerError)) {
+    return false;
+  }
+  inTxn = false;
+  rowsInTxn = 0;
+  return true;
+}
+
+bool
+ArchDBer::writeRow(const DBRow &row)
+{
+  if (row.table < 0) {
+    return execSql(row.text.c_str(), writerError);
+  }
+
+  DBTable &table = tables[row.table];
+  if (row.block.empty()) {
+    return writeValues(table, row.ints, row.numCols, row.textMask, row.text.data());
+  }
+  for (size_t i = 0; i < row.block.size(); i += row.numCols) {
+    if (!writeValues(table, &row.block[i], row.numCols, 0, nullptr)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool
+ArchDBer::writeValues(DBTable &table, const int64_t *vals, int num_cols, uint32_t text_mask,
+                      const char *text)
+{
+  if (useColumnar) {
+    columnarTable(table).append(vals, text);
+    return true;
+  }
+
+  sqlite3_stmt *stmt = table.insert;
+  for (int i = 0; i < num_cols; i++) {
+    if (text_mask & (1u << i)) {
+      sqlite3_bind_text(stmt, i + 1, text + vals[i], -1, SQLITE_STATIC);
+    } else {
+      sqlite3_bind_int64(stmt, i + 1, vals[i]);
+    }
+  }
+  int step_rc = sqlite3_step(stmt);
+  sqlite3_reset(stmt);
+  if (step_rc != SQLITE_DONE) {
+    writerError = sqlite3_errmsg(mem_db);
+    return false;
+  }
+  return true;
+}
+
+void
+ArchDBer::writerLoop()
+{
+  // Commit a partially filled transaction after this many empty polls
+  const unsigned idle_commit_polls = 64;
+  std::vector<DBRow> batch(256);
+  uint64_t processed = 0;
+  unsigned idle = 0;
+
+  while (true) {
+    size_t n = rowQueue.popBatch(batch.data(), batch.size());
+    for (size_t i = 0; i < n; i++) {
+      if ((!inTxn && !beginTxn()) || !writeRow(batch[i]) ||
+          ((rowsInTxn += batch[i].numRows()) >= txnRows && !commitTxn())) {
+        writerFailed.store(true, std::memory_order_release);
+        return;
+      }
+    }
+    processed += n;
+
+    if (n) {
+      idle = 0;
+    } else if (inTxn && (flushRequested.load(std::memory_order_acquire) ||
+                         stopWriter.load(std::memory_order_acquire) ||
+                         ++idle >= idle_commit_polls)) {
+      if (!commitTxn()) {
+        writerFailed.store(true, std::memory_order_release);
+        return;
+      }
+    }
+    if (!inTxn) {
+      rowsDone.store(processed, std::memory_order_release);
+    }
+
+    if (!n) {
+      if (!inTxn && stopWriter.load(std::memory_order_acquire) && rowQueue.empty()) {
+        return;
+      }
+      std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+  }
+}
+
 void
 ArchDBer::memTraceWrite(Tick tick, bool is_load, Addr pc, Addr vaddr, Addr paddr, uint64_t issued, uint64_t translated,
                         uint64_t completed, uint64_t committed, uint64_t writenback, int pf_src)
@@ -90,15 +432,20 @@ ArchDBer::memTraceWrite(Tick tick, bool is_load, Addr pc, Addr vaddr, Addr paddr
   bool dump_me = dumpGlobal && dumpMemTrace;
   if (!dump_me) return;
 
-  sprintf(
-      memTraceSQLBuf,
-      "INSERT INTO MemTrace(Tick,IsLoad,PC,VADDR,PADDR,Issued,Translated,Completed,Committed,Writenback,PFSrc,SITE) "
-      "VALUES(%ld,%d,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%ld,%d,'%s');",
-      tick, is_load, pc, vaddr, paddr, issued, translated, completed, committed, writenback, pf_src, "CommitMemTrace");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  DBRow row(builtinInsert(MemTraceInsert));
+  row.addInt(tick);
+  row.addInt(is_load);
+  row.addInt(pc);
+  row.addInt(vaddr);
+  row.addInt(paddr);
+  row.addInt(issued);
+  row.addInt(translated);
+  row.addInt(completed);
+  row.addInt(committed);
+  row.addInt(writenback);
+  row.addInt(pf_src);
+  row.addText("CommitMemTrace");
+  enqueue(row);
 }
 
 void
@@ -107,14 +454,14 @@ ArchDBer::l1PFTraceWrite(Tick tick, Addr trigger_pc, Addr trigger_vaddr, Addr pf
   bool dump_me = dumpGlobal && dumpL1PfTrace;
   if (!dump_me) return;
 
-  sprintf(memTraceSQLBuf,
-          "INSERT INTO L1PFTrace(Tick,TriggerPC,TriggerVAddr,PFVAddr,PFSrc,SITE) "
-          "VALUES(%ld,%ld,%ld,%ld,%d,'%s');",
-          tick, trigger_pc, trigger_vaddr, pf_vaddr, pf_src, "L1PFTrace");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  DBRow row(builtinInsert(L1PFTraceInsert));
+  row.addInt(tick);
+  row.addInt(trigger_pc);
+  row.addInt(trigger_vaddr);
+  row.addInt(pf_vaddr);
+  row.addInt(pf_src);
+  row.addText("L1PFTrace");
+  enqueue(row);
 }
 
 void
@@ -123,14 +470,15 @@ ArchDBer::bopTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr offse
   bool dump_me = dumpGlobal && dumpBopTrainTrace;
   if (!dump_me) return;
 
-  sprintf(memTraceSQLBuf,
-          "INSERT INTO BOPTrainTrace(Tick,OldAddr,CurAddr,Offset,Score,Miss,SITE) "
-          "VALUES(%ld,%ld,%ld,%ld,%d,%d,'%s');",
-          tick, old_addr, cur_addr, offset, score, miss, "BOPTrain");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  DBRow row(builtinInsert(BOPTrainInsert));
+  row.addInt(tick);
+  row.addInt(old_addr);
+  row.addInt(cur_addr);
+  row.addInt(offset);
+  row.addInt(score);
+  row.addInt(miss);
+  row.addText("BOPTrain");
+  enqueue(row);
 }
 
 void
@@ -139,14 +487,15 @@ ArchDBer::smsTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr trigg
   bool dump_me = dumpGlobal && dumpSMSTrainTrace;
   if (!dump_me) return;
 
-  sprintf(memTraceSQLBuf,
-          "INSERT INTO SMSTrainTrace(Tick,OldAddr,CurAddr,TriggerOffset,Conf,Miss,SITE) "
-          "VALUES(%ld,%ld,%ld,%ld,%d,%d,'%s');",
-          tick, old_addr, cur_addr, trigger_offset, conf, miss, "SMSTrain");
-  rc = sqlite3_exec(mem_db, memTraceSQLBuf, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  DBRow row(builtinInsert(SMSTrainInsert));
+  row.addInt(tick);
+  row.addInt(old_addr);
+  row.addInt(cur_addr);
+  row.addInt(trigger_offset);
+  row.addInt(conf);
+  row.addInt(miss);
+  row.addText("SMSTrain");
+  enqueue(row);
 }
 
 void ArchDBer::L1MissTrace_write(
@@ -159,16 +508,15 @@ void ArchDBer::L1MissTrace_write(
 ) {
   bool dump_me = dumpGlobal && dumpL1MissTrace;
   if (!dump_me) return;
-  char sql[512];
-  sprintf(sql,
-    "INSERT INTO L1MissTrace(PC,SOURCE,PADDR,VADDR, STAMP, SITE) " \
-    "VALUES(%ld, %ld, %ld, %ld, %ld, '%s');",
-    pc,source,paddr,vaddr, stamp, site
-  );
-  rc = sqlite3_exec(mem_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+
+  DBRow row(builtinInsert(L1MissInsert));
+  row.addInt(pc);
+  row.addInt(source);
+  row.addInt(paddr);
+  row.addInt(vaddr);
+  row.addInt(stamp);
+  row.addText(site);
+  enqueue(row);
 }
 
 void
@@ -177,15 +525,15 @@ ArchDBer::dcacheWayPreTrace(Tick tick, uint64_t pc, uint64_t vaddr, int way, int
     bool dump_me = dumpGlobal && dumpL1WayPreTrace;
     if (!dump_me)
         return;
-    char sql[512];
-    sprintf(sql,
-            "INSERT INTO dcacheWayPreTrace(PC,VADDR, WAY, Tick, IsWrite,SITE)"
-            "VALUES(%ld,%ld,%ld,%ld,%ld,'%s');",
-            pc, vaddr, (uint64_t)way, tick, (uint64_t)is_write, "dacheWayPre");
-    rc = sqlite3_exec(mem_db, sql, callback, 0, &zErrMsg);
-    if (rc != SQLITE_OK) {
-        fatal("SQL error: %s\n", zErrMsg);
-    };
+
+    DBRow row(builtinInsert(WayPreInsert));
+    row.addInt(pc);
+    row.addInt(vaddr);
+    row.addInt(way);
+    row.addInt(tick);
+    row.addInt(is_write);
+    row.addText("dacheWayPre");
+    enqueue(row);
 }
 
 void
@@ -194,61 +542,40 @@ ArchDBer::evictTraceWrite(int cache_level, Tick tick, uint64_t paddr, uint64_t s
   bool dump_me = dumpGlobal && ((dumpL1EvictTrace && cache_level == 1) || (dumpL2EvictTrace && cache_level == 2) ||
                                 (dumpL3EvictTrace && cache_level == 3));
   if (!dump_me) return;
-  char sql[512];
-  sprintf(sql,
-    "INSERT INTO CacheEvictTrace(Tick, PADDR, STAMP, Level, SITE) " \
-    "VALUES(%ld, %ld, %ld, %ld, '%s');",
-    tick, paddr, stamp, (int64_t) cache_level, site
-  );
-  rc = sqlite3_exec(mem_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+
+  DBRow row(builtinInsert(EvictInsert));
+  row.addInt(tick);
+  row.addInt(paddr);
+  row.addInt(stamp);
+  row.addInt(cache_level);
+  row.addText(site);
+  enqueue(row);
 }
 
 void
 DBTraceManager::init_table() {
-  // create table
-  char sql[1024];
-  int pos = 0;
-  pos = sprintf(sql,
-    "CREATE TABLE %s(" \
-    "ID INTEGER PRIMARY KEY AUTOINCREMENT, " \
-    "TICK INT NOT NULL", _name.c_str());
+  std::vector<std::string> cols = {"TICK"};
+  uint32_t text_mask = 0;
   for (auto it = _fields.begin(); it != _fields.end(); it++) {
     switch (it->second) {
       case UINT64:
-        pos += sprintf(sql+pos, ",%s INT NOT NULL", it->first.c_str());
         break;
       case TEXT:
-        pos += sprintf(sql+pos, ",%s TEXT", it->first.c_str());
+        text_mask |= 1u << cols.size();
         break;
       default:
         fatal("Unknown data type");
     }
+    cols.push_back(it->first);
   }
-  pos += sprintf(sql+pos, ");");
-  assert(pos < 1024);
-  printf("%s\n", sql);
-  char *zErrMsg;
-  int rc = sqlite3_exec(_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  } else {
-    warn("Table created: %s\n", _name.c_str());
-  }
+  _table = _db->addTable(_name, cols, text_mask, true);
 }
 
 void
 DBTraceManager::write_record(const Record &record)
 {
-  char sql[1024];
-  int pos = 0;
-  pos = sprintf(sql, "INSERT INTO %s(TICK", _name.c_str());
-  for (auto it = _fields.begin(); it != _fields.end(); it++) {
-    pos += sprintf(sql+pos, ",%s", it->first.c_str());
-  }
-  pos += sprintf(sql+pos, ") VALUES(%ld", record._tick);
+  DBRow row(_table);
+  row.addInt(record._tick);
   for (auto it = _fields.begin(); it != _fields.end(); it++) {
     switch (it->second) {
       case UINT64:
@@ -258,8 +585,7 @@ DBTraceManager::write_record(const Record &record)
         if (data == m.end()) {
           fatal("Can't find data for %s\n", it->first.c_str());
         }
-        assert(data != m.end());
-        pos += sprintf(sql+pos, ",%ld", data->second);
+        row.addInt(data->second);
         break;
       }
       case TEXT:
@@ -269,22 +595,14 @@ DBTraceManager::write_record(const Record &record)
         if (data == m.end()) {
           fatal("Can't find data for %s\n", it->first.c_str());
         }
-        assert(data != m.end());
-        pos += sprintf(sql+pos, ",'%s'", data->second.c_str());
+        row.addText(data->second.c_str());
         break;
       }
       default:
         fatal("Unknown data type!\n");
     }
   }
-  pos += sprintf(sql+pos, ");");
-  assert(pos < 1024);
-  char *zErrMsg;
-  int rc = sqlite3_exec(_db, sql, callback, 0, &zErrMsg);
-  if (rc != SQLITE_OK) {
-    fatal("SQL error: %s\n", zErrMsg);
-  };
+  _db->enqueue(row);
 }
 
 } // namespace gem5
-
@@ -5,15 +5,23 @@
 #include <sqlite3.h>
 #include <unistd.h>
 
+#include <atomic>
 #include <cerrno>
 #include <cstdint>
 #include <cstdlib>
 #include <cstring>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "base/logging.hh"
+#include "base/spsc_ring.hh"
 #include "base/types.hh"
 #include "cpu/pred/general_arch_db.hh"
 #include "params/ArchDBer.hh"
+#include "sim/arch_db_columnar.hh"
 #include "sim/sim_exit.hh"
 #include "sim/sim_object.hh"
 #include "sim/system.hh"
@@ -21,14 +29,55 @@
 namespace gem5{
 
 class BaseCache;
+class ArchDBer;
+class RollingSampler;
+
+/**
+ * One queued database write. Integer columns are stored inline; text
+ * columns are appended to text (NUL separated) and ints holds their
+ * offset. A row without a table carries a raw SQL statement in text.
+ * A row with a block carries several integer rows of numCols columns
+ * instead, so that a batch goes to the writer in one submission.
+ */
+struct DBRow
+{
+  static constexpr int MaxCols = 24;
+
+  /** Table id returned by ArchDBer::addTable, -1 for raw SQL */
+  int table{-1};
+  uint8_t numCols{0};
+  uint32_t textMask{0};
+  int64_t ints[MaxCols];
+  std::string text;
+  std::vector<int64_t> block;
+
+  DBRow() {}
+  explicit DBRow(int t) : table(t) {}
+
+  size_t numRows() const { return block.empty() ? 1 : block.size() / numCols; }
+
+  void addInt(int64_t v) {
+    assert(numCols < MaxCols);
+    ints[numCols++] = v;
+  }
+
+  void addText(const char *str) {
+    assert(numCols < MaxCols);
+    textMask |= 1u << numCols;
+    ints[numCols++] = text.size();
+    text.append(str);
+    text.push_back('\0');
+  }
+};
 
 class DBTraceManager
 {
   std::string _name;
   std::map<std::string, DataType> _fields;
-  sqlite3 *_db;
+  ArchDBer *_db;
+  int _table{-1};
 public:
-  DBTraceManager(const char *name, std::vector<std::pair<std::string, DataType>> fields, sqlite3 *db) {
+  DBTraceManager(const char *name, std::vector<std::pair<std::string, DataType>> fields, ArchDBer *db) {
     _name = name;
     for (auto it = fields.begin(); it != fields.end(); it++) {
       _fields[it->first] = it->second;
@@ -65,8 +114,6 @@ class ArchDBer : public SimObject
     bool dumpLifetimeMore;
 
     sqlite3 *mem_db;
-    char * zErrMsg;
-    int rc;
     //path to save
     std::string db_path;
     // a trace corrsponds to a table
@@ -75,7 +122,116 @@ class ArchDBer : public SimObject
     void create_table(const std::string &sql);
 
     void save_db();
+
+  private:
+    enum BuiltinInsert
+    {
+      MemTraceInsert,
+      L1PFTraceInsert,
+      BOPTrainInsert,
+      SMSTrainInsert,
+      L1MissInsert,
+      WayPreInsert,
+      EvictInsert,
+      NumBuiltinInserts
+    };
+
+    /** Table ids of the built-in traces, registered on first use */
+    int builtinTables[NumBuiltinInserts];
+    int builtinInsert(BuiltinInsert id);
+
+    /** A table rows can be written to by id */
+    struct DBTable
+    {
+      std::string name;
+      /** Cached INSERT, only with the sqlite backend */
+      sqlite3_stmt *insert{nullptr};
+      /** Column files, only with the columnar backend, opened on use */
+      std::unique_ptr<ColumnarTable> columnar;
+      std::vector<std::string> cols;
+      uint32_t textMask{0};
+    };
+    std::vector<DBTable> tables;
+
+    /** Write table rows to column files instead of mem_db */
+    const bool useColumnar;
+    std::string columnarDir;
+    const uint64_t columnarChunkRows;
+    const int columnarZstdLevel;
+
+    std::vector<std::function<void()>> flushHooks;
+
+    /** Samples rolling_stats, created at startup when rolling is enabled */
+    std::unique_ptr<RollingSampler> rollingSampler;
+
+    /** Drain rows on a background writer thread */
+    const bool useWriterThread;
+    /** Drop rows instead of stalling simulation when the queue is full */
+    const bool dropWhenFull;
+    /** Rows per explicit transaction */
+    const uint64_t txnRows;
+
+    SPSCRing<DBRow> rowQueue;
+    std::thread writer;
+    std::atomic<bool> stopWriter{false};
+    std::atomic<bool> flushRequested{false};
+    /** Rows written and committed, published by the writer */
+    std::atomic<uint64_t> rowsDone{0};
+    std::atomic<bool> writerFailed{false};
+    std::string writerError;
+
+    /** Producer-side counters */
+    uint64_t rowsQueued{0};
+    uint64_t rowsDropped{0};
+
+    /** Transaction state, owned by whichever thread writes rows */
+    bool inTxn{false};
+    uint64_t rowsInTxn{0};
+
+    void writerLoop();
+    bool writeRow(const DBRow &row);
+    bool writeValues(DBTable &table, const int64_t *vals, int num_cols, uint32_t text_mask,
+                     const char *text);
+    ColumnarTable &columnarTable(DBTable &table);
+    /** Run sql, copying the sqlite error message on failure */
+    bool execSql(const char *sql, std::string &error);
+    bool beginTxn();
+    bool commitTxn();
+    void stopWriterThread();
+
   public:
+    ~ArchDBer();
+
+    void startup() override;
+
+    void notifyFork() override;
+
+    /**
+     * Write the db and the columnar tables into dir instead, keeping their
+     * file names. Only before any table was written out.
+     */
+    void redirect_output(const std::string &dir);
+
+    /**
+     * Register a table and return its id for DBRow, text_mask marks the
+     * text columns. With the sqlite backend the table must already exist
+     * in mem_db unless create is set.
+     */
+    int addTable(const std::string &name, const std::vector<std::string> &cols, uint32_t text_mask,
+                 bool create = false);
+
+    /** Queue a row for writing, row is moved from */
+    void enqueue(DBRow &row);
+
+    /** Queue num_rows integer rows of num_cols values each */
+    void enqueueRows(int table, const int64_t *vals, size_t num_cols, size_t num_rows);
+
+    /** Run hook before the db is saved, to write out buffered rows */
+    void addFlushHook(std::function<void()> hook) { flushHooks.push_back(std::move(hook)); }
+
+    /** Wait until every queued row is committed to mem_db */
+    void flush();
+
     void execmd(std::string cmd);
 
     DBTraceManager *addAndGetTrace(const char *name, std::vector<std::pair<std::string, DataType>> fields);
@@ -101,7 +257,6 @@ class ArchDBer : public SimObject
     void bopTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr offset, int score, bool miss);
     void smsTrainTraceWrite(Tick tick, Addr old_addr, Addr cur_addr, Addr trigger_offset, int conf, bool miss);
     void dcacheWayPreTrace(Tick tick, uint64_t pc, uint64_t vaddr, int way, int is_write);
-    char memTraceSQLBuf[1024];
 };
 
 
@@ -0,0 +1,160 @@
+#include "sim/arch_db_columnar.hh"
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstring>
+
+#include "base/logging.hh"
+
+namespace gem5{
+
+static void
+makeDir(const std::string &path)
+{
+  if (::mkdir(path.c_str(), 0755) != 0 && errno != EEXIST) {
+    fatal("Can't create arch db directory %s: %s\n", path, strerror(errno));
+  }
+}
+
+ColumnarTable::ColumnarTable(const std::string &dir, const std::string &name,
+                             const std::vector<std::string> &cols, uint32_t text_mask,
+                             uint64_t chunk_rows, int zstd_level)
+    : path(dir + "/" + name), name(name),
+    chunkRows(chunk_rows ? chunk_rows : 1),
+    zstdLevel(zstd_level)
+{
+  makeDir(dir);
+  makeDir(path);
+
+  columns.resize(cols.size());
+  for (size_t i = 0; i < cols.size(); i++) {
+    Column &col = columns[i];
+    col.name = cols[i];
+    col.isText = text_mask & (1u << i);
+    std::string file = path + "/" + col.name + ".col";
+    col.data = fopen(file.c_str(), "wb");
+    fatal_if(!col.data, "Can't open %s: %s\n", file, strerror(errno));
+    col.dict = nullptr;
+    if (col.isText) {
+      file = path + "/" + col.name + ".dict";
+      col.dict = fopen(file.c_str(), "wb");
+      fatal_if(!col.dict, "Can't open %s: %s\n", file, strerror(errno));
+      col.codes.reserve(chunkRows);
+    } else {
+      col.ints.reserve(chunkRows);
+    }
+  }
+
+  if (zstdLevel) {
+    cctx = ZSTD_createCCtx();
+    fatal_if(!cctx, "Can't create zstd context\n");
+    size_t max_chunk = chunkRows * sizeof(int64_t);
+    zbuf.resize(ZSTD_compressBound(max_chunk));
+  }
+}
+
+ColumnarTable::~ColumnarTable()
+{
+  flush();
+  for (auto &col : columns) {
+    fclose(col.data);
+    if (col.dict) {
+      fclose(col.dict);
+    }
+  }
+  if (cctx) {
+    ZSTD_freeCCtx(cctx);
+  }
+}
+
+void
+ColumnarTable::append(const int64_t *vals, const char *text)
+{
+  for (size_t i = 0; i < columns.size(); i++) {
+    Column &col = columns[i];
+    if (!col.isText) {
+      col.ints.push_back(vals[i]);
+      continue;
+    }
+    const char *str = text + vals[i];
+    auto it = col.dictCodes.find(str);
+    if (it == col.dictCodes.end()) {
+      uint32_t code = col.dictCodes.size();
+      it = col.dictCodes.emplace(str, code).first;
+      fwrite(str, 1, strlen(str) + 1, col.dict);
+    }
+    col.codes.push_back(it->second);
+  }
+  numRows++;
+  if (++pendingRows == chunkRows) {
+    writeChunk();
+  }
+}
+
+void
+ColumnarTable::writeBuf(Column &col, const void *buf, size_t bytes)
+{
+  if (zstdLevel) {
+    size_t out = ZSTD_compressCCtx(cctx, zbuf.data(), zbuf.size(), buf, bytes, zstdLevel);
+    fatal_if(ZSTD_isError(out), "zstd error on %s.%s: %s\n", name, col.name, ZSTD_getErrorName(out));
+    buf = zbuf.data();
+    bytes = out;
+  }
+  fatal_if(fwrite(buf, 1, bytes, col.data) != bytes, "Write error on %s.%s: %s\n", name, col.name,
+           strerror(errno));
+}
+
+void
+ColumnarTable::writeChunk()
+{
+  if (!pendingRows) return;
+  for (auto &col : columns) {
+    if (col.isText) {
+      writeBuf(col, col.codes.data(), col.codes.size() * sizeof(uint32_t));
+      col.codes.clear();
+    } else {
+      writeBuf(col, col.ints.data(), col.ints.size() * sizeof(int64_t));
+      col.ints.clear();
+    }
+  }
+  pendingRows = 0;
+}
+
+void
+ColumnarTable::writeSchema()
+{
+  std::string file = path + "/schema.json";
+  FILE *fp = fopen(file.c_str(), "w");
+  fatal_if(!fp, "Can't open %s: %s\n", file, strerror(errno));
+  fprintf(fp, "{\n  \"table\": \"%s\",\n  \"rows\": %lu,\n  \"chunk_rows\": %lu,\n"
+          "  \"compression\": \"%s\",\n  \"columns\": [\n",
+          name.c_str(), numRows, chunkRows, zstdLevel ? "zstd" : "none");
+  for (size_t i = 0; i < columns.size(); i++) {
+    const Column &col = columns[i];
+    if (col.isText) {
+      fprintf(fp, "    {\"name\": \"%s\", \"dtype\": \"<u4\", \"dict\": \"%s.dict\"}",
+              col.name.c_str(), col.name.c_str());
+    } else {
+      fprintf(fp, "    {\"name\": \"%s\", \"dtype\": \"<i8\"}", col.name.c_str());
+    }
+    fprintf(fp, "%s\n", i + 1 < columns.size() ? "," : "");
+  }
+  fprintf(fp, "  ]\n}\n");
+  fclose(fp);
+}
+
+void
+ColumnarTable::flush()
+{
+  writeChunk();
+  for (auto &col : columns) {
+    fflush(col.data);
+    if (col.dict) {
+      fflush(col.dict);
+    }
+  }
+  writeSchema();
+}
+
+} // namespace gem5
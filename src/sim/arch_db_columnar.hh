@@ -0,0 +1,80 @@
+#ifndef __SIM_ARCH_DB_COLUMNAR_HH__
+#define __SIM_ARCH_DB_COLUMNAR_HH__
+
+#include <zstd.h>
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace gem5{
+
+/**
+ * Append-only columnar file for one arch db table.
+ *
+ * Every table is a directory holding one file per column plus a
+ * schema.json describing them. Integer columns are little-endian int64,
+ * text columns are dictionary encoded as uint32 codes into a
+ * <column>.dict file of NUL terminated strings. Rows are buffered in
+ * chunks of chunkRows; without compression a column file is a plain array
+ * that numpy can mmap as is, with compression every chunk is written as
+ * one zstd frame, so the file decompresses as a single stream.
+ *
+ * The row ID column of the SQLite tables is implicit (row index + 1).
+ */
+class ColumnarTable
+{
+  public:
+    ColumnarTable(const std::string &dir, const std::string &name,
+                  const std::vector<std::string> &cols, uint32_t text_mask,
+                  uint64_t chunk_rows, int zstd_level);
+    ~ColumnarTable();
+
+    ColumnarTable(const ColumnarTable &) = delete;
+    ColumnarTable &operator=(const ColumnarTable &) = delete;
+
+    /**
+     * Append one row. vals holds one value per column; for text columns
+     * it is the offset of a NUL terminated string in text.
+     */
+    void append(const int64_t *vals, const char *text);
+
+    /** Write out the pending chunk and refresh schema.json */
+    void flush();
+
+    uint64_t rows() const { return numRows; }
+
+  private:
+    struct Column
+    {
+        std::string name;
+        bool isText;
+        FILE *data;
+        FILE *dict;
+        std::vector<int64_t> ints;
+        std::vector<uint32_t> codes;
+        std::unordered_map<std::string, uint32_t> dictCodes;
+    };
+
+    void writeChunk();
+    void writeBuf(Column &col, const void *buf, size_t bytes);
+    void writeSchema();
+
+    const std::string path;
+    const std::string name;
+    const uint64_t chunkRows;
+    const int zstdLevel;
+
+    std::vector<Column> columns;
+    uint64_t numRows{0};
+    uint64_t pendingRows{0};
+
+    ZSTD_CCtx *cctx{nullptr};
+    std::vector<char> zbuf;
+};
+
+} // namespace gem5
+
+#endif // __SIM_ARCH_DB_COLUMNAR_HH__
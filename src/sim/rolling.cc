@@ -1,5 +1,113 @@
-#include "sim/arch_db.hh"
+#include "sim/rolling.hh"
+
+#include <algorithm>
+#include <cmath>
+
+#include "base/statistics.hh"
+#include "sim/root.hh"
 
 namespace gem5{
 
-} // namespace gem5
\ No newline at end of file
+RollingTable::RollingTable(ArchDBer *db, const std::string &name,
+                           const std::vector<std::string> &cols,
+                           size_t batch_rows)
+    : archDBer(db), numCols(cols.size()),
+      batchRows(batch_rows ? batch_rows : 1),
+      buf(numCols * batchRows)
+{
+  table = archDBer->addTable(name, cols, 0, true);
+  archDBer->addFlushHook([this]() { flush(); });
+}
+
+void
+RollingTable::flush()
+{
+  archDBer->enqueueRows(table, buf.data(), numCols, rows);
+  rows = 0;
+}
+
+/** Column name of a stat, dots are not allowed in SQL identifiers */
+static std::string
+columnName(const std::string &stat)
+{
+  std::string col = stat;
+  for (auto &c : col) {
+    if (c == '.' || c == ':' || c == '-')
+      c = '_';
+  }
+  return col;
+}
+
+static std::vector<std::string>
+rollingColumns(const std::vector<std::string> &names)
+{
+  std::vector<std::string> cols = {"TICK", "base"};
+  for (const auto &name : names) {
+    cols.push_back(columnName(name));
+  }
+  return cols;
+}
+
+static double
+statTotal(const statistics::Info *info)
+{
+  if (auto scalar = dynamic_cast<const statistics::ScalarInfo *>(info))
+    return scalar->total();
+  return static_cast<const statistics::VectorInfo *>(info)->total();
+}
+
+RollingSampler::RollingSampler(ArchDBer *db, const std::string &base,
+                               const std::vector<std::string> &names,
+                               Counter intv, Tick check_period)
+    : archDBer(db), interval(intv ? intv : 1),
+      period(check_period ? check_period : 1), wait(period),
+      table(db, "rolling_stats", rollingColumns(names)),
+      checkEvent([this]{ check(); }, "RollingSampler check")
+{
+  fatal_if(base.empty(), "rolling_base is required to sample rolling_stats\n");
+  std::vector<std::string> all = {base};
+  all.insert(all.end(), names.begin(), names.end());
+  for (const auto &name : all) {
+    const statistics::Info *info = Root::root()->resolveStat(name);
+    fatal_if(!info, "Rolling stat %s not found\n", name);
+    fatal_if(!dynamic_cast<const statistics::ScalarInfo *>(info) &&
+             !dynamic_cast<const statistics::VectorInfo *>(info),
+             "Rolling stat %s is not a scalar, vector or formula\n", name);
+    stats.push_back(info);
+    last.push_back(statTotal(info));
+  }
+  checkBase = last[0];
+  checkTick = curTick();
+  archDBer->schedule(checkEvent, curTick() + period);
+}
+
+void
+RollingSampler::check()
+{
+  double base = statTotal(stats[0]);
+  if (base - last[0] >= interval) {
+    int64_t *row = table.next();
+    row[0] = curTick();
+    for (size_t i = 0; i < stats.size(); i++) {
+      double val = i ? statTotal(stats[i]) : base;
+      row[i + 1] = std::llround(val - last[i]);
+      last[i] = val;
+    }
+    table.push();
+  }
+
+  // Aim at the next boundary at the rate base grew since the last check
+  const Tick max_wait = period << MaxWaitShift;
+  double rate = (base - checkBase) / (curTick() - checkTick);
+  if (rate > 0) {
+    wait = std::min<double>((interval - (base - last[0])) / rate, max_wait);
+  } else {
+    wait *= 2;
+  }
+  wait = std::clamp(wait, period, max_wait);
+  checkBase = base;
+  checkTick = curTick();
+  archDBer->schedule(checkEvent, curTick() + wait);
+}
+
+} // namespace gem5
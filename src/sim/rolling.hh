@@ -1,30 +1,66 @@
 #ifndef __SIM_ROLLING_H__
 #define __SIM_ROLLING_H__
 
-#include <sqlite3.h>
-#include <unistd.h>
-
-#include <cerrno>
+#include <cassert>
 #include <cstdint>
-#include <cstdlib>
-#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
 
 #include "base/types.hh"
 #include "sim/arch_db.hh"
+#include "sim/eventq.hh"
 
 namespace gem5{
 
+namespace statistics
+{
+class Info;
+} // namespace statistics
+
+/**
+ * Fixed-schema integer table for rolling curves. Rows are filled in
+ * place in a preallocated batch and handed to ArchDBer in bulk, either
+ * when the batch is full or right before the db is saved.
+ */
+class RollingTable
+{
+  private:
+    ArchDBer *archDBer;
+    int table;
+    const size_t numCols;
+    const size_t batchRows;
+    size_t rows = 0;
+    std::vector<int64_t> buf;
+
+  public:
+    RollingTable(ArchDBer *db, const std::string &name,
+                 const std::vector<std::string> &cols,
+                 size_t batch_rows = 1024);
+
+    /** Slot of the next row, fill numCols values then call push() */
+    int64_t *next() { return &buf[rows * numCols]; }
+
+    void
+    push()
+    {
+      if (++rows == batchRows)
+        flush();
+    }
+
+    void flush();
+};
+
 class Rolling
 {
   private:
     bool enabled = true;
     Counter interval;
-    Counter value;
-    Counter base;
-    Counter value_interval;
-    Counter base_interval;
-    ArchDBer *archDBer;
-    DBTraceManager *traceManager;
+    Counter value = 0;
+    Counter base = 0;
+    Counter value_interval = 0;
+    Counter base_interval = 0;
+    std::unique_ptr<RollingTable> table;
 
   public:
     Rolling(const char *name, const char *desc = nullptr,
@@ -36,15 +72,9 @@ class Rolling
       }
 
       interval = intv;
-      archDBer = db;
-      std::vector<std::pair<std::string, DataType>> fields_vec = {
-          std::make_pair("value", UINT64),
-          std::make_pair("base", UINT64),
-      };
       std::string tableName(name);
       tableName += "_rolling";
-      traceManager = archDBer->addAndGetTrace(tableName.c_str(), fields_vec);
-      traceManager->init_table();
+      table.reset(new RollingTable(db, tableName, {"TICK", "base", "value"}));
     }
 
     void operator++(int) { value++; value_interval++; }
@@ -72,17 +102,56 @@ class Rolling
       bool dump = (base_interval >= interval);
       if (dump && enabled)
       {
-        Counter y_value = get_value_and_clean();
-        Counter x_value = get_base_and_clean();
-        Record pt;
-        pt._tick = curTick() / 500;
-        pt._uint64_data["value"] = y_value;
-        pt._uint64_data["base"] = x_value;
-        traceManager->write_record(pt);
+        int64_t *row = table->next();
+        row[0] = curTick() / 500;
+        row[2] = get_value_and_clean();
+        row[1] = get_base_and_clean();
+        table->push();
       }
     }
 };
 
+/**
+ * Samples existing statistics by name into the rolling_stats table.
+ *
+ * The base stat is read at each check; once it has grown by at least
+ * interval since the last sample, a row with the tick, the base growth
+ * and the growth of every attached stat is recorded. Scalars, vectors
+ * and formulas are read through their total.
+ *
+ * Rather than polling every period, the next check is scheduled where
+ * base should cross the next boundary at the rate it grew since the
+ * previous check. period is the shortest wait; while base does not grow
+ * the wait doubles, up to 1024 periods.
+ */
+class RollingSampler
+{
+  private:
+    ArchDBer *archDBer;
+    const Counter interval;
+    const Tick period;
+    static constexpr int MaxWaitShift = 10;
+
+    /** Time to the next check, and base and tick at the last one */
+    Tick wait;
+    double checkBase;
+    Tick checkTick;
+
+    /** Attached stats, base first */
+    std::vector<const statistics::Info *> stats;
+    std::vector<double> last;
+
+    RollingTable table;
+    EventFunctionWrapper checkEvent;
+
+    void check();
+
+  public:
+    RollingSampler(ArchDBer *db, const std::string &base,
+                   const std::vector<std::string> &names,
+                   Counter intv, Tick check_period);
+};
+
 } // namespace gem5
 
-#endif
\ No newline at end of file
+#endif
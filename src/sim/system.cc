@@ -188,6 +188,7 @@ System::System(const Params &p)
       physmem(name() + ".physmem", p.memories, p.mmap_using_noreserve,
               p.shared_backstore, p.restore_from_gcpt, p.gcpt_restorer_file,
               p.gcpt_file, p.map_to_raw_cpt, p.auto_unlink_shared_backstore, p.gcpt_restorer_size_limit,
+              p.gcpt_restore_threads, p.gcpt_cache_dir,
               &dedupMemManager, p.enable_mem_dedup),
       ShadowRomRanges(p.shadow_rom_ranges.begin(),
                       p.shadow_rom_ranges.end()),
@@ -199,7 +200,8 @@ System::System(const Params &p)
                  RangeSize(p.m5ops_base, 0x10000) :
                  AddrRange(1, 0)), // Create an empty range if disabled
       redirectPaths(p.redirect_paths),
-      xiangshanSystem(p.xiangshan_system)
+      xiangshanSystem(p.xiangshan_system),
+      deferGcptRestore(p.defer_gcpt_restore)
 {
     panic_if(!workload, "No workload set for system %s "
             "(could use StubWorkload?).", name());
@@ -557,15 +559,26 @@ void System::initState()
     // it does nothing
     SimObject::initState();
 
-    if (physmem.tryRestoreFromXSCpt()) {
+    if (!deferGcptRestore) {
+        restoreGcpt("");
+    }
+}
+
+void
+System::restoreGcpt(const std::string &path)
+{
+    if (physmem.tryRestoreFromXSCpt(path)) {
         inform("Restored from Xiangshan RISC-V Checkpoint\n");
     }
 
     // have to initiate golden memory after checkpoint restored
     if (numCPUs > 1 && enableDifftest) {
         warn("Creating golden memory for multi-core difftest\n");
-        assert(enableMemDedup);
-        goldenMem = dedupMemManager.createCopyOnWriteBranch();
+        if (!enableMemDedup) {
+            // Freeze the image before anything runs, refs map it later on
+            physmem.shareRestoredImage();
+        }
+        goldenMem = createCopyOnWriteBranch();
         goldenMemManager.initGoldenMem(physmem.getStartaddr(), memSize(), goldenMem);
     }
 
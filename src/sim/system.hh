@@ -369,7 +369,16 @@ class System : public SimObject, public PCEventScope
      */
     bool isMemAddr(Addr addr) const;
 
-    uint8_t *createCopyOnWriteBranch() { return dedupMemManager.createCopyOnWriteBranch(); }
+    /**
+     * Copy-on-write mirror of the restored memory, from the dedup root
+     * memory or else from the image shared by physmem.
+     */
+    uint8_t *
+    createCopyOnWriteBranch()
+    {
+        return enableMemDedup ? dedupMemManager.createCopyOnWriteBranch()
+                              : physmem.createCopyOnWriteView();
+    }
 
     /**
      * Add a physical memory range for a device. The ranges added here will
@@ -420,6 +429,14 @@ class System : public SimObject, public PCEventScope
 
     GoldenGloablMem *getGoldenMemManager() { return &goldenMemManager; }
 
+    /**
+     * Restore the Xiangshan checkpoint image at path, or gcpt_file if
+     * empty, and set up the golden memory on top of it. Done by
+     * initState unless defer_gcpt_restore is set; then it must be called
+     * before the first simulate.
+     */
+    void restoreGcpt(const std::string &path);
+
   protected:
 
     KvmVM *kvmVM = nullptr;
@@ -644,6 +661,8 @@ class System : public SimObject, public PCEventScope
     void initState() override;
 
     const bool xiangshanSystem;
+
+    const bool deferGcptRestore;
 };
 
 void printSystems();
@@ -0,0 +1,101 @@
+"""Reader of arch db tables written with ArchDBer.backend = 'columnar'.
+
+Each table is a directory with a schema.json and one file per column.
+Uncompressed columns are memory mapped, so slicing and filtering with
+numpy does not copy the trace. Compressed columns are decoded once.
+"""
+import json
+import os.path as osp
+import subprocess
+
+import numpy as np
+
+
+def columnar_root(db_path):
+    """Return the columnar directory for db_path, None if it is a SQLite db."""
+    if osp.isdir(db_path):
+        return db_path
+    if osp.isdir(db_path + '.cols'):
+        return db_path + '.cols'
+    return None
+
+
+def _decompress(path):
+    try:
+        import zstandard
+    except ImportError:
+        return subprocess.run(['zstd', '-dcq', path], check=True,
+                              stdout=subprocess.PIPE).stdout
+    with open(path, 'rb') as f:
+        dctx = zstandard.ZstdDecompressor()
+        return dctx.stream_reader(f, read_across_frames=True).read()
+
+
+class ColumnarTable:
+    def __init__(self, root, name):
+        self.name = name
+        self.path = osp.join(root, name)
+        with open(osp.join(self.path, 'schema.json')) as f:
+            self.schema = json.load(f)
+        self.num_rows = self.schema['rows']
+        self.col_names = [c['name'] for c in self.schema['columns']]
+        self._cols = {c['name']: c for c in self.schema['columns']}
+        self._cache = {}
+        self._dicts = {}
+
+    def __len__(self):
+        return self.num_rows
+
+    def is_text(self, name):
+        return 'dict' in self._cols.get(name, {})
+
+    def column(self, name):
+        """Column as a numpy array, dictionary codes for text columns.
+
+        'ID' is synthesized to match the SQLite row ids.
+        """
+        if name == 'ID':
+            return np.arange(1, self.num_rows + 1, dtype=np.int64)
+        if name in self._cache:
+            return self._cache[name]
+        dtype = np.dtype(self._cols[name]['dtype'])
+        path = osp.join(self.path, name + '.col')
+        if self.num_rows == 0:
+            arr = np.empty(0, dtype=dtype)
+        elif self.schema['compression'] == 'none':
+            arr = np.memmap(path, dtype=dtype, mode='r', shape=(self.num_rows,))
+        else:
+            arr = np.frombuffer(_decompress(path), dtype=dtype)[:self.num_rows]
+        self._cache[name] = arr
+        return arr
+
+    def strings(self, name):
+        """Dictionary of a text column, indexed by the codes of column()."""
+        if name not in self._dicts:
+            with open(osp.join(self.path, self._cols[name]['dict']), 'rb') as f:
+                words = f.read().decode().split('\0')[:-1]
+            self._dicts[name] = np.array(words, dtype=object)
+        return self._dicts[name]
+
+    def text(self, name):
+        """Decoded text column."""
+        return self.strings(name)[self.column(name)]
+
+    def rows(self, with_id=True, batch=1 << 16):
+        """Yield rows as tuples in table order, like SELECT * in SQLite."""
+        names = (['ID'] if with_id else []) + self.col_names
+        cols = [self.column(n) for n in names]
+        dicts = [self.strings(n) if self.is_text(n) else None for n in names]
+        for start in range(0, self.num_rows, batch):
+            chunk = []
+            for col, words in zip(cols, dicts):
+                part = col[start:start + batch]
+                chunk.append((words[part] if words is not None else part).tolist())
+            yield from zip(*chunk)
+
+
+def open_table(db_path, name):
+    root = columnar_root(db_path)
+    if root is None:
+        raise FileNotFoundError(f'{db_path} has no columnar tables')
+    return ColumnarTable(root, name)
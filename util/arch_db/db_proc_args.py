@@ -22,4 +22,14 @@ if args.db is None:
     lastest_subdir = max(all_subdirs, key=lambda x: osp.getmtime(osp.join('../warmup_scripts', x)))
     db_path = osp.join('../warmup_scripts', lastest_subdir, 'mem_trace.db')
 else:
-    db_path = args.db
\ No newline at end of file
+    db_path = args.db
+
+
+def select_all(db_path, table):
+    """Iterate the rows of table on either arch db backend."""
+    if osp.isdir(db_path) or osp.isdir(db_path + '.cols'):
+        from columnar import open_table
+        return open_table(db_path, table).rows()
+    import sqlite3
+    con = sqlite3.connect(db_path)
+    return con.cursor().execute(f'SELECT * FROM {table}')
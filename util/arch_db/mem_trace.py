@@ -1,12 +1,9 @@
-import sqlite3
 import collections
-from db_proc_args import args, db_path
+from db_proc_args import args, db_path, select_all
 
 print('Processing', db_path)
 
-con = sqlite3.connect(db_path)
-cur = con.cursor()
-res = cur.execute('SELECT * FROM MemTrace')
+res = select_all(db_path, 'MemTrace')
 cycle = 333
 seen_addr = {}
 recent_lines = []
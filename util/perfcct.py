@@ -1,5 +1,7 @@
 import sqlite3 as sql
 import argparse
+import os
+import struct
 
 
 
@@ -8,6 +10,8 @@ parser.add_argument('sqldb')
 parser.add_argument('-v', '--visual', action='store_true', default=False)
 parser.add_argument('-z', '--zoom', action='store', type=float, default=1)
 parser.add_argument('-p', '--period', action='store', default=333)
+parser.add_argument('-c', '--cpu', action='store', type=int, default=0,
+                    help='CPU whose .perfcct trace to read next to the db')
 
 args = parser.parse_args()
 
@@ -68,24 +72,62 @@ dump = dump_txt
 if args.visual:
     dump = dump_visual
 
-with sql.connect(sqldb) as con:
-    cur = con.cursor()
-    cur.execute("SELECT * FROM LifeTimeCommitTrace")
-    col_name = [i[0] for i in cur.description]
-    col_name = col_name[1:]
-    col_name = [i.lower() for i in col_name]
-    rows = cur.fetchall()
-    for row in rows:
-        row = row[1:]
-        pos = []
-        records = []
-        i = 0
-        for val in row:
-            if col_name[i].startswith('at'):
-                pos.append(val//tick_per_cycle)
-            elif col_name[i].startswith('pc'):
-                records.append(hex(val))
-            else:
-                records.append(val)
-            i += 1
-        dump(pos, records)
\ No newline at end of file
+def load_perfcct(path):
+    """Return (column names, rows) of a binary .perfcct commit trace."""
+    with open(path, 'rb') as f:
+        data = f.read()
+    if data[:8] != b'PERFCCT\0':
+        raise ValueError(f'{path} is not a perfcct trace')
+    version, num_stages = struct.unpack_from('<II', data, 8)
+    names = data[16:].split(b'\0')[:num_stages]
+    header_len = 16 + sum(len(n) + 1 for n in names)
+    header_len = (header_len + 7) & ~7
+    names = [n.decode() for n in names]
+
+    # sn, pc, disasmId, then one tick per stage
+    record = struct.Struct(f'<QQQ{num_stages}Q')
+    if data[-8:] == b'PCCTEND\0':
+        table_offset, = struct.unpack_from('<Q', data, len(data) - 16)
+        disasm = data[table_offset:-16].split(b'\0')[:-1]
+        disasm = [d.decode() for d in disasm]
+    else:
+        # Simulation did not exit cleanly, the disassembly table is missing
+        table_offset = header_len + (len(data) - header_len) // record.size * record.size
+        disasm = []
+
+    def rows():
+        for sn, pc, disasm_id, *ticks in record.iter_unpack(data[header_len:table_offset]):
+            text = disasm[disasm_id] if disasm_id < len(disasm) else '?'
+            yield ticks + [text, pc]
+    return names + ['Disasm', 'PC'], rows()
+
+
+def load_rows(sqldb):
+    """Return (column names, rows without the ID column) of the commit trace."""
+    if sqldb.endswith('.perfcct'):
+        return load_perfcct(sqldb)
+    trace = f'{sqldb}.cpu{args.cpu}.perfcct'
+    if os.path.exists(trace):
+        return load_perfcct(trace)
+    with sql.connect(sqldb) as con:
+        cur = con.cursor()
+        cur.execute("SELECT * FROM LifeTimeCommitTrace")
+        col_name = [i[0] for i in cur.description]
+        return col_name[1:], [row[1:] for row in cur.fetchall()]
+
+
+col_name, rows = load_rows(sqldb)
+col_name = [i.lower() for i in col_name]
+for row in rows:
+    pos = []
+    records = []
+    i = 0
+    for val in row:
+        if col_name[i].startswith('at'):
+            pos.append(val//tick_per_cycle)
+        elif col_name[i].startswith('pc'):
+            records.append(hex(val))
+        else:
+            records.append(val)
+        i += 1
+    dump(pos, records)
@@ -21,6 +21,9 @@ export arch_script=`realpath $1`
 # Note 2: The meaning of fields:
 # workload_name, checkpoint_path, skip insts(usually 0), functional_warmup insts(usually 0), detailed_warmup insts (usually 20), sample insts
 # Note 3: you can write a script to generate such a list accordingly
+# Note 4: xiangshan.py/kmh.py can also run such a list in one process with
+#       --batch-list=<list> --batch-cpt-dir=<checkpoint_top_dir> --batch-jobs=<N>,
+#       building the system once and forking a worker per checkpoint
 export workload_list=`realpath $2`
 
 # The checkpoint directory. We will find checkpoint_path in workload_list